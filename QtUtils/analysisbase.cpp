@@ -21,6 +21,12 @@ AnalysisBase::AnalysisBase(QObject* parent, AnalysisBase* duplicateMe)
 {
 }
 
+AnalysisBase::~AnalysisBase()
+{
+	Json::Reclaimer::instance().reclaim(std::move(_boundValues));
+	Json::Reclaimer::instance().reclaim(std::move(_orgBoundValues));
+}
+
 QQuickItem* AnalysisBase::formItem() const
 {
 	return _analysisForm;
@@ -228,7 +234,26 @@ void AnalysisBase::setBoundValue(const std::string &name, const Json::Value &val
 
 void AnalysisBase::setBoundValues(const Json::Value &boundValues)
 {
-	_boundValues = boundValues;
+	replaceBoundValues(_boundValues, boundValues);
+}
+
+void AnalysisBase::setOrgBoundValues(const Json::Value &orgBoundValues)
+{
+	replaceBoundValues(_orgBoundValues, orgBoundValues);
+}
+
+void AnalysisBase::clearOptions()
+{
+	Json::Value previous(_boundValues.type());
+	previous.swapPayload(_boundValues); //Leaves _boundValues empty like clear() would, but the old tree goes to the Reclaimer
+	Json::Reclaimer::instance().reclaim(std::move(previous));
+}
+
+void AnalysisBase::replaceBoundValues(Json::Value & current, const Json::Value & replacement)
+{
+	Json::Value previous = current; //replacement might be current itself, so copy (which is cheap) before assigning
+	current = replacement;
+	Json::Reclaimer::instance().reclaim(std::move(previous));
 }
 
 const Json::Value &AnalysisBase::boundValue(const std::string &name, const QVector<AnalysisBase::ParentKey> &parentKeys)
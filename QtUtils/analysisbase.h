@@ -27,6 +27,7 @@ public:
 
 	explicit AnalysisBase(QObject *parent = nullptr, Version moduleVersion = AppInfo::version, const QString& moduleName = "", const QString& analysisName = "", const QString& qmlFileName = "");
 	AnalysisBase(QObject *parent, AnalysisBase* duplicateMe);
+	~AnalysisBase();
 
 	virtual bool isOwnComputedColumn(const std::string &col)				const	{ return false; }
 	virtual void refresh()															{}
@@ -61,9 +62,9 @@ public:
 
 	void				setBoundValue(const std::string& name, const Json::Value& value, const Json::Value& meta, const QVector<AnalysisBase::ParentKey>& parentKeys = {});
 	void				setBoundValues(const Json::Value& boundValues);
-	void				setOrgBoundValues(const Json::Value& orgBoundValues)		{ _orgBoundValues = orgBoundValues; }
+	void				setOrgBoundValues(const Json::Value& orgBoundValues);
 	const	Json::Value	optionsMeta()										const	{ return _boundValues.get(".meta", Json::nullValue);	}
-	void				clearOptions()												{ _boundValues.clear();		}
+	void				clearOptions();
 
 	const	Version	&	moduleVersion()										const	{ return _moduleVersion;	}
 
@@ -102,6 +103,9 @@ protected:
 						_moduleName;
 
 private:
+	///The options of an analysis can be a big tree, so freeing the previous one is left to Json::Reclaimer to not hold up the UI thread.
+	static void			replaceBoundValues(Json::Value & current, const Json::Value & replacement);
+
 	Json::Value			_boundValues		= Json::objectValue,
 						_orgBoundValues		= Json::objectValue;
 
@@ -12,7 +12,7 @@ std::set<std::string> JsonUtilities::convertDragNDropFilterJSONToSet(std::string
 
 	while(jsonStack.size() > 0)
 	{
-		Json::Value cur = jsonStack.top();
+		const Json::Value cur = jsonStack.top();
 		jsonStack.pop();
 
 		if(cur.isArray())
@@ -23,8 +23,8 @@ std::set<std::string> JsonUtilities::convertDragNDropFilterJSONToSet(std::string
 			if(cur.get("nodeType", "").asString() == "Column")
 				returnThis.insert(cur.get("columnName", "").asString());
 			else
-				for(auto & str : cur.getMemberNames())
-					jsonStack.push(cur[str]);
+				for(const auto & member : cur.members())
+					jsonStack.push(member.value);
 		}
 	}
 
@@ -62,8 +62,8 @@ void JsonUtilities::removeColumnsFromDragNDropFilterJSONRef(Json::Value & json,
 		if(json.get("nodeType", "").asString() == "Column" && columnNames.count(json["columnName"].asString()) > 0)
 			json = Json::nullValue;
 		else
-			for(auto & key : json.getMemberNames())
-				removeColumnsFromDragNDropFilterJSONRef(json[key], columnNames);
+			for(auto [key, option] : json.members())
+				removeColumnsFromDragNDropFilterJSONRef(option, columnNames);
 	}
 }
 
@@ -102,8 +102,8 @@ void JsonUtilities::replaceColumnNamesInDragNDropFilterJSONRef(Json::Value & jso
 		if(json.get("nodeType", "").asString() == "Column" && changeNameColumns.count(json["columnName"].asString()) > 0)
 			json["columnName"] = changeNameColumns.at(json["columnName"].asString());
 		else
-			for(auto & key : json.getMemberNames())
-				replaceColumnNamesInDragNDropFilterJSONRef(json[key], changeNameColumns);
+			for(auto [key, option] : json.members())
+				replaceColumnNamesInDragNDropFilterJSONRef(option, changeNameColumns);
 	}
 }
 
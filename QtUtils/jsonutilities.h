@@ -5,6 +5,7 @@
 #include <string>
 #include <set>
 #include <cmath>
+#include <algorithm>
 #include "utils.h"
 #include "qutils.h"
 
@@ -33,15 +34,21 @@ public:
 	static Json::Value				vecToJsonArray(const std::vector<T> & vec)
 	{
 		Json::Value out = Json::arrayValue;
+		out.reserve(vec.size());
 
 		for(const T & e : vec)	out.append(e);
 
 		return out;
 	}
 
-	static Json::Value				vecToJsonArray(const std::vector<double> vec)
+	static Json::Value				vecToJsonArray(const std::vector<double> & vec)
 	{
+		//Without inf or nan the doubles are kept together in one typed array, which is written without a Value per element
+		if(std::all_of(vec.begin(), vec.end(), [](double v) { return std::isfinite(v); }))
+			return Json::Value(vec.data(), vec.data() + vec.size());
+
 		Json::Value out = Json::arrayValue;
+		out.reserve(vec.size());
 
 		for(const double & v : vec)
 			if(std::isnan(v) || std::isinf(v))	out.append(Json::nullValue); //Json does not support inf or nan... Sigh...
@@ -53,6 +60,7 @@ public:
 	static Json::Value				vecToJsonArray(const std::vector<QString> & vec)
 	{
 		Json::Value out = Json::arrayValue;
+		out.reserve(vec.size());
 
 		for(const QString & e : vec)	out.append(fq(e));
 
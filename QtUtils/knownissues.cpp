@@ -6,6 +6,7 @@
 #include "appdirs.h"
 #include "utils.h"
 #include <fstream>
+#include <sstream>
 
 
 //Check every day?
@@ -22,10 +23,15 @@ KnownIssues::KnownIssues(QObject * parent) : QObject(parent)
 
 void KnownIssues::loadLocalJson(const std::string & filePath, bool saveIt)
 {
-	std::ifstream readMe(filePath);
+	std::ifstream		readMe(filePath);
+	std::stringstream	jsonTxt;
+	jsonTxt << readMe.rdbuf();
+
+	if(!saveIt && loadVersionJson(jsonTxt.str()))
+		return;
 
 	Json::Value json;
-	Json::Reader().parse(readMe, json);
+	Json::Reader().parse(jsonTxt.str(), json);
 
 	loadJson(json, saveIt);
 }
@@ -40,7 +46,10 @@ void KnownIssues::loadJson(const std::string & jsonTxt,	bool saveIt)
 #endif
 		return;
 	}
-	
+
+	if(!saveIt && loadVersionJson(jsonTxt))
+		return;
+
 	Json::Value known;
 	if(Json::Reader().parse(jsonTxt, known))
 		loadJson(known, saveIt);
@@ -53,28 +62,55 @@ void KnownIssues::loadJson(const std::string & jsonTxt,	bool saveIt)
 	}
 }
 
+//The file holds the issues of every version, only those of this one are read and the rest is just skipped over.
+//Returns false for anything but plain JSON, a file with comments for instance, which the callers then read as a whole.
+//Saving needs the whole file as well, because it is written restyled.
+bool KnownIssues::loadVersionJson(const std::string & jsonTxt)
+{
+	Json::LazyDocument known;
+	if(!known.parse(jsonTxt.data(), jsonTxt.data() + jsonTxt.size(), nullptr))
+		return false;
+
+	const Json::LazyValue root = known.root();
+	loadVersionIssues(root.isObject() ? root[AppInfo::version.asString()].toValue() : Json::Value(), root.isObject());
+
+	return true;
+}
 
 void KnownIssues::loadJson(const Json::Value & json, bool saveIt)
 {
-	_issues.clear();
+	loadVersionIssues(json.isObject() ? json[AppInfo::version.asString()] : Json::Value(), json.isObject());
 
-	try
+	if(saveIt)
 	{
-		if(!json.isObject()) throw std::runtime_error("expected issues json to be an object");
-
-		const std::string version = AppInfo::version.asString();
+		std::ofstream saveHere(knownJsonPath());
+		saveHere << json;
+		saveHere.close();
+	}
+}
 
-		if(json.isMember(version))
-			for(		const std::string & module		: json[version]						.getMemberNames())
-				for(	const std::string & analysis	: json[version][module]				.getMemberNames())
-				{
-					const Json::Value & perAnalysis = json[version][module][analysis];
+void KnownIssues::loadVersionIssues(const Json::Value & versionIssues, bool jsonIsObject)
+{
+	_issues.clear();
 
-					if(perAnalysis.isObject())	addIssue(module, analysis, perAnalysis);
-					if(perAnalysis.isArray())
-						for(const Json::Value & entry : perAnalysis)
-							addIssue(module, analysis, entry);
-				}
+	try
+	{
+		if(!jsonIsObject) throw std::runtime_error("expected issues json to be an object");
+
+		for(auto [moduleName, perModule] : versionIssues.members())
+		{
+			const std::string module(moduleName);
+
+			for(auto [analysisName, perAnalysis] : perModule.members())
+			{
+				const std::string analysis(analysisName);
+
+				if(perAnalysis.isObject())	addIssue(module, analysis, perAnalysis);
+				if(perAnalysis.isArray())
+					for(const Json::Value & entry : perAnalysis)
+						addIssue(module, analysis, entry);
+			}
+		}
 	}
 	catch(const std::exception & e)
 	{
@@ -85,13 +121,6 @@ void KnownIssues::loadJson(const Json::Value & json, bool saveIt)
 	}
 
 	emit knownIssuesUpdated();
-
-	if(saveIt)
-	{
-		std::ofstream saveHere(knownJsonPath());
-		saveHere << json;
-		saveHere.close();
-	}
 }
 
 std::string KnownIssues::knownJsonPath() const
@@ -55,6 +55,8 @@ private:
 	void		loadKnownJson();
 
 	void		loadLocalJson(	const std::string & filePath,	bool saveIt);
+	bool		loadVersionJson(const std::string & jsonTxt);
+	void		loadVersionIssues(const Json::Value & versionIssues, bool jsonIsObject);
 	void		addIssue(		const std::string & module,		const std::string & analysis, const Json::Value & issue);
 
 private:
@@ -151,6 +151,7 @@ Json::Value fqj(const QJSValue & jsVal)
 	{
 		Json::Value  json	= Json::arrayValue;
 		const size_t length = jsVal.property("length").toUInt();
+		json.reserve(length);
 
 		for(size_t i=0; i<length; i++)
 			json.append(fqj(jsVal.property(i)));
@@ -199,8 +200,8 @@ QJSValue tqj(const Json::Value & json, const QQuickItem * qItem)
 	{
 		QJSValue obj = QQmlEngine::contextForObject(qItem)->engine()->newObject();
 
-		for(const std::string & member : json.getMemberNames())
-			obj.setProperty(tq(member), tqj(json[member], qItem));
+		for(auto [name, member] : json.members())
+			obj.setProperty(QString::fromUtf8(name.data(), int(name.size())), tqj(member, qItem));
 
 		return obj;
 	}
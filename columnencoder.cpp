@@ -476,16 +476,17 @@ void ColumnEncoder::replaceAll(Json::Value & json, const std::map<std::string, s
 	{
 		std::map<std::string, std::string> changedMembers;
 
-		for(const std::string & optionName : json.getMemberNames())
+		for(auto [optionName, option] : json.members())
 		{
-			replaceAll(json[optionName], map, names, replaceNames, replaceStrict);
+			replaceAll(option, map, names, replaceNames, replaceStrict);
 
 			if(replaceNames)
 			{
-				std::string replacedName = replaceStrict ? replaceAllStrict(optionName, map) : replaceAll(optionName, map, names);
+				const std::string	name			= std::string(optionName),
+									replacedName	= replaceStrict ? replaceAllStrict(name, map) : replaceAll(name, map, names);
 
-				if(replacedName != optionName)
-					changedMembers[optionName] = replacedName;
+				if(replacedName != name)
+					changedMembers[name] = replacedName;
 			}
 		}
 
@@ -536,8 +537,8 @@ void ColumnEncoder::collectExtraEncodingsFromMetaJson(const Json::Value & json,
 					namesCollected.push_back(enc.asString());
 		}
 		else
-			for(const std::string & optionName : json.getMemberNames())
-				collectExtraEncodingsFromMetaJson(json[optionName], namesCollected);
+			for(const auto & member : json.members())
+				collectExtraEncodingsFromMetaJson(member.value, namesCollected);
 		return;
 
 	default:
@@ -594,32 +595,38 @@ ColumnEncoder::colsPlusTypes ColumnEncoder::encodeColumnNamesinOptions(Json::Val
 			// For variables list the types of each variable are added in the option itself.
 			// To ensure the analyses still work as before, remove these types from the option, and add them in a new option with name '<option mame>.types'
 			// very much deprecated though as analyses should announce being capable of "preloadingData" and then using that instead.
-			for (const std::string& optionName : options.getMemberNames())
-				if (options[optionName].isObject() && options[optionName].isMember("value") && options[optionName].isMember("types"))
+			std::vector<std::pair<std::string, Json::Value>> typesOptions;
+
+			for (auto [optionName, option] : options.members())
+				if (option.isObject() && option.isMember("value") && option.isMember("types"))
 				{
-					options[optionName + ".types"] = options[optionName]["types"];
-					options[optionName] = options[optionName]["value"];
+					typesOptions.emplace_back(std::string(optionName) + ".types", option["types"]);
+					option = option["value"];
 				}
+
+			// Only added now because adding to options would invalidate the iteration above
+			for (auto & typesOption : typesOptions)
+				options[typesOption.first] = std::move(typesOption.second);
 		}
 		else	//Here we make sure all the requested columns + their types are collected
 		{		// they then are encoded with type included so that everything is accessible easily via those encoded names
 				// some functionality has been added to ask for the type of an encoded column as well.
 			
-			for (const std::string& optionName : options.getMemberNames())
-				if (options[optionName].isObject() && options[optionName].isMember("value") && options[optionName].isMember("types"))
+			for (auto [optionName, option] : options.members())
+				if (option.isObject() && option.isMember("value") && option.isMember("types"))
 				{
-					if (options[optionName].isObject() && options[optionName].isMember("value") && options[optionName].isMember("types"))
+					if (option.isObject() && option.isMember("value") && option.isMember("types"))
 					{
 						Json::Value		newOption	=	Json::arrayValue,
-									&	typeList	= options[optionName]["types"],
-										valueList	= options[optionName]["value"];
+									&	typeList	= option["types"],
+										valueList	= option["value"];
 		
 						bool useSingleVal = false;
 						
-						if(!options[optionName]["value"].isArray())
+						if(!option["value"].isArray())
 						{
 							valueList = Json::arrayValue;
-							valueList.append(options[optionName]["value"].asString());
+							valueList.append(option["value"].asString());
 		
 							useSingleVal = true; //Otherwise we break things like "splitBy" it seems
 						}
@@ -645,7 +652,7 @@ ColumnEncoder::colsPlusTypes ColumnEncoder::encodeColumnNamesinOptions(Json::Val
 							}
 						}
 						
-						options[optionName] = !useSingleVal ? newOption : newOption[0];
+						option = !useSingleVal ? newOption : newOption[0];
 					}
 				}
 		}
@@ -682,12 +689,12 @@ void ColumnEncoder::_encodeColumnNamesinOptions(Json::Value & options, Json::Val
 		return;
 
 	case Json::objectValue:
-		for(const std::string & memberName : options.getMemberNames())
-			if(memberName != ".meta" && meta.isMember(memberName))
-				_encodeColumnNamesinOptions(options[memberName], meta[memberName]);
+		for(auto [memberName, option] : options.members())
+			if(memberName != ".meta" && meta.isMember(memberName.data(), memberName.data() + memberName.size()))
+				_encodeColumnNamesinOptions(option, *meta.demand(memberName.data(), memberName.data() + memberName.size()));
 		
-			else if(isRCode && options[memberName].isString())
-				options[memberName] = columnEncoder()->encodeRScript(options[memberName].asString());
+			else if(isRCode && option.isString())
+				option = columnEncoder()->encodeRScript(option.asString());
 		
 			else if(encodePlease)
 				columnEncoder()->encodeJson(options, false, true); //If we already think we have columnNames just change it all I guess?
@@ -6,8 +6,10 @@
 #ifndef JSON_ALLOCATOR_H_INCLUDED
 #define JSON_ALLOCATOR_H_INCLUDED
 
+#include <cstddef>
 #include <cstring>
 #include <memory>
+#include <utility>
 
 #pragma pack(push)
 #pragma pack()
@@ -82,6 +84,129 @@ bool operator!=(const SecureAllocator<T>&, const SecureAllocator<U>&) {
   return false;
 }
 
+/** \brief Bump-pointer memory for building and parsing Values in.
+ *
+ * While an ArenaScope for an arena is active on a thread, the Values
+ * constructed on that thread live in the arena: their strings, keys, arrays
+ * and objects take memory from it, and so does everything added to those
+ * containers later on, with or without a scope. That memory is never freed
+ * piecemeal. Destroying a value that lives in an arena does not visit its
+ * children, and destroying (or reset()ing) the arena releases all of it at
+ * once, so values living in an arena must not outlive it.
+ *
+ * Assigning, moving or swapping between values that live in different arenas
+ * (or in an arena and on the heap) copies the contents into the memory of the
+ * receiving value, so a tree never points into another arena. Comments are
+ * not kept on values in an arena.
+ *
+ * Like the values in it, an arena must be used by one thread at a time.
+ * \sa Document
+ */
+class JSON_API Arena {
+public:
+  explicit Arena(size_t blockSize = 64 * 1024);
+  ~Arena();
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  /// Returns size bytes, suitably aligned for any type.
+  void* allocate(size_t size);
+  /// Releases all memory. Nothing living in the arena may be used after this.
+  void reset();
+
+  /// Bytes handed out by allocate() since construction or reset().
+  size_t bytesUsed() const { return used_; }
+  /// Bytes obtained from the system for those.
+  size_t bytesReserved() const { return reserved_; }
+
+  /// \internal Values refer to their arena by this id, 0 stands for the heap.
+  /// It is 0 as well if all ids are taken, the arena then acts like the heap.
+  unsigned id() const { return id_; }
+  /// \internal The id of the arena that is current on this thread.
+  static unsigned current();
+  /// \internal Makes arenaId current on this thread, returns the previous one.
+  static unsigned makeCurrent(unsigned arenaId);
+  /// \internal Memory from the arena arenaId, or operator new for 0.
+  static void* allocateIn(unsigned arenaId, size_t size);
+  /// \internal Frees memory of allocateIn(0, ...); arena memory is left alone.
+  static void deallocateIn(unsigned arenaId, void* memory);
+
+private:
+  struct Block {
+    Block* next_;
+  };
+
+  Block* newBlock(size_t size);
+
+  size_t blockSize_;
+  Block* blocks_{nullptr};
+  char* cursor_{nullptr};
+  char* end_{nullptr};
+  size_t used_{0};
+  size_t reserved_{0};
+  unsigned id_{0};
+};
+
+/** \brief Makes an Arena current on this thread for the lifetime of the scope.
+ *
+ * Passing nullptr makes new values go to the heap again, for instance to
+ * build a value that has to outlive the arena.
+ */
+class JSON_API ArenaScope {
+public:
+  explicit ArenaScope(Arena* arena)
+      : previous_(Arena::makeCurrent(arena ? arena->id() : 0)) {}
+  ~ArenaScope() { Arena::makeCurrent(previous_); }
+  ArenaScope(ArenaScope const&) = delete;
+  ArenaScope& operator=(ArenaScope const&) = delete;
+
+private:
+  unsigned previous_;
+};
+
+/** \internal Allocator for the containers inside a Value, taking memory from
+ * the arena with the given id (or the heap for 0). Elements are constructed
+ * with that arena current, so that they live in the same arena as their
+ * container.
+ */
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  ArenaAllocator(unsigned arena = 0) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(Arena::allocateIn(arena_, n * sizeof(T)));
+  }
+  void deallocate(T* p, std::size_t) { Arena::deallocateIn(arena_, p); }
+
+  template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+    struct Restore {
+      unsigned previous_;
+      ~Restore() { Arena::makeCurrent(previous_); }
+    } restore{Arena::makeCurrent(arena_)};
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  unsigned arena() const { return arena_; }
+  template <typename U> struct rebind { using other = ArenaAllocator<U>; };
+
+private:
+  unsigned arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+  return a.arena() != b.arena();
+}
+
 } // namespace Json
 
 #pragma pack(pop)
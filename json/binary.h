@@ -0,0 +1,77 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_BINARY_H_INCLUDED
+#define JSON_BINARY_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+/* Compact binary form of a Value, for messages between processes.
+ *
+ * Values are written as CBOR (RFC 8949) items: every item starts with a
+ * type tag, strings, arrays and objects carry their length up front and
+ * numbers are stored in binary. So neither side formats or scans text, and
+ * reals come back bit for bit (NaN and the infinities included).
+ *
+ * - null, true and false are CBOR simple values.
+ * - Integers are CBOR unsigned or negative integers in their shortest form.
+ * - Reals are single precision floats when that is exact, otherwise double.
+ * - Strings and object keys are text strings; their bytes are not checked
+ *   for valid UTF-8, just like the text writers do not check them.
+ * - Arrays and objects are definite-length arrays and maps. Arrays made
+ *   from doubles or Int64s (see Value(const double*, const double*)) are
+ *   RFC 8746 typed arrays instead: tag 86 or 79 on a byte string with the
+ *   elements in little endian order.
+ *
+ * Reading accepts what is written plus half precision floats, byte strings
+ * (as strings), "undefined" (as null), big endian typed arrays of doubles
+ * and Int64s (tags 82 and 75) and other tags, which are skipped. Typed
+ * arrays give arrays made from their elements, anything else the same types
+ * as parsing the JSON text would: integers become intValue unless they only
+ * fit a uintValue. Indefinite-length items are rejected.
+ * Comments and source offsets are not part of the encoding.
+ *
+ * Like the text readers, parseBinary builds within the current ArenaScope,
+ * so it can fill a Document.
+ *   \code
+ *   Json::String message = Json::toBinary(results);
+ *   ...
+ *   Json::Value received;
+ *   Json::String errs;
+ *   if (!Json::parseBinary(message.data(), message.data() + message.size(),
+ *                          &received, &errs))
+ *     handleError(errs);
+ *   \endcode
+ */
+/// The number of bytes writeBinary() writes for root.
+size_t JSON_API binarySize(Value const& root);
+
+/// Writes root to out, which must have room for binarySize(root) bytes, and
+/// returns the end of the output.
+char* JSON_API writeBinary(Value const& root, char* out);
+
+/// root in the binary form, sized with binarySize() and written in place.
+String JSON_API toBinary(Value const& root);
+
+/** \brief Reads the binary form of one value from [begin, end).
+ * \return false, with the reason in errs if it is not null, when the input
+ *         is malformed, nested deeper than 1000 levels or has bytes left
+ *         after the value. root is then unspecified.
+ */
+bool JSON_API parseBinary(char const* begin, char const* end, Value* root,
+                          String* errs);
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#endif // JSON_BINARY_H_INCLUDED
@@ -20,6 +20,14 @@
 #define JSON_USE_EXCEPTION 1
 #endif
 
+// If non-zero, Json::Value leaves out comments and source offsets and packs
+// into 16 bytes. The comment and offset accessors remain but do nothing. This
+// changes the layout of Json::Value, so everything using the library must be
+// built with the same setting.
+#ifndef JSON_USE_LEAN_VALUE
+#define JSON_USE_LEAN_VALUE 0
+#endif
+
 // Temporary, tracked for removal with issue #982.
 #ifndef JSON_USE_NULLREF
 #define JSON_USE_NULLREF 1
@@ -12,6 +12,10 @@
 
 namespace Json {
 
+// allocator.h
+class Arena;
+class ArenaScope;
+
 // writer.h
 class StreamWriter;
 class StreamWriterBuilder;
@@ -22,8 +26,11 @@ class StyledStreamWriter;
 
 // reader.h
 class Reader;
+class SaxHandler;
 class CharReader;
 class CharReaderBuilder;
+class Document;
+class PushReader;
 
 // json_features.h
 class Features;
@@ -0,0 +1,169 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_INDEXED_H_INCLUDED
+#define JSON_INDEXED_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cstdint>
+
+// Disable warning C4251: <data member>: <type> needs to have dll-interface to
+// be used by...
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+/** \brief Converts root to the indexed binary form read by IndexedDocument.
+ *
+ * The result can be written to a file as is. Numbers are stored in binary,
+ * every string once with its length, arrays as a table of offsets and
+ * objects as a table of (name, value) offsets in the key order of Value, so
+ * a member is found by binary search. Member names that repeat are stored
+ * once. Comments and source offsets are not kept.
+ */
+String JSON_API toIndexed(Value const& root);
+
+class IndexedDocument;
+
+/** \brief Read-only view of a value in an IndexedDocument.
+ *
+ * Navigating reads only the tables on the path, nothing is parsed or copied
+ * until toValue() or asString() is called. The accessors behave like those
+ * of Value: a missing member or index gives a null view, and conversions
+ * check their ranges the same way. A view is a pointer into the document
+ * and must not be used after the document is closed.
+ */
+class JSON_API IndexedValue {
+public:
+  /// A null view.
+  IndexedValue() = default;
+
+  ValueType type() const;
+  bool isNull() const { return type() == nullValue; }
+  bool isBool() const { return type() == booleanValue; }
+  bool isString() const { return type() == stringValue; }
+  bool isArray() const { return type() == arrayValue; }
+  bool isObject() const { return type() == objectValue; }
+
+  bool asBool() const { return scalar().asBool(); }
+  Int asInt() const { return scalar().asInt(); }
+  UInt asUInt() const { return scalar().asUInt(); }
+#if defined(JSON_HAS_INT64)
+  Int64 asInt64() const { return scalar().asInt64(); }
+  UInt64 asUInt64() const { return scalar().asUInt64(); }
+#endif // if defined(JSON_HAS_INT64)
+  LargestInt asLargestInt() const { return scalar().asLargestInt(); }
+  LargestUInt asLargestUInt() const { return scalar().asLargestUInt(); }
+  double asDouble() const { return scalar().asDouble(); }
+  String asString() const;
+  /// The bytes of a string, which stay in the document. False if this is
+  /// not a string.
+  bool getString(char const** begin, char const** end) const;
+
+  /// Number of elements or members, 0 for scalars.
+  ArrayIndex size() const;
+  /// As Value::empty(), false for strings, numbers and bools.
+  bool empty() const {
+    return (isNull() || isArray() || isObject()) && size() == 0;
+  }
+
+  /// The element at index, or a null view if there is none.
+  /// \pre type() is arrayValue or nullValue
+  IndexedValue operator[](ArrayIndex index) const;
+  /// The member named key, or a null view if there is none.
+  /// \pre type() is objectValue or nullValue
+  IndexedValue operator[](const char* key) const;
+  IndexedValue operator[](const String& key) const;
+  /// Looks a member up by binary search; false if there is none.
+  bool find(char const* begin, char const* end, IndexedValue* found) const;
+  bool isMember(const char* key) const;
+  bool isMember(const String& key) const;
+
+  /// Name of the member at position, in the order getMemberNames() lists
+  /// them.
+  /// \pre type() is objectValue and position < size()
+  char const* memberName(ArrayIndex position, char const** end) const;
+  /// Value of the member at position.
+  IndexedValue member(ArrayIndex position) const;
+  Value::Members getMemberNames() const;
+
+  /// Materialises this value and everything below it into a Value.
+  Value toValue() const;
+
+private:
+  friend class IndexedDocument;
+  IndexedValue(IndexedDocument const* document, uint64_t slot)
+      : document_(document), slot_(slot) {}
+
+  Value scalar() const;
+  uint64_t header() const;
+  uint64_t word(uint64_t offset) const;
+
+  IndexedDocument const* document_{nullptr};
+  // null when document_ is null, see json_indexed.cpp for the encoding.
+  uint64_t slot_{0};
+};
+
+/** \brief A document in the form written by toIndexed(), read in place.
+ *
+ * open() maps a file into memory instead of reading it, so opening is
+ * constant time and only the pages a lookup touches are loaded. This suits
+ * big persisted state and results of which a few members are needed:
+ *   \code
+ *   Json::IndexedDocument state;
+ *   if (state.open(path, &errs))
+ *     title = state.root()["results"]["title"].asString();
+ *   \endcode
+ * Only the header is checked on opening; every later read is bounds
+ * checked and fails like a Value type error if the file is corrupt.
+ */
+class JSON_API IndexedDocument {
+public:
+  IndexedDocument() = default;
+  /// Reads the document from bytes, as returned by toIndexed().
+  explicit IndexedDocument(String bytes);
+  IndexedDocument(IndexedDocument const&) = delete;
+  IndexedDocument& operator=(IndexedDocument const&) = delete;
+  ~IndexedDocument();
+
+  /// Maps the file at path (UTF-8) into memory. On failure, errs (if not
+  /// null) gets the reason and the document is empty.
+  bool open(String const& path, String* errs);
+  /// Unmaps the file, or drops the bytes. Views into it become invalid.
+  void close();
+
+  bool isOpen() const { return data_ != nullptr; }
+  /// The root value, or a null view if nothing is open.
+  IndexedValue root() const;
+
+private:
+  friend class IndexedValue;
+  bool adopt(char const* data, size_t size, String* errs);
+
+  String bytes_;
+  char const* data_{nullptr};
+  size_t size_{0};
+  uint64_t root_{0};
+  void* mapping_{nullptr};
+  size_t mappedSize_{0};
+};
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(pop)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#endif // JSON_INDEXED_H_INCLUDED
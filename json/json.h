@@ -8,7 +8,13 @@
 
 #include "config.h"
 #include "json_features.h"
+#include "binary.h"
+#include "indexed.h"
+#include "lazy.h"
+#include "patch.h"
+#include "query.h"
 #include "reader.h"
+#include "reclaim.h"
 #include "value.h"
 #include "writer.h"
 
@@ -0,0 +1,510 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/binary.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Json {
+
+namespace {
+
+// CBOR major types, in the top three bits of the initial byte.
+enum MajorType : unsigned {
+  majorUnsigned = 0,
+  majorNegative = 1,
+  majorBytes = 2,
+  majorText = 3,
+  majorArray = 4,
+  majorMap = 5,
+  majorTag = 6,
+  majorSimple = 7
+};
+
+// The low five bits of the initial byte of major type 7.
+enum SimpleValue : unsigned {
+  simpleFalse = 20,
+  simpleTrue = 21,
+  simpleNull = 22,
+  simpleUndefined = 23,
+  simpleHalf = 25,
+  simpleFloat = 26,
+  simpleDouble = 27,
+  simpleBreak = 31
+};
+
+// RFC 8746 tags for a byte string holding a typed array.
+enum TypedArrayTag : unsigned {
+  tagInt64BigEndian = 75,
+  tagInt64LittleEndian = 79,
+  tagFloat64BigEndian = 82,
+  tagFloat64LittleEndian = 86
+};
+
+const unsigned binaryStackLimit = 1000;
+
+bool isLittleEndian() {
+  const uint16_t probe = 1;
+  unsigned char first;
+  memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+size_t argumentSize(uint64_t argument) {
+  return argument < 24 ? 1
+         : argument <= 0xFF ? 2
+         : argument <= 0xFFFF ? 3
+         : argument <= 0xFFFFFFFF ? 5
+                                  : 9;
+}
+
+char* writeBigEndian(char* out, uint64_t value, unsigned bytes) {
+  for (unsigned shift = bytes * 8; shift != 0;) {
+    shift -= 8;
+    *out++ = static_cast<char>((value >> shift) & 0xFF);
+  }
+  return out;
+}
+
+// The initial byte and the shortest encoding of argument after it.
+char* writeHead(char* out, unsigned major, uint64_t argument) {
+  const char type = static_cast<char>(major << 5);
+  if (argument < 24) {
+    *out++ = static_cast<char>(type | static_cast<char>(argument));
+    return out;
+  }
+  const size_t size = argumentSize(argument);
+  const unsigned bytes = static_cast<unsigned>(size - 1);
+  *out++ = static_cast<char>(type | (bytes == 1   ? 24
+                                     : bytes == 2 ? 25
+                                     : bytes == 4 ? 26
+                                                  : 27));
+  return writeBigEndian(out, argument, bytes);
+}
+
+// Arrays made from doubles or Int64s are written as typed arrays, in little
+// endian order, so on most machines their bytes are copied as they are.
+// Arrays of bools, which have no such tag, are arrays of simple values.
+unsigned typedArrayTag(double const*) { return tagFloat64LittleEndian; }
+#if defined(JSON_HAS_INT64)
+unsigned typedArrayTag(Int64 const*) { return tagInt64LittleEndian; }
+#endif // if defined(JSON_HAS_INT64)
+
+template <typename T> size_t typedArraySize(T const* begin, T const* end) {
+  const size_t bytes = size_t(end - begin) * sizeof(T);
+  return argumentSize(typedArrayTag(begin)) + argumentSize(bytes) + bytes;
+}
+size_t typedArraySize(bool const* begin, bool const* end) {
+  return argumentSize(uint64_t(end - begin)) + size_t(end - begin);
+}
+
+template <typename T>
+char* writeTypedArray(char* out, T const* begin, T const* end) {
+  static_assert(sizeof(T) == sizeof(uint64_t), "8 byte elements expected");
+  const size_t bytes = size_t(end - begin) * sizeof(T);
+  out = writeHead(out, majorTag, typedArrayTag(begin));
+  out = writeHead(out, majorBytes, bytes);
+  if (bytes == 0)
+    return out;
+  if (isLittleEndian()) {
+    memcpy(out, begin, bytes);
+    return out + bytes;
+  }
+  for (; begin != end; ++begin) {
+    uint64_t bits;
+    memcpy(&bits, begin, sizeof(bits));
+    for (unsigned shift = 0; shift != 64; shift += 8)
+      *out++ = static_cast<char>((bits >> shift) & 0xFF);
+  }
+  return out;
+}
+char* writeTypedArray(char* out, bool const* begin, bool const* end) {
+  out = writeHead(out, majorArray, uint64_t(end - begin));
+  for (; begin != end; ++begin)
+    *out++ = static_cast<char>(majorSimple << 5 |
+                               (*begin ? simpleTrue : simpleFalse));
+  return out;
+}
+
+bool isExactFloat(double value) {
+  return std::isfinite(value) &&
+         std::fabs(value) <= std::numeric_limits<float>::max() &&
+         static_cast<double>(static_cast<float>(value)) == value;
+}
+
+size_t valueSize(Value const& value) {
+  switch (value.type()) {
+  case nullValue:
+  case booleanValue:
+    return 1;
+  case intValue: {
+    LargestInt number = value.asLargestInt();
+    return argumentSize(number < 0 ? uint64_t(-(number + 1))
+                                   : uint64_t(number));
+  }
+  case uintValue:
+    return argumentSize(value.asLargestUInt());
+  case realValue:
+    return isExactFloat(value.asDouble()) ? 5 : 9;
+  case stringValue: {
+    char const* str;
+    char const* end;
+    if (!value.getString(&str, &end))
+      return 1;
+    return argumentSize(uint64_t(end - str)) + size_t(end - str);
+  }
+  case arrayValue: {
+    size_t size = 0;
+    if (visitTypedElements(value, [&size](auto begin, auto end) {
+          size = typedArraySize(begin, end);
+        }))
+      return size;
+    size = argumentSize(value.size());
+    for (auto it = value.begin(); it != value.end(); ++it)
+      size += valueSize(*it);
+    return size;
+  }
+  case objectValue: {
+    size_t size = argumentSize(value.size());
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      char const* end;
+      char const* name = it.memberName(&end);
+      size += argumentSize(uint64_t(end - name)) + size_t(end - name) +
+              valueSize(*it);
+    }
+    return size;
+  }
+  }
+  return 0;
+}
+
+char* writeText(char* out, char const* begin, char const* end) {
+  out = writeHead(out, majorText, uint64_t(end - begin));
+  memcpy(out, begin, size_t(end - begin));
+  return out + (end - begin);
+}
+
+char* writeValue(Value const& value, char* out) {
+  switch (value.type()) {
+  case nullValue:
+    return writeHead(out, majorSimple, simpleNull);
+  case booleanValue:
+    return writeHead(out, majorSimple,
+                     value.asBool() ? simpleTrue : simpleFalse);
+  case intValue: {
+    LargestInt number = value.asLargestInt();
+    if (number < 0)
+      return writeHead(out, majorNegative, uint64_t(-(number + 1)));
+    return writeHead(out, majorUnsigned, uint64_t(number));
+  }
+  case uintValue:
+    return writeHead(out, majorUnsigned, value.asLargestUInt());
+  case realValue: {
+    const double number = value.asDouble();
+    if (isExactFloat(number)) {
+      const float single = static_cast<float>(number);
+      uint32_t bits;
+      memcpy(&bits, &single, sizeof(bits));
+      *out++ = static_cast<char>(majorSimple << 5 | simpleFloat);
+      return writeBigEndian(out, bits, 4);
+    }
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    *out++ = static_cast<char>(majorSimple << 5 | simpleDouble);
+    return writeBigEndian(out, bits, 8);
+  }
+  case stringValue: {
+    char const* str = nullptr;
+    char const* end = nullptr;
+    value.getString(&str, &end);
+    return writeText(out, str, end);
+  }
+  case arrayValue:
+    if (visitTypedElements(value, [&out](auto begin, auto end) {
+          out = writeTypedArray(out, begin, end);
+        }))
+      return out;
+    out = writeHead(out, majorArray, value.size());
+    for (auto it = value.begin(); it != value.end(); ++it)
+      out = writeValue(*it, out);
+    return out;
+  case objectValue:
+    out = writeHead(out, majorMap, value.size());
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      char const* end;
+      char const* name = it.memberName(&end);
+      out = writeText(out, name, end);
+      out = writeValue(*it, out);
+    }
+    return out;
+  }
+  return out;
+}
+
+double halfToDouble(unsigned half) {
+  const int exponent = static_cast<int>((half >> 10) & 0x1F);
+  const unsigned mantissa = half & 0x3FF;
+  double magnitude;
+  if (exponent == 0)
+    magnitude = std::ldexp(mantissa, -24);
+  else if (exponent != 31)
+    magnitude = std::ldexp(mantissa + 1024, exponent - 25);
+  else
+    magnitude = mantissa == 0 ? std::numeric_limits<double>::infinity()
+                              : std::numeric_limits<double>::quiet_NaN();
+  return half & 0x8000 ? -magnitude : magnitude;
+}
+
+class BinaryReader {
+public:
+  BinaryReader(char const* begin, char const* end)
+      : begin_(begin), current_(begin), end_(end) {}
+
+  bool parse(Value& root) {
+    if (!readValue(root, 0))
+      return false;
+    if (current_ != end_)
+      return fail("Extra data after the value.");
+    return true;
+  }
+
+  String const& error() const { return error_; }
+
+private:
+  bool fail(char const* message) {
+    UIntToStringBuffer buffer;
+    char* offset = buffer + sizeof(buffer);
+    uintToString(LargestUInt(current_ - begin_), offset);
+    error_ = String("* Byte ") + offset + ": " + message + "\n";
+    return false;
+  }
+
+  bool readHead(unsigned& major, unsigned& info, uint64_t& argument) {
+    if (current_ == end_)
+      return fail("Unexpected end of data.");
+    const unsigned char initial = static_cast<unsigned char>(*current_);
+    major = initial >> 5;
+    info = initial & 0x1F;
+    if (info < 24) {
+      argument = info;
+      ++current_;
+      return true;
+    }
+    if (info > 27)
+      return fail(info == simpleBreak ? "Indefinite-length items are not "
+                                        "supported."
+                                      : "Reserved additional information.");
+    const unsigned bytes = 1u << (info - 24);
+    if (end_ - current_ <= static_cast<ptrdiff_t>(bytes))
+      return fail("Unexpected end of data.");
+    ++current_;
+    argument = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+      argument = argument << 8 | static_cast<unsigned char>(*current_++);
+    return true;
+  }
+
+  bool readText(char const*& begin, char const*& end, uint64_t length) {
+    if (length > static_cast<uint64_t>(end_ - current_))
+      return fail("String runs past the end of data.");
+    begin = current_;
+    current_ += length;
+    end = current_;
+    return true;
+  }
+
+  // The byte string after one of the typed array tags, as a Value made from
+  // its elements.
+  template <typename T> bool readTypedArray(Value& value, bool littleEndian) {
+    unsigned major = 0;
+    unsigned info = 0;
+    uint64_t length = 0;
+    char const* headStart = current_;
+    if (!readHead(major, info, length))
+      return false;
+    if (major != majorBytes || length % sizeof(T) != 0) {
+      current_ = headStart;
+      return fail("Typed array must be a byte string of whole elements.");
+    }
+    char const* begin = nullptr;
+    char const* end = nullptr;
+    if (!readText(begin, end, length))
+      return false;
+    std::vector<T> elements(size_t(length / sizeof(T)));
+    if (length != 0 && littleEndian == isLittleEndian()) {
+      memcpy(elements.data(), begin, size_t(length));
+    } else {
+      for (T& element : elements) {
+        uint64_t bits = 0;
+        for (unsigned byte = 0; byte != sizeof(T); ++byte) {
+          const unsigned shift = littleEndian ? byte * 8 : 56 - byte * 8;
+          bits |= uint64_t(static_cast<unsigned char>(*begin++)) << shift;
+        }
+        memcpy(&element, &bits, sizeof(element));
+      }
+    }
+    value = Value(elements.data(), elements.data() + elements.size());
+    return true;
+  }
+
+  bool readValue(Value& value, unsigned depth) {
+    if (depth > binaryStackLimit)
+      return fail("Exceeded stackLimit in readValue().");
+    unsigned major = 0;
+    unsigned info = 0;
+    uint64_t argument = 0;
+    char const* headStart = current_;
+    if (!readHead(major, info, argument))
+      return false;
+    switch (major) {
+    case majorUnsigned:
+      if (argument <= uint64_t(Value::maxLargestInt))
+        value = Value(LargestInt(argument));
+      else
+        value = Value(LargestUInt(argument));
+      return true;
+    case majorNegative:
+      if (argument > uint64_t(Value::maxLargestInt)) {
+        current_ = headStart;
+        return fail("Negative integer out of range.");
+      }
+      value = Value(-LargestInt(argument) - 1);
+      return true;
+    case majorBytes:
+    case majorText: {
+      char const* begin = nullptr;
+      char const* end = nullptr;
+      if (!readText(begin, end, argument))
+        return false;
+      value = Value(begin, end);
+      return true;
+    }
+    case majorArray: {
+      if (argument > uint64_t(end_ - current_)) {
+        current_ = headStart;
+        return fail("Array runs past the end of data.");
+      }
+      value = Value(arrayValue);
+      value.reserve(ArrayIndex(argument));
+      for (uint64_t index = 0; index < argument; ++index) {
+        if (!readValue(value.append(Value()), depth + 1))
+          return false;
+      }
+      return true;
+    }
+    case majorMap: {
+      if (argument > uint64_t(end_ - current_) / 2) {
+        current_ = headStart;
+        return fail("Object runs past the end of data.");
+      }
+      value = Value(objectValue);
+      for (uint64_t index = 0; index < argument; ++index) {
+        unsigned keyMajor = 0;
+        unsigned keyInfo = 0;
+        uint64_t keyLength = 0;
+        char const* keyStart = current_;
+        if (!readHead(keyMajor, keyInfo, keyLength))
+          return false;
+        if (keyMajor != majorText && keyMajor != majorBytes) {
+          current_ = keyStart;
+          return fail("Object member names must be strings.");
+        }
+        char const* begin = nullptr;
+        char const* end = nullptr;
+        if (!readText(begin, end, keyLength))
+          return false;
+        if (!readValue(*value.demand(begin, end), depth + 1))
+          return false;
+      }
+      return true;
+    }
+    case majorTag:
+      switch (argument) {
+      case tagFloat64BigEndian:
+      case tagFloat64LittleEndian:
+        return readTypedArray<double>(value,
+                                      argument == tagFloat64LittleEndian);
+#if defined(JSON_HAS_INT64)
+      case tagInt64BigEndian:
+      case tagInt64LittleEndian:
+        return readTypedArray<Int64>(value, argument == tagInt64LittleEndian);
+#endif // if defined(JSON_HAS_INT64)
+      default:
+        // The meaning of other tags is not kept, only the item they apply to.
+        return readValue(value, depth + 1);
+      }
+    case majorSimple:
+      switch (info) {
+      case simpleFalse:
+        value = Value(false);
+        return true;
+      case simpleTrue:
+        value = Value(true);
+        return true;
+      case simpleNull:
+      case simpleUndefined:
+        value = Value();
+        return true;
+      case simpleHalf:
+        value = Value(halfToDouble(static_cast<unsigned>(argument)));
+        return true;
+      case simpleFloat: {
+        const uint32_t bits = static_cast<uint32_t>(argument);
+        float single;
+        memcpy(&single, &bits, sizeof(single));
+        value = Value(static_cast<double>(single));
+        return true;
+      }
+      case simpleDouble: {
+        double number;
+        memcpy(&number, &argument, sizeof(number));
+        value = Value(number);
+        return true;
+      }
+      default:
+        current_ = headStart;
+        return fail("Unsupported simple value.");
+      }
+    }
+    return false;
+  }
+
+  char const* begin_;
+  char const* current_;
+  char const* end_;
+  String error_;
+};
+
+} // namespace
+
+size_t binarySize(Value const& root) { return valueSize(root); }
+
+char* writeBinary(Value const& root, char* out) {
+  return writeValue(root, out);
+}
+
+String toBinary(Value const& root) {
+  String out(binarySize(root), '\0');
+  if (!out.empty())
+    writeBinary(root, &out[0]);
+  return out;
+}
+
+bool parseBinary(char const* begin, char const* end, Value* root,
+                 String* errs) {
+  BinaryReader reader(begin, end);
+  bool ok = reader.parse(*root);
+  if (errs)
+    *errs = reader.error();
+  return ok;
+}
+
+} // namespace Json
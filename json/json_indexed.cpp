@@ -0,0 +1,561 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+/* The indexed form, all words little endian:
+ *
+ *   header   "JSONIDX1", root slot, total size in bytes
+ *   nodes    each 8-byte aligned, children before their parents
+ *
+ * A slot refers to a value. Its low three bits are a tag:
+ *   0         the rest is the offset of a node
+ *   1, 2, 3   null, false, true
+ *   4, 5      an intValue or uintValue that fits in the upper 61 bits
+ * A node starts with a word holding its ValueType in the low byte and its
+ * length or member count above that:
+ *   intValue, uintValue, realValue   one word of payload
+ *   stringValue                      the bytes, a null char, padding
+ *   arrayValue                       one slot per element
+ *   objectValue                      (name offset, slot) per member, sorted
+ *                                    like Value sorts its keys
+ * Names are string nodes. Every offset in a node is below the node's own
+ * offset, which the reader checks, so a corrupt file cannot form a cycle.
+ */
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include <json/assertions.h>
+#include <json/indexed.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Json {
+
+namespace {
+
+const char indexedMagic[8] = {'J', 'S', 'O', 'N', 'I', 'D', 'X', '1'};
+const uint64_t indexedHeaderSize = 24;
+
+enum SlotTag : uint64_t {
+  slotNode = 0,
+  slotNull = 1,
+  slotFalse = 2,
+  slotTrue = 3,
+  slotInt = 4,
+  slotUInt = 5
+};
+const uint64_t slotTagMask = 7;
+const LargestInt inlineIntMax = (LargestInt(1) << 60) - 1;
+const LargestInt inlineIntMin = -(LargestInt(1) << 60);
+
+uint64_t loadWord(char const* at) {
+  uint64_t word;
+  memcpy(&word, at, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+void storeWord(char* at, uint64_t word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  memcpy(at, &word, sizeof(word));
+}
+
+int compareNames(char const* a, uint64_t aLength, char const* b,
+                 uint64_t bLength) {
+  int comp = memcmp(a, b, static_cast<size_t>(std::min(aLength, bLength)));
+  if (comp != 0)
+    return comp;
+  return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+class IndexedWriter {
+public:
+  String write(Value const& root) {
+    out_.assign(indexedHeaderSize, '\0');
+    const uint64_t rootSlot = writeValue(root);
+    memcpy(&out_[0], indexedMagic, sizeof(indexedMagic));
+    storeWord(&out_[8], rootSlot);
+    storeWord(&out_[16], out_.size());
+    return std::move(out_);
+  }
+
+private:
+  uint64_t beginNode(ValueType type, uint64_t length, size_t payload) {
+    const uint64_t offset = out_.size();
+    out_.resize(out_.size() + 8 + ((payload + 7) & ~size_t(7)));
+    storeWord(&out_[offset], type | length << 8);
+    return offset;
+  }
+
+  uint64_t writeString(char const* begin, char const* end) {
+    const size_t length = static_cast<size_t>(end - begin);
+    const uint64_t offset = beginNode(stringValue, length, length + 1);
+    if (length)
+      memcpy(&out_[offset + 8], begin, length);
+    return offset;
+  }
+
+  uint64_t writeName(char const* begin, char const* end) {
+    std::string name(begin, end);
+    auto found = names_.find(name);
+    if (found != names_.end())
+      return found->second;
+    const uint64_t offset = writeString(begin, end);
+    names_.emplace(std::move(name), offset);
+    return offset;
+  }
+
+  uint64_t writeValue(Value const& value) {
+    switch (value.type()) {
+    case nullValue:
+      return slotNull;
+    case booleanValue:
+      return value.asBool() ? slotTrue : slotFalse;
+    case intValue: {
+      const LargestInt number = value.asLargestInt();
+      if (number >= inlineIntMin && number <= inlineIntMax)
+        return uint64_t(number) << 3 | slotInt;
+      const uint64_t offset = beginNode(intValue, 0, 8);
+      storeWord(&out_[offset + 8], uint64_t(number));
+      return offset;
+    }
+    case uintValue: {
+      const LargestUInt number = value.asLargestUInt();
+      if (number <= LargestUInt(inlineIntMax))
+        return number << 3 | slotUInt;
+      const uint64_t offset = beginNode(uintValue, 0, 8);
+      storeWord(&out_[offset + 8], number);
+      return offset;
+    }
+    case realValue: {
+      const double number = value.asDouble();
+      uint64_t bits;
+      memcpy(&bits, &number, sizeof(bits));
+      const uint64_t offset = beginNode(realValue, 0, 8);
+      storeWord(&out_[offset + 8], bits);
+      return offset;
+    }
+    case stringValue: {
+      char const* begin = nullptr;
+      char const* end = nullptr;
+      value.getString(&begin, &end);
+      return writeString(begin, end);
+    }
+    case arrayValue: {
+      const size_t base = slots_.size();
+      for (auto it = value.begin(); it != value.end(); ++it)
+        slots_.push_back(writeValue(*it));
+      return writeTable(arrayValue, base, slots_.size() - base);
+    }
+    case objectValue: {
+      const size_t base = slots_.size();
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        char const* end;
+        char const* name = it.memberName(&end);
+        slots_.push_back(writeName(name, end));
+        slots_.push_back(writeValue(*it));
+      }
+      return writeTable(objectValue, base, (slots_.size() - base) / 2);
+    }
+    }
+    return slotNull;
+  }
+
+  // A container node from the slots its children left on slots_.
+  uint64_t writeTable(ValueType type, size_t base, size_t count) {
+    const size_t words = slots_.size() - base;
+    const uint64_t offset = beginNode(type, count, words * 8);
+    for (size_t i = 0; i < words; ++i)
+      storeWord(&out_[offset + 8 + 8 * i], slots_[base + i]);
+    slots_.resize(base);
+    return offset;
+  }
+
+  String out_;
+  std::vector<uint64_t> slots_;
+  std::unordered_map<std::string, uint64_t> names_;
+};
+
+} // namespace
+
+String toIndexed(Value const& root) { return IndexedWriter().write(root); }
+
+// class IndexedValue
+// //////////////////////////////////////////////////////////////////
+
+uint64_t IndexedValue::word(uint64_t offset) const {
+  JSON_ASSERT_MESSAGE(offset <= document_->size_ - 8,
+                      "IndexedValue: offset past the end of the document");
+  return loadWord(document_->data_ + offset);
+}
+
+uint64_t IndexedValue::header() const {
+  // Nodes refer only to nodes written before them.
+  return word(slot_);
+}
+
+ValueType IndexedValue::type() const {
+  if (!document_)
+    return nullValue;
+  switch (slot_ & slotTagMask) {
+  case slotNode: {
+    const unsigned type = static_cast<unsigned>(header() & 0xFF);
+    JSON_ASSERT_MESSAGE(type >= intValue && type <= objectValue &&
+                            type != booleanValue,
+                        "IndexedValue: unknown node type");
+    return static_cast<ValueType>(type);
+  }
+  case slotNull:
+    return nullValue;
+  case slotFalse:
+  case slotTrue:
+    return booleanValue;
+  case slotInt:
+    return intValue;
+  case slotUInt:
+    return uintValue;
+  default:
+    JSON_FAIL_MESSAGE("IndexedValue: unknown slot tag");
+  }
+}
+
+Value IndexedValue::scalar() const {
+  if (!document_)
+    return Value();
+  switch (slot_ & slotTagMask) {
+  case slotNull:
+    return Value();
+  case slotFalse:
+    return Value(false);
+  case slotTrue:
+    return Value(true);
+  case slotInt:
+    return Value(static_cast<LargestInt>(slot_) >> 3);
+  case slotUInt:
+    return Value(LargestUInt(slot_ >> 3));
+  default:
+    break;
+  }
+  switch (type()) {
+  case intValue:
+    return Value(static_cast<LargestInt>(word(slot_ + 8)));
+  case uintValue:
+    return Value(LargestUInt(word(slot_ + 8)));
+  case realValue: {
+    const uint64_t bits = word(slot_ + 8);
+    double number;
+    memcpy(&number, &bits, sizeof(number));
+    return Value(number);
+  }
+  case stringValue: {
+    char const* begin;
+    char const* end;
+    getString(&begin, &end);
+    return Value(begin, end);
+  }
+  case arrayValue:
+    return Value(arrayValue);
+  default:
+    return Value(objectValue);
+  }
+}
+
+String IndexedValue::asString() const {
+  char const* begin;
+  char const* end;
+  if (getString(&begin, &end))
+    return String(begin, end);
+  return scalar().asString();
+}
+
+bool IndexedValue::getString(char const** begin, char const** end) const {
+  if (type() != stringValue)
+    return false;
+  const uint64_t length = header() >> 8;
+  JSON_ASSERT_MESSAGE(length <= document_->size_ - slot_ - 8,
+                      "IndexedValue: string past the end of the document");
+  *begin = document_->data_ + slot_ + 8;
+  *end = *begin + length;
+  return true;
+}
+
+ArrayIndex IndexedValue::size() const {
+  const ValueType kind = type();
+  if (kind != arrayValue && kind != objectValue)
+    return 0;
+  const uint64_t count = header() >> 8;
+  const uint64_t words = kind == arrayValue ? count : 2 * count;
+  JSON_ASSERT_MESSAGE(count <= Value::maxUInt &&
+                          words <= (document_->size_ - slot_ - 8) / 8,
+                      "IndexedValue: table past the end of the document");
+  return ArrayIndex(count);
+}
+
+IndexedValue IndexedValue::operator[](ArrayIndex index) const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == arrayValue,
+      "in Json::IndexedValue::operator[](ArrayIndex)const: requires "
+      "arrayValue");
+  if (kind == nullValue || index >= size())
+    return IndexedValue();
+  const uint64_t slot = word(slot_ + 8 + 8 * uint64_t(index));
+  JSON_ASSERT_MESSAGE((slot & slotTagMask) != slotNode || slot < slot_,
+                      "IndexedValue: element does not precede its array");
+  return IndexedValue(document_, slot);
+}
+
+IndexedValue IndexedValue::operator[](const char* key) const {
+  IndexedValue found;
+  this->find(key, key + strlen(key), &found);
+  return found;
+}
+
+IndexedValue IndexedValue::operator[](const String& key) const {
+  IndexedValue found;
+  this->find(key.data(), key.data() + key.length(), &found);
+  return found;
+}
+
+bool IndexedValue::find(char const* begin, char const* end,
+                        IndexedValue* found) const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == objectValue,
+      "in Json::IndexedValue::find(begin, end): requires objectValue");
+  if (kind == nullValue)
+    return false;
+  const uint64_t length = static_cast<uint64_t>(end - begin);
+  ArrayIndex first = 0;
+  ArrayIndex count = size();
+  while (count > 0) {
+    const ArrayIndex half = count / 2;
+    char const* nameEnd;
+    char const* name = memberName(first + half, &nameEnd);
+    const int comp =
+        compareNames(name, uint64_t(nameEnd - name), begin, length);
+    if (comp == 0) {
+      *found = member(first + half);
+      return true;
+    }
+    if (comp < 0) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return false;
+}
+
+bool IndexedValue::isMember(const char* key) const {
+  IndexedValue found;
+  return find(key, key + strlen(key), &found);
+}
+
+bool IndexedValue::isMember(const String& key) const {
+  IndexedValue found;
+  return find(key.data(), key.data() + key.length(), &found);
+}
+
+char const* IndexedValue::memberName(ArrayIndex position,
+                                     char const** end) const {
+  JSON_ASSERT_MESSAGE(type() == objectValue && position < size(),
+                      "in Json::IndexedValue::memberName(): requires an "
+                      "objectValue with a member at position");
+  const uint64_t offset = word(slot_ + 8 + 16 * uint64_t(position));
+  JSON_ASSERT_MESSAGE((offset & slotTagMask) == slotNode && offset < slot_,
+                      "IndexedValue: name does not precede its object");
+  IndexedValue name(document_, offset);
+  char const* begin;
+  JSON_ASSERT_MESSAGE(name.getString(&begin, end),
+                      "IndexedValue: member name is not a string");
+  return begin;
+}
+
+IndexedValue IndexedValue::member(ArrayIndex position) const {
+  JSON_ASSERT_MESSAGE(type() == objectValue && position < size(),
+                      "in Json::IndexedValue::member(): requires an "
+                      "objectValue with a member at position");
+  const uint64_t slot = word(slot_ + 16 + 16 * uint64_t(position));
+  JSON_ASSERT_MESSAGE((slot & slotTagMask) != slotNode || slot < slot_,
+                      "IndexedValue: member does not precede its object");
+  return IndexedValue(document_, slot);
+}
+
+Value::Members IndexedValue::getMemberNames() const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == objectValue,
+      "in Json::IndexedValue::getMemberNames(), value must be objectValue");
+  Value::Members members;
+  const ArrayIndex count = size();
+  members.reserve(count);
+  for (ArrayIndex position = 0; position < count; ++position) {
+    char const* end;
+    char const* name = memberName(position, &end);
+    members.push_back(String(name, end));
+  }
+  return members;
+}
+
+Value IndexedValue::toValue() const {
+  switch (type()) {
+  case arrayValue: {
+    Value array(arrayValue);
+    const ArrayIndex count = size();
+    array.reserve(count);
+    for (ArrayIndex index = 0; index < count; ++index)
+      array.append((*this)[index].toValue());
+    return array;
+  }
+  case objectValue: {
+    Value object(objectValue);
+    const ArrayIndex count = size();
+    for (ArrayIndex position = 0; position < count; ++position) {
+      char const* end;
+      char const* name = memberName(position, &end);
+      *object.demand(name, end) = member(position).toValue();
+    }
+    return object;
+  }
+  default:
+    return scalar();
+  }
+}
+
+// class IndexedDocument
+// //////////////////////////////////////////////////////////////////
+
+IndexedDocument::IndexedDocument(String bytes) : bytes_(std::move(bytes)) {
+  adopt(bytes_.data(), bytes_.size(), nullptr);
+}
+
+IndexedDocument::~IndexedDocument() { close(); }
+
+bool IndexedDocument::adopt(char const* data, size_t size, String* errs) {
+  char const* problem = nullptr;
+  if (size < indexedHeaderSize || memcmp(data, indexedMagic, 8) != 0)
+    problem = "not an indexed JSON document";
+  else if (loadWord(data + 16) != size)
+    problem = "the document is truncated or has trailing bytes";
+  else {
+    const uint64_t root = loadWord(data + 8);
+    if ((root & slotTagMask) == slotNode &&
+        (root < indexedHeaderSize || root > size - 8))
+      problem = "the root is outside the document";
+    else
+      root_ = root;
+  }
+  if (problem) {
+    if (errs)
+      *errs = problem;
+    return false;
+  }
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+bool IndexedDocument::open(String const& path, String* errs) {
+  close();
+#ifdef _WIN32
+  const int wideLength =
+      MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  std::wstring widePath(static_cast<size_t>(std::max(wideLength, 1)), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0],
+                      wideLength);
+  HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  LARGE_INTEGER fileSize;
+  HANDLE mapping = nullptr;
+  if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &fileSize) &&
+      fileSize.QuadPart > 0)
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping) {
+    mapping_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    mappedSize_ = static_cast<size_t>(fileSize.QuadPart);
+    CloseHandle(mapping);
+  }
+  if (file != INVALID_HANDLE_VALUE)
+    CloseHandle(file);
+  if (!mapping_) {
+    if (errs)
+      *errs = "Cannot map " + path;
+    return false;
+  }
+#else
+  const int file = ::open(path.c_str(), O_RDONLY);
+  struct stat status;
+  if (file >= 0 && fstat(file, &status) == 0 && status.st_size > 0) {
+    void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size),
+                        PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapped != MAP_FAILED) {
+      mapping_ = mapped;
+      mappedSize_ = static_cast<size_t>(status.st_size);
+    }
+  }
+  const int error = errno;
+  if (file >= 0)
+    ::close(file);
+  if (!mapping_) {
+    if (errs)
+      *errs = "Cannot map " + path + ": " + strerror(error);
+    return false;
+  }
+#endif
+  if (!adopt(static_cast<char const*>(mapping_), mappedSize_, errs)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void IndexedDocument::close() {
+  if (mapping_) {
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+#else
+    munmap(mapping_, mappedSize_);
+#endif
+    mapping_ = nullptr;
+    mappedSize_ = 0;
+  }
+  bytes_.clear();
+  data_ = nullptr;
+  size_ = 0;
+  root_ = 0;
+}
+
+IndexedValue IndexedDocument::root() const {
+  if (!data_)
+    return IndexedValue();
+  return IndexedValue(this, root_);
+}
+
+} // namespace Json
@@ -0,0 +1,358 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/assertions.h>
+#include <json/lazy.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Json {
+
+namespace {
+
+// The default stackLimit of CharReaderBuilder.
+const size_t lazyStackLimit = 1000;
+
+// A member or element of an array or object, see LazyValue.
+struct Child {
+  String name;
+  uint32_t position;
+  uint32_t container;
+};
+
+// Like Value orders its keys.
+int compareNames(String const& name, char const* key, size_t length) {
+  int comp = memcmp(name.data(), key, std::min(name.size(), length));
+  if (comp != 0)
+    return comp;
+  return name.size() < length ? -1 : (name.size() > length ? 1 : 0);
+}
+
+// Where the string, number or literal that starts at current ends.
+char const* scalarEnd(char const* current, char const* end) {
+  if (*current == '"') {
+    for (++current; *current != '"'; ++current)
+      if (*current == '\\')
+        ++current;
+    return current + 1;
+  }
+  while (current != end && !strchr(" \t\n\r,:[]{}\"", *current))
+    ++current;
+  return current;
+}
+
+// The same message as OurReader::getFormattedErrorMessages() would give.
+String formatError(char const* begin, size_t offset, char const* message) {
+  char const* const location = begin + offset;
+  char const* lastLineStart = begin;
+  int line = 1;
+  for (char const* current = begin; current < location;) {
+    const char c = *current++;
+    if (c == '\r' && current < location && *current == '\n')
+      ++current;
+    if (c == '\r' || c == '\n') {
+      lastLineStart = current;
+      ++line;
+    }
+  }
+  char buffer[18 + 16 + 16 + 1];
+  jsoncpp_snprintf(buffer, sizeof(buffer), "Line %d, Column %d", line,
+                   int(location - lastLineStart) + 1);
+  return String("* ") + buffer + "\n  " + message + "\n";
+}
+
+} // namespace
+
+// The text with its index, and the members or elements of every array and
+// object listed so far, by number.
+struct LazyDocument::Text {
+  String bytes;
+  char const* begin{nullptr};
+  char const* end{nullptr};
+  StructuralIndex index;
+  std::mutex mutex;
+  std::unordered_map<uint32_t, std::unique_ptr<std::vector<Child>>> lists;
+
+  std::vector<Child> const& children(uint32_t position, uint32_t container);
+};
+
+std::vector<Child> const& LazyDocument::Text::children(uint32_t position,
+                                                       uint32_t container) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<std::vector<Child>>& listed = lists[container];
+  if (listed)
+    return *listed;
+  auto list = std::unique_ptr<std::vector<Child>>(new std::vector<Child>());
+  uint32_t const* const positions = index.positions.data();
+  const bool isObject = begin[positions[position]] == '{';
+  const uint32_t close = index.containers[container].close;
+  uint32_t next = position + 1;
+  uint32_t nextContainer = container + 1;
+  while (next != close) {
+    Child child;
+    if (isObject) {
+      Value name;
+      readStructural(begin, end, index, next, name);
+      child.name = name.asString();
+      // Past the name and the colon.
+      next += 2;
+    }
+    child.position = next;
+    child.container = 0;
+    const char c = begin[positions[next]];
+    if (c == '{' || c == '[') {
+      // Skip everything within it.
+      child.container = nextContainer;
+      next = index.containers[nextContainer].close + 1;
+      nextContainer = index.containers[nextContainer].next;
+    } else {
+      ++next;
+    }
+    list->push_back(std::move(child));
+    // Past the comma.
+    if (next != close)
+      ++next;
+  }
+  if (isObject) {
+    std::stable_sort(list->begin(), list->end(),
+                     [](Child const& a, Child const& b) {
+                       return compareNames(a.name, b.name.data(),
+                                           b.name.size()) < 0;
+                     });
+    // Of duplicate names the last one read is kept, as in Value.
+    size_t kept = 0;
+    for (size_t index = 0; index != list->size(); ++index) {
+      Child& child = (*list)[index];
+      if (kept != 0 && (*list)[kept - 1].name == child.name)
+        (*list)[kept - 1] = std::move(child);
+      else if (kept++ != index)
+        (*list)[kept - 1] = std::move(child);
+    }
+    list->resize(kept);
+  }
+  listed = std::move(list);
+  return *listed;
+}
+
+// class LazyValue
+// //////////////////////////////////////////////////////////////////
+
+char LazyValue::first() const {
+  LazyDocument::Text const& text = *document_->text_;
+  return text.begin[text.index.positions[position_]];
+}
+
+ValueType LazyValue::type() const {
+  if (!document_)
+    return nullValue;
+  switch (first()) {
+  case '{':
+    return objectValue;
+  case '[':
+    return arrayValue;
+  case '"':
+    return stringValue;
+  case 't':
+  case 'f':
+    return booleanValue;
+  case 'n':
+    return nullValue;
+  default:
+    return scalar().type();
+  }
+}
+
+Value LazyValue::scalar() const {
+  if (!document_)
+    return Value();
+  switch (first()) {
+  case '{':
+    return Value(objectValue);
+  case '[':
+    return Value(arrayValue);
+  default:
+    return toValue();
+  }
+}
+
+ArrayIndex LazyValue::size() const {
+  if (!document_ || (first() != '{' && first() != '['))
+    return 0;
+  return ArrayIndex(document_->text_->children(position_, container_).size());
+}
+
+LazyValue LazyValue::operator[](ArrayIndex index) const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == arrayValue,
+      "in Json::LazyValue::operator[](ArrayIndex)const: requires "
+      "arrayValue");
+  if (kind == nullValue)
+    return LazyValue();
+  std::vector<Child> const& elements =
+      document_->text_->children(position_, container_);
+  if (index >= elements.size())
+    return LazyValue();
+  return LazyValue(document_, elements[index].position,
+                   elements[index].container);
+}
+
+LazyValue LazyValue::operator[](const char* key) const {
+  LazyValue found;
+  this->find(key, key + strlen(key), &found);
+  return found;
+}
+
+LazyValue LazyValue::operator[](const String& key) const {
+  LazyValue found;
+  this->find(key.data(), key.data() + key.length(), &found);
+  return found;
+}
+
+bool LazyValue::find(char const* begin, char const* end,
+                     LazyValue* found) const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == objectValue,
+      "in Json::LazyValue::find(begin, end): requires objectValue");
+  if (kind == nullValue)
+    return false;
+  std::vector<Child> const& members =
+      document_->text_->children(position_, container_);
+  const size_t length = size_t(end - begin);
+  auto it = std::lower_bound(members.begin(), members.end(), begin,
+                             [length](Child const& member, char const* key) {
+                               return compareNames(member.name, key,
+                                                   length) < 0;
+                             });
+  if (it == members.end() || compareNames(it->name, begin, length) != 0)
+    return false;
+  *found = LazyValue(document_, it->position, it->container);
+  return true;
+}
+
+bool LazyValue::isMember(const char* key) const {
+  LazyValue found;
+  return find(key, key + strlen(key), &found);
+}
+
+bool LazyValue::isMember(const String& key) const {
+  LazyValue found;
+  return find(key.data(), key.data() + key.length(), &found);
+}
+
+char const* LazyValue::memberName(ArrayIndex position,
+                                  char const** end) const {
+  JSON_ASSERT_MESSAGE(type() == objectValue && position < size(),
+                      "in Json::LazyValue::memberName(): requires an "
+                      "objectValue with a member at position");
+  String const& name =
+      document_->text_->children(position_, container_)[position].name;
+  *end = name.data() + name.size();
+  return name.data();
+}
+
+LazyValue LazyValue::member(ArrayIndex position) const {
+  JSON_ASSERT_MESSAGE(type() == objectValue && position < size(),
+                      "in Json::LazyValue::member(): requires an "
+                      "objectValue with a member at position");
+  Child const& child =
+      document_->text_->children(position_, container_)[position];
+  return LazyValue(document_, child.position, child.container);
+}
+
+Value::Members LazyValue::getMemberNames() const {
+  const ValueType kind = type();
+  JSON_ASSERT_MESSAGE(
+      kind == nullValue || kind == objectValue,
+      "in Json::LazyValue::getMemberNames(), value must be objectValue");
+  Value::Members members;
+  if (kind == nullValue)
+    return members;
+  std::vector<Child> const& children =
+      document_->text_->children(position_, container_);
+  members.reserve(children.size());
+  for (Child const& child : children)
+    members.push_back(child.name);
+  return members;
+}
+
+void LazyValue::getText(char const** begin, char const** end) const {
+  if (!document_) {
+    *begin = *end = nullptr;
+    return;
+  }
+  LazyDocument::Text const& text = *document_->text_;
+  *begin = text.begin + text.index.positions[position_];
+  if (**begin == '{' || **begin == '[')
+    *end = text.begin +
+           text.index.positions[text.index.containers[container_].close] + 1;
+  else
+    *end = scalarEnd(*begin, text.end);
+}
+
+Value LazyValue::toValue() const {
+  Value value;
+  if (!document_)
+    return value;
+  LazyDocument::Text const& text = *document_->text_;
+  if (!readStructural(text.begin, text.end, text.index, position_, value))
+    JSON_FAIL_MESSAGE("LazyValue: a checked value could not be read");
+  return value;
+}
+
+// class LazyDocument
+// //////////////////////////////////////////////////////////////////
+
+LazyDocument::LazyDocument() = default;
+
+LazyDocument::~LazyDocument() = default;
+
+bool LazyDocument::parse(char const* begin, char const* end, String* errs) {
+  return parse(String(begin, end), errs);
+}
+
+bool LazyDocument::parse(String text, String* errs) {
+  clear();
+  auto parsed = std::unique_ptr<Text>(new Text());
+  parsed->bytes = std::move(text);
+  parsed->begin = parsed->bytes.data();
+  parsed->end = parsed->begin + parsed->bytes.size();
+  // Offsets count from after a byte order mark, as in OurReader.
+  if (parsed->end - parsed->begin >= 3 &&
+      memcmp(parsed->begin, "\xEF\xBB\xBF", 3) == 0)
+    parsed->begin += 3;
+  size_t errorOffset;
+  char const* error;
+  if (!indexStructural(parsed->begin, parsed->end, lazyStackLimit,
+                       parsed->index, errorOffset, error)) {
+    if (errs)
+      *errs = formatError(parsed->begin, errorOffset, error);
+    return false;
+  }
+  text_ = std::move(parsed);
+  if (errs)
+    errs->clear();
+  return true;
+}
+
+void LazyDocument::clear() { text_.reset(); }
+
+bool LazyDocument::isParsed() const { return text_ != nullptr; }
+
+LazyValue LazyDocument::root() const {
+  if (!text_)
+    return LazyValue();
+  return LazyValue(this, 0, 0);
+}
+
+} // namespace Json
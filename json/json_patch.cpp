@@ -0,0 +1,454 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/patch.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Json {
+
+namespace {
+
+int compareNames(char const* a, size_t aLength, char const* b,
+                 size_t bLength) {
+  int comp = memcmp(a, b, std::min(aLength, bLength));
+  if (comp != 0)
+    return comp;
+  return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+void appendIndex(String& path, ArrayIndex index) {
+  UIntToStringBuffer buffer;
+  char* digits = buffer + sizeof(buffer);
+  uintToString(LargestUInt(index), digits);
+  path += '/';
+  path += digits;
+}
+
+void appendName(String& path, char const* begin, char const* end) {
+  path += '/';
+  for (; begin != end; ++begin) {
+    if (*begin == '~')
+      path += "~0";
+    else if (*begin == '/')
+      path += "~1";
+    else
+      path += *begin;
+  }
+}
+
+class PatchWriter {
+public:
+  explicit PatchWriter(Value& operations) : operations_(operations) {}
+
+  void diff(Value const& from, Value const& to) {
+    if (from == to)
+      return;
+    if (from.type() == objectValue && to.type() == objectValue)
+      diffObjects(from, to);
+    else if (from.type() == arrayValue && to.type() == arrayValue)
+      diffArrays(from, to);
+    else
+      emit("replace", &to);
+  }
+
+private:
+  void emit(char const* op, Value const* value) {
+    Value& operation = operations_.append(Value(objectValue));
+    operation["op"] = op;
+    operation["path"] = path_;
+    if (value)
+      operation["value"] = *value;
+  }
+
+  void diffObjects(Value const& from, Value const& to) {
+    // Both iterate in key order, so one pass pairs the members up.
+    const size_t length = path_.length();
+    auto mine = from.begin();
+    auto theirs = to.begin();
+    while (mine != from.end() || theirs != to.end()) {
+      char const* mineEnd = nullptr;
+      char const* mineName =
+          mine != from.end() ? mine.memberName(&mineEnd) : nullptr;
+      char const* theirsEnd = nullptr;
+      char const* theirsName =
+          theirs != to.end() ? theirs.memberName(&theirsEnd) : nullptr;
+      int comp = !mineName     ? 1
+                 : !theirsName ? -1
+                               : compareNames(mineName,
+                                              size_t(mineEnd - mineName),
+                                              theirsName,
+                                              size_t(theirsEnd - theirsName));
+      if (comp < 0) {
+        appendName(path_, mineName, mineEnd);
+        emit("remove", nullptr);
+        ++mine;
+      } else if (comp > 0) {
+        appendName(path_, theirsName, theirsEnd);
+        emit("add", &*theirs);
+        ++theirs;
+      } else {
+        appendName(path_, mineName, mineEnd);
+        diff(*mine, *theirs);
+        ++mine;
+        ++theirs;
+      }
+      path_.resize(length);
+    }
+  }
+
+  void diffArrays(Value const& from, Value const& to) {
+    const size_t length = path_.length();
+    const ArrayIndex fromSize = from.size();
+    const ArrayIndex toSize = to.size();
+    const ArrayIndex shorter = std::min(fromSize, toSize);
+    ArrayIndex prefix = 0;
+    while (prefix < shorter && from[prefix] == to[prefix])
+      ++prefix;
+    ArrayIndex suffix = 0;
+    while (suffix < shorter - prefix &&
+           from[fromSize - 1 - suffix] == to[toSize - 1 - suffix])
+      ++suffix;
+    const ArrayIndex fromMiddle = fromSize - prefix - suffix;
+    const ArrayIndex toMiddle = toSize - prefix - suffix;
+    const ArrayIndex paired = std::min(fromMiddle, toMiddle);
+    for (ArrayIndex i = prefix; i < prefix + paired; ++i) {
+      appendIndex(path_, i);
+      diff(from[i], to[i]);
+      path_.resize(length);
+    }
+    // What is left over in the middle of one side is removed or added.
+    appendIndex(path_, prefix + paired);
+    for (ArrayIndex i = paired; i < fromMiddle; ++i)
+      emit("remove", nullptr);
+    path_.resize(length);
+    for (ArrayIndex i = paired; i < toMiddle; ++i) {
+      appendIndex(path_, prefix + i);
+      emit("add", &to[prefix + i]);
+      path_.resize(length);
+    }
+  }
+
+  Value& operations_;
+  String path_;
+};
+
+// "test" compares numbers by value, anything else like operator==.
+bool equalForTest(Value const& a, Value const& b) {
+  if (a.isNumeric() && b.isNumeric()) {
+    if (a.type() == realValue || b.type() == realValue)
+      return a.asDouble() == b.asDouble();
+    if (a.isInt64() && b.isInt64())
+      return a.asInt64() == b.asInt64();
+    return a.isUInt64() && b.isUInt64() && a.asUInt64() == b.asUInt64();
+  }
+  if (a.type() != b.type())
+    return false;
+  if (a.type() == arrayValue) {
+    if (a.size() != b.size())
+      return false;
+    for (ArrayIndex index = 0; index < a.size(); ++index) {
+      if (!equalForTest(a[index], b[index]))
+        return false;
+    }
+    return true;
+  }
+  if (a.type() == objectValue) {
+    if (a.size() != b.size())
+      return false;
+    for (auto it = a.begin(); it != a.end(); ++it) {
+      char const* end;
+      char const* name = it.memberName(&end);
+      Value const* other = b.find(name, end);
+      if (!other || !equalForTest(*it, *other))
+        return false;
+    }
+    return true;
+  }
+  return a == b;
+}
+
+class PatchApplier {
+public:
+  bool apply(Value& root, Value const& patch) {
+    if (!patch.isArray()) {
+      error_ = "* The patch is not an array.\n";
+      return false;
+    }
+    for (ArrayIndex index = 0; index < patch.size(); ++index) {
+      index_ = index;
+      if (!applyOperation(root, patch[index]))
+        return false;
+    }
+    return true;
+  }
+
+  String const& error() const { return error_; }
+
+private:
+  bool fail(String const& message) {
+    UIntToStringBuffer buffer;
+    char* number = buffer + sizeof(buffer);
+    uintToString(LargestUInt(index_), number);
+    error_ = String("* Operation ") + number + ": " + message + "\n";
+    return false;
+  }
+
+  // Splits pointer into its unescaped tokens.
+  bool parsePointer(Value const& pointer, std::vector<String>& tokens) {
+    tokens.clear();
+    char const* begin;
+    char const* end;
+    if (!pointer.getString(&begin, &end))
+      return fail("A path is not a string.");
+    if (begin == end)
+      return true;
+    if (*begin != '/')
+      return fail("Path \"" + pointer.asString() +
+                  "\" does not start with '/'.");
+    for (++begin;; ++begin) {
+      String token;
+      for (; begin != end && *begin != '/'; ++begin) {
+        if (*begin != '~') {
+          token += *begin;
+        } else if (end - begin > 1 && (begin[1] == '0' || begin[1] == '1')) {
+          token += begin[1] == '0' ? '~' : '/';
+          ++begin;
+        } else {
+          return fail("Path \"" + pointer.asString() +
+                      "\" has a '~' that is not ~0 or ~1.");
+        }
+      }
+      tokens.push_back(std::move(token));
+      if (begin == end)
+        return true;
+    }
+  }
+
+  // An array index token; "-" (past the end) only if allowEnd.
+  bool parseIndex(String const& token, Value const& array, bool allowEnd,
+                  ArrayIndex& index) {
+    const ArrayIndex size = array.size();
+    if (token == "-" && allowEnd) {
+      index = size;
+      return true;
+    }
+    bool digits = !token.empty() && token.length() <= 10 &&
+                  (token[0] != '0' || token.length() == 1);
+    LargestUInt value = 0;
+    for (char c : token) {
+      digits = digits && c >= '0' && c <= '9';
+      value = value * 10 + LargestUInt(c - '0');
+    }
+    if (!digits || value > size || (value == size && !allowEnd))
+      return fail("Index \"" + token + "\" is not in the array.");
+    index = ArrayIndex(value);
+    return true;
+  }
+
+  // The value at tokens, read only.
+  Value const* find(Value const& root, std::vector<String> const& tokens) {
+    Value const* node = &root;
+    for (String const& token : tokens) {
+      if (node->isObject()) {
+        node = node->find(token.data(), token.data() + token.length());
+      } else if (node->isArray()) {
+        ArrayIndex index = 0;
+        if (!parseIndex(token, *node, false, index))
+          return nullptr;
+        node = &(*node)[index];
+      } else {
+        node = nullptr;
+      }
+      if (!node) {
+        fail("Path \"" + pathText(tokens) + "\" does not exist.");
+        return nullptr;
+      }
+    }
+    return node;
+  }
+
+  // The container holding the last of tokens, to be modified.
+  Value* findParent(Value& root, std::vector<String> const& tokens) {
+    Value* node = &root;
+    for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+      String const& token = tokens[i];
+      if (node->isObject()) {
+        char const* end = token.data() + token.length();
+        node = node->find(token.data(), end) ? node->demand(token.data(), end)
+                                             : nullptr;
+      } else if (node->isArray()) {
+        ArrayIndex index = 0;
+        if (!parseIndex(token, *node, false, index))
+          return nullptr;
+        node = &(*node)[index];
+      } else {
+        node = nullptr;
+      }
+      if (!node) {
+        fail("Path \"" + pathText(tokens) + "\" does not exist.");
+        return nullptr;
+      }
+    }
+    if (!node->isObject() && !node->isArray()) {
+      fail("Path \"" + pathText(tokens) + "\" is not in an array or object.");
+      return nullptr;
+    }
+    return node;
+  }
+
+  static String pathText(std::vector<String> const& tokens) {
+    String path;
+    for (String const& token : tokens)
+      appendName(path, token.data(), token.data() + token.length());
+    return path;
+  }
+
+  bool add(Value& root, std::vector<String> const& tokens,
+           Value const& value) {
+    if (tokens.empty()) {
+      root = value;
+      return true;
+    }
+    Value* parent = findParent(root, tokens);
+    if (!parent)
+      return false;
+    String const& last = tokens.back();
+    if (parent->isObject()) {
+      *parent->demand(last.data(), last.data() + last.length()) = value;
+      return true;
+    }
+    ArrayIndex index = 0;
+    if (!parseIndex(last, *parent, true, index))
+      return false;
+    parent->insert(index, value);
+    return true;
+  }
+
+  bool remove(Value& root, std::vector<String> const& tokens) {
+    if (tokens.empty())
+      return fail("The whole document cannot be removed.");
+    Value* parent = findParent(root, tokens);
+    if (!parent)
+      return false;
+    String const& last = tokens.back();
+    if (parent->isObject()) {
+      if (!parent->removeMember(last.data(), last.data() + last.length(),
+                                nullptr))
+        return fail("Path \"" + pathText(tokens) + "\" does not exist.");
+      return true;
+    }
+    ArrayIndex index = 0;
+    if (!parseIndex(last, *parent, false, index))
+      return false;
+    parent->removeIndex(index, nullptr);
+    return true;
+  }
+
+  bool replace(Value& root, std::vector<String> const& tokens,
+               Value const& value) {
+    if (tokens.empty()) {
+      root = value;
+      return true;
+    }
+    Value* parent = findParent(root, tokens);
+    if (!parent)
+      return false;
+    String const& last = tokens.back();
+    if (parent->isObject()) {
+      char const* end = last.data() + last.length();
+      if (!parent->find(last.data(), end))
+        return fail("Path \"" + pathText(tokens) + "\" does not exist.");
+      *parent->demand(last.data(), end) = value;
+      return true;
+    }
+    ArrayIndex index = 0;
+    if (!parseIndex(last, *parent, false, index))
+      return false;
+    (*parent)[index] = value;
+    return true;
+  }
+
+  bool applyOperation(Value& root, Value const& operation) {
+    if (!operation.isObject())
+      return fail("An operation is not an object.");
+    Value const& op = operation["op"];
+    if (!op.isString())
+      return fail("The member \"op\" is missing.");
+    if (!operation.isMember("path"))
+      return fail("The member \"path\" is missing.");
+    if (!parsePointer(operation["path"], path_))
+      return false;
+    const String name = op.asString();
+    if (name == "remove")
+      return remove(root, path_);
+
+    if (name == "move" || name == "copy") {
+      if (!operation.isMember("from"))
+        return fail("The member \"from\" is missing.");
+      if (!parsePointer(operation["from"], from_))
+        return false;
+      Value const* source = find(root, from_);
+      if (!source)
+        return false;
+      if (name == "copy")
+        return add(root, path_, Value(*source));
+      if (from_ == path_)
+        return true;
+      if (from_.size() < path_.size() &&
+          std::equal(from_.begin(), from_.end(), path_.begin()))
+        return fail("A value cannot be moved into itself.");
+      Value moved(*source);
+      return remove(root, from_) && add(root, path_, moved);
+    }
+
+    Value const* value = operation.find("value", "value" + 5);
+    if (!value)
+      return fail("The member \"value\" is missing.");
+    if (name == "add")
+      return add(root, path_, *value);
+    if (name == "replace")
+      return replace(root, path_, *value);
+    if (name == "test") {
+      Value const* target = find(root, path_);
+      if (!target)
+        return false;
+      if (!equalForTest(*target, *value))
+        return fail("Test of \"" + pathText(path_) + "\" failed.");
+      return true;
+    }
+    return fail("Unknown operation \"" + name + "\".");
+  }
+
+  ArrayIndex index_{0};
+  std::vector<String> path_;
+  std::vector<String> from_;
+  String error_;
+};
+
+} // namespace
+
+Value createPatch(Value const& from, Value const& to) {
+  Value operations(arrayValue);
+  PatchWriter(operations).diff(from, to);
+  return operations;
+}
+
+bool applyPatch(Value* root, Value const& patch, String* errs) {
+  Value patched(*root);
+  PatchApplier applier;
+  bool ok = applier.apply(patched, patch);
+  if (ok)
+    root->swap(patched);
+  if (errs)
+    *errs = applier.error();
+  return ok;
+}
+
+} // namespace Json
@@ -0,0 +1,273 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/query.h>
+#include <json/reader.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cstring>
+#include <memory>
+
+namespace Json {
+
+namespace {
+
+// A filter compares numbers by value, anything else like operator==.
+bool equalForFilter(Value const& a, Value const& b) {
+  if (a.isNumeric() && b.isNumeric()) {
+    if (a.type() == realValue || b.type() == realValue)
+      return a.asDouble() == b.asDouble();
+    if (a.isInt64() && b.isInt64())
+      return a.asInt64() == b.asInt64();
+    return a.isUInt64() && b.isUInt64() && a.asUInt64() == b.asUInt64();
+  }
+  return a == b;
+}
+
+// The member a key step leads to: the one found, or for a tree that is to be
+// modified the same member taken again through the non-const accessor.
+Value const& member(Value const&, Value const& found, String const&) {
+  return found;
+}
+Value& member(Value& node, Value const&, String const& name) {
+  return node[name];
+}
+
+class QueryParser {
+public:
+  explicit QueryParser(String const& path)
+      : path_(path), current_(path.data()), end_(current_ + path.size()) {}
+
+  void parse(Query& query) {
+    if (current_ != end_ && *current_ == '.')
+      ++current_;
+    while (current_ != end_) {
+      if (*current_ == '[') {
+        ++current_;
+        parseBracket(query);
+        expect(']');
+      } else {
+        if (*current_ == '.' && ++current_ == end_)
+          fail("a member name or '*' expected");
+        if (*current_ == '[')
+          continue;
+        if (*current_ == '*') {
+          ++current_;
+          query.any();
+        } else if (*current_ == '"') {
+          query.key(parseLiteral().asString());
+          if (current_ != end_ && *current_ != '.' && *current_ != '[')
+            fail("'.' or '[' expected");
+        } else {
+          query.key(parseName());
+        }
+      }
+    }
+  }
+
+private:
+  void parseBracket(Query& query) {
+    if (current_ == end_)
+      fail("']' expected");
+    if (*current_ == '*') {
+      ++current_;
+      query.any();
+    } else if (*current_ == '"') {
+      query.key(parseLiteral().asString());
+    } else if (*current_ == '?') {
+      ++current_;
+      String name =
+          current_ != end_ && *current_ == '"' ? parseLiteral().asString()
+                                               : parseFilterName();
+      expect('=');
+      expect('=');
+      query.where(std::move(name), parseLiteral());
+    } else {
+      ArrayIndex index = 0;
+      char const* digits = current_;
+      for (; current_ != end_ && *current_ >= '0' && *current_ <= '9';
+           ++current_) {
+        if (index > (Value::maxUInt - 9) / 10)
+          fail("index too large");
+        index = index * 10 + ArrayIndex(*current_ - '0');
+      }
+      if (current_ == digits)
+        fail("an index, '*', '?' or a quoted name expected");
+      query.index(index);
+    }
+  }
+
+  String parseName() {
+    char const* begin = current_;
+    while (current_ != end_ && *current_ != '.' && *current_ != '[')
+      ++current_;
+    if (current_ == begin)
+      fail("a member name expected");
+    return String(begin, current_);
+  }
+
+  String parseFilterName() {
+    char const* begin = current_;
+    while (current_ != end_ && *current_ != '=' && *current_ != ']')
+      ++current_;
+    if (current_ == begin)
+      fail("a member name expected");
+    return String(begin, current_);
+  }
+
+  // A JSON string, number, true, false or null, read by a strict reader.
+  Value parseLiteral() {
+    char const* begin = current_;
+    if (current_ != end_ && *current_ == '"') {
+      for (++current_; current_ != end_ && *current_ != '"'; ++current_) {
+        if (*current_ == '\\' && ++current_ == end_)
+          break;
+      }
+      if (current_ == end_)
+        fail("unterminated string");
+      ++current_;
+    } else {
+      while (current_ != end_ && *current_ != ']')
+        ++current_;
+    }
+    CharReaderBuilder builder;
+    CharReaderBuilder::strictMode(&builder.settings_);
+    builder["strictRoot"] = false;
+    std::unique_ptr<CharReader> const reader(builder.newCharReader());
+    Value literal;
+    if (begin == current_ || !reader->parse(begin, current_, &literal, nullptr) ||
+        literal.isArray() || literal.isObject()) {
+      current_ = begin;
+      fail("a JSON string, number, true, false or null expected");
+    }
+    return literal;
+  }
+
+  void expect(char c) {
+    if (current_ == end_ || *current_ != c)
+      fail(String("'") + c + "' expected");
+    ++current_;
+  }
+
+  JSONCPP_NORETURN void fail(String const& message) {
+    UIntToStringBuffer buffer;
+    char* offset = buffer + sizeof(buffer);
+    uintToString(LargestUInt(current_ - path_.data()), offset);
+    throwLogicError("in Json::Query::Query(): invalid path \"" + path_ +
+                    "\" at offset " + offset + ": " + message);
+  }
+
+  String const& path_;
+  char const* current_;
+  char const* end_;
+};
+
+} // namespace
+
+Query::Query() = default;
+
+Query::Query(const String& path) { QueryParser(path).parse(*this); }
+
+Query& Query::key(String name) {
+  steps_.push_back(Step{Step::kindKey, std::move(name), 0, Value()});
+  return *this;
+}
+
+Query& Query::index(ArrayIndex index) {
+  steps_.push_back(Step{Step::kindIndex, String(), index, Value()});
+  return *this;
+}
+
+Query& Query::any() {
+  steps_.push_back(Step{Step::kindAny, String(), 0, Value()});
+  return *this;
+}
+
+Query& Query::where(String name, Value value) {
+  steps_.push_back(
+      Step{Step::kindWhere, std::move(name), 0, std::move(value)});
+  return *this;
+}
+
+// Calls visit for every match below node, in document order, until it
+// returns false; returns false then as well.
+template <typename Node, typename Visitor>
+bool Query::walk(Node& node, Step const* step, Step const* end,
+                 Visitor& visit) {
+  if (step == end)
+    return visit(node);
+  switch (step->kind_) {
+  case Step::kindKey: {
+    if (!node.isObject())
+      return true;
+    char const* name = step->name_.data();
+    Value const* found =
+        static_cast<Value const&>(node).find(name, name + step->name_.size());
+    return !found ||
+           walk(member(node, *found, step->name_), step + 1, end, visit);
+  }
+  case Step::kindIndex:
+    if (!node.isArray() || step->index_ >= node.size())
+      return true;
+    return walk(node[step->index_], step + 1, end, visit);
+  case Step::kindAny:
+  case Step::kindWhere:
+    if (!node.isArray() && !node.isObject())
+      return true;
+    for (auto& child : node) {
+      if (step->kind_ == Step::kindWhere) {
+        if (!child.isObject())
+          continue;
+        char const* name = step->name_.data();
+        Value const* value = static_cast<Value const&>(child).find(
+            name, name + step->name_.size());
+        if (!value || !equalForFilter(*value, step->value_))
+          continue;
+      }
+      if (!walk(child, step + 1, end, visit))
+        return false;
+    }
+    return true;
+  }
+  return true;
+}
+
+Value const* Query::find(const Value& root) const {
+  Value const* first = nullptr;
+  auto visit = [&first](Value const& match) {
+    first = &match;
+    return false;
+  };
+  walk(root, steps_.data(), steps_.data() + steps_.size(), visit);
+  return first;
+}
+
+const Value& Query::resolve(const Value& root) const {
+  Value const* first = find(root);
+  return first ? *first : Value::nullSingleton();
+}
+
+std::vector<Value const*> Query::findAll(const Value& root) const {
+  std::vector<Value const*> matches;
+  auto visit = [&matches](Value const& match) {
+    matches.push_back(&match);
+    return true;
+  };
+  walk(root, steps_.data(), steps_.data() + steps_.size(), visit);
+  return matches;
+}
+
+std::vector<Value*> Query::findAll(Value& root) const {
+  std::vector<Value*> matches;
+  auto visit = [&matches](Value& match) {
+    matches.push_back(&match);
+    return true;
+  };
+  walk(root, steps_.data(), steps_.data() + steps_.size(), visit);
+  return matches;
+}
+
+} // namespace Json
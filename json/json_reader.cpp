@@ -112,7 +112,8 @@ bool Reader::parse(std::istream& is, Value& root, bool collectComments) {
 
 bool Reader::parse(const char* beginDoc, const char* endDoc, Value& root,
                    bool collectComments) {
-  if (!features_.allowComments_) {
+  // Lean values have nowhere to keep comments.
+  if (!features_.allowComments_ || JSON_USE_LEAN_VALUE) {
     collectComments = false;
   }
 
@@ -432,6 +433,7 @@ void Reader::readNumber() {
 bool Reader::readString() {
   Char c = '\0';
   while (current_ != end_) {
+    current_ = findQuoteOrBackslash(current_, end_, '"');
     c = getNextChar();
     if (c == '\\')
       getNextChar();
@@ -511,6 +513,10 @@ bool Reader::readArray(Token& token) {
   int index = 0;
   for (;;) {
     Value& value = currentValue()[index++];
+    // Growing the array may have moved the previous element, which a comment
+    // on its line still has to be attached to.
+    if (collectComments_ && index > 1)
+      lastValue_ = &currentValue()[index - 2];
     nodes_.push(&value);
     bool ok = readValue();
     nodes_.pop();
@@ -600,6 +606,10 @@ bool Reader::decodeDouble(Token& token) {
 
 bool Reader::decodeDouble(Token& token, Value& decoded) {
   double value = 0;
+  if (parseDouble(token.start_, token.end_, value)) {
+    decoded = value;
+    return true;
+  }
   String buffer(token.start_, token.end_);
   buffer += '\0';
   IStringStream is(buffer);
@@ -633,6 +643,11 @@ bool Reader::decodeString(Token& token, String& decoded) {
   Location current = token.start_ + 1; // skip '"'
   Location end = token.end_ - 1;       // do not include '"'
   while (current != end) {
+    // Copy the plain run up to the next quote or escape in one go.
+    Location plain = findQuoteOrBackslash(current, end, '"');
+    decoded.append(current, plain);
+    if ((current = plain) == end)
+      break;
     Char c = *current++;
     if (c == '"')
       break;
@@ -674,8 +689,6 @@ bool Reader::decodeString(Token& token, String& decoded) {
       default:
         return addError("Bad escape sequence in string", token, current);
       }
-    } else {
-      decoded += c;
     }
   }
   return true;
@@ -902,6 +915,7 @@ public:
   explicit OurReader(OurFeatures const& features);
   bool parse(const char* beginDoc, const char* endDoc, Value& root,
              bool collectComments = true);
+  bool parse(const char* beginDoc, const char* endDoc, SaxHandler& handler);
   String getFormattedErrorMessages() const;
   std::vector<StructuredError> getStructuredErrors() const;
 
@@ -958,6 +972,11 @@ private:
   bool readValue();
   bool readObject(Token& token);
   bool readArray(Token& token);
+  bool readValue(SaxHandler& handler, size_t depth);
+  bool readObject(Token& token, SaxHandler& handler, size_t depth);
+  bool readArray(Token& token, SaxHandler& handler, size_t depth);
+  bool readNumber(Token& token, SaxHandler& handler);
+  bool accepted(bool accept, Token& token);
   bool decodeNumber(Token& token);
   bool decodeNumber(Token& token, Value& decoded);
   bool decodeString(Token& token);
@@ -996,6 +1015,7 @@ private:
   Value* lastValue_ = nullptr;
   bool lastValueHasAComment_ = false;
   String commentsBefore_{};
+  String eventString_{};
 
   OurFeatures const features_;
   bool collectComments_ = false;
@@ -1012,7 +1032,8 @@ OurReader::OurReader(OurFeatures const& features) : features_(features) {}
 
 bool OurReader::parse(const char* beginDoc, const char* endDoc, Value& root,
                       bool collectComments) {
-  if (!features_.allowComments_) {
+  // Lean values have nowhere to keep comments.
+  if (!features_.allowComments_ || JSON_USE_LEAN_VALUE) {
     collectComments = false;
   }
 
@@ -1425,6 +1446,7 @@ bool OurReader::readNumber(bool checkInf) {
 bool OurReader::readString() {
   Char c = 0;
   while (current_ != end_) {
+    current_ = findQuoteOrBackslash(current_, end_, '"');
     c = getNextChar();
     if (c == '\\')
       getNextChar();
@@ -1437,6 +1459,7 @@ bool OurReader::readString() {
 bool OurReader::readStringSingleQuote() {
   Char c = 0;
   while (current_ != end_) {
+    current_ = findQuoteOrBackslash(current_, end_, '\'');
     c = getNextChar();
     if (c == '\\')
       getNextChar();
@@ -1528,6 +1551,10 @@ bool OurReader::readArray(Token& token) {
       return true;
     }
     Value& value = currentValue()[index++];
+    // Growing the array may have moved the previous element, which a comment
+    // on its line still has to be attached to.
+    if (collectComments_ && index > 1)
+      lastValue_ = &currentValue()[index - 2];
     nodes_.push(&value);
     bool ok = readValue();
     nodes_.pop();
@@ -1552,6 +1579,212 @@ bool OurReader::readArray(Token& token) {
   return true;
 }
 
+// Event variants of the above, which hand every value to a SaxHandler as
+// soon as it is read instead of building a tree. They stop at the first
+// error rather than recovering from it, which reports the same error.
+
+bool OurReader::parse(const char* beginDoc, const char* endDoc,
+                      SaxHandler& handler) {
+  begin_ = beginDoc;
+  end_ = endDoc;
+  collectComments_ = false;
+  current_ = begin_;
+  lastValueEnd_ = nullptr;
+  lastValue_ = nullptr;
+  commentsBefore_.clear();
+  errors_.clear();
+
+  skipBom(features_.skipBom_);
+  if (!readValue(handler, 1))
+    return false;
+  Token token;
+  skipCommentTokens(token);
+  if (features_.failIfExtra_ && (token.type_ != tokenEndOfStream)) {
+    addError("Extra non-whitespace after JSON value.", token);
+    return false;
+  }
+  return true;
+}
+
+bool OurReader::readValue(SaxHandler& handler, size_t depth) {
+  if (depth > features_.stackLimit_)
+    throwRuntimeError("Exceeded stackLimit in readValue().");
+  Token token;
+  skipCommentTokens(token);
+
+  // A scalar root is refused before it is passed on, anything else that is
+  // not an object or array is a syntax error below.
+  if (depth == 1 && features_.strictRoot_ && token.type_ >= tokenString &&
+      token.type_ <= tokenNegInf) {
+    token.type_ = tokenError;
+    token.start_ = begin_;
+    token.end_ = end_;
+    return addError(
+        "A valid JSON document must be either an array or an object value.",
+        token);
+  }
+
+  const ptrdiff_t offset = token.start_ - begin_;
+  switch (token.type_) {
+  case tokenObjectBegin:
+    return readObject(token, handler, depth);
+  case tokenArrayBegin:
+    return readArray(token, handler, depth);
+  case tokenNumber:
+    return readNumber(token, handler);
+  case tokenString:
+    eventString_.clear();
+    if (!decodeString(token, eventString_))
+      return false;
+    return accepted(handler.string(eventString_.data(),
+                                   eventString_.data() + eventString_.size(),
+                                   offset),
+                    token);
+  case tokenTrue:
+    return accepted(handler.boolean(true, offset), token);
+  case tokenFalse:
+    return accepted(handler.boolean(false, offset), token);
+  case tokenNull:
+    return accepted(handler.null(offset), token);
+  case tokenNaN:
+    return accepted(
+        handler.real(std::numeric_limits<double>::quiet_NaN(), offset), token);
+  case tokenPosInf:
+    return accepted(
+        handler.real(std::numeric_limits<double>::infinity(), offset), token);
+  case tokenNegInf:
+    return accepted(
+        handler.real(-std::numeric_limits<double>::infinity(), offset), token);
+  case tokenArraySeparator:
+  case tokenObjectEnd:
+  case tokenArrayEnd:
+    if (features_.allowDroppedNullPlaceholders_) {
+      // "Un-read" the current token, it stands for a null.
+      current_--;
+      return accepted(handler.null(current_ - begin_ - 1), token);
+    } // else, fall through ...
+  default:
+    return addError("Syntax error: value, object or array expected.", token);
+  }
+}
+
+bool OurReader::readObject(Token& token, SaxHandler& handler, size_t depth) {
+  if (!accepted(handler.startObject(token.start_ - begin_), token))
+    return false;
+  std::set<String> keys;
+  bool lastKeyEmpty = true;
+  Token tokenName;
+  while (readToken(tokenName)) {
+    bool initialTokenOk = true;
+    while (tokenName.type_ == tokenComment && initialTokenOk)
+      initialTokenOk = readToken(tokenName);
+    if (!initialTokenOk)
+      break;
+    if (tokenName.type_ == tokenObjectEnd &&
+        (lastKeyEmpty ||
+         features_.allowTrailingCommas_)) // empty object or trailing comma
+      return accepted(handler.endObject(tokenName.start_ - begin_),
+                      tokenName);
+    eventString_.clear();
+    if (tokenName.type_ == tokenString) {
+      if (!decodeString(tokenName, eventString_))
+        return false;
+    } else if (tokenName.type_ == tokenNumber && features_.allowNumericKeys_) {
+      Value numberName;
+      if (!decodeNumber(tokenName, numberName))
+        return false;
+      eventString_ = numberName.asString();
+    } else {
+      break;
+    }
+    lastKeyEmpty = eventString_.empty();
+    if (eventString_.length() >= (1U << 30))
+      throwRuntimeError("keylength >= 2^30");
+    if (features_.rejectDupKeys_ && !keys.insert(eventString_).second)
+      return addError("Duplicate key: '" + eventString_ + "'", tokenName);
+
+    Token colon;
+    if (!readToken(colon) || colon.type_ != tokenMemberSeparator)
+      return addError("Missing ':' after object member name", colon);
+    if (!accepted(handler.key(eventString_.data(),
+                              eventString_.data() + eventString_.size(),
+                              tokenName.start_ - begin_),
+                  tokenName))
+      return false;
+    if (!readValue(handler, depth + 1))
+      return false;
+
+    Token comma;
+    if (!readToken(comma) ||
+        (comma.type_ != tokenObjectEnd && comma.type_ != tokenArraySeparator &&
+         comma.type_ != tokenComment)) {
+      return addError("Missing ',' or '}' in object declaration", comma);
+    }
+    bool finalizeTokenOk = true;
+    while (comma.type_ == tokenComment && finalizeTokenOk)
+      finalizeTokenOk = readToken(comma);
+    if (comma.type_ == tokenObjectEnd)
+      return accepted(handler.endObject(comma.start_ - begin_), comma);
+  }
+  return addError("Missing '}' or object member name", tokenName);
+}
+
+bool OurReader::readArray(Token& token, SaxHandler& handler, size_t depth) {
+  if (!accepted(handler.startArray(token.start_ - begin_), token))
+    return false;
+  int index = 0;
+  for (;;) {
+    skipSpaces();
+    if (current_ != end_ && *current_ == ']' &&
+        (index == 0 ||
+         (features_.allowTrailingCommas_ &&
+          !features_.allowDroppedNullPlaceholders_))) // empty array or trailing
+                                                      // comma
+    {
+      Token endArray;
+      readToken(endArray);
+      return accepted(handler.endArray(endArray.start_ - begin_), endArray);
+    }
+    ++index;
+    if (!readValue(handler, depth + 1))
+      return false;
+
+    Token currentToken;
+    // Accept Comment after last item in the array.
+    bool ok = readToken(currentToken);
+    while (currentToken.type_ == tokenComment && ok) {
+      ok = readToken(currentToken);
+    }
+    bool badTokenType = (currentToken.type_ != tokenArraySeparator &&
+                         currentToken.type_ != tokenArrayEnd);
+    if (!ok || badTokenType)
+      return addError("Missing ',' or ']' in array declaration", currentToken);
+    if (currentToken.type_ == tokenArrayEnd)
+      return accepted(handler.endArray(currentToken.start_ - begin_),
+                      currentToken);
+  }
+}
+
+bool OurReader::readNumber(Token& token, SaxHandler& handler) {
+  Value decoded;
+  if (!decodeNumber(token, decoded))
+    return false;
+  const ptrdiff_t offset = token.start_ - begin_;
+  switch (decoded.type()) {
+  case intValue:
+    return accepted(handler.integer(decoded.asLargestInt(), offset), token);
+  case uintValue:
+    return accepted(handler.unsignedInteger(decoded.asLargestUInt(), offset),
+                    token);
+  default:
+    return accepted(handler.real(decoded.asDouble(), offset), token);
+  }
+}
+
+bool OurReader::accepted(bool accept, Token& token) {
+  return accept || addError("Parsing stopped by the event handler.", token);
+}
+
 bool OurReader::decodeNumber(Token& token) {
   Value decoded;
   if (!decodeNumber(token, decoded))
@@ -1654,6 +1887,10 @@ bool OurReader::decodeDouble(Token& token) {
 
 bool OurReader::decodeDouble(Token& token, Value& decoded) {
   double value = 0;
+  if (parseDouble(token.start_, token.end_, value)) {
+    decoded = value;
+    return true;
+  }
   const String buffer(token.start_, token.end_);
   IStringStream is(buffer);
   if (!(is >> value)) {
@@ -1685,6 +1922,11 @@ bool OurReader::decodeString(Token& token, String& decoded) {
   Location current = token.start_ + 1; // skip '"'
   Location end = token.end_ - 1;       // do not include '"'
   while (current != end) {
+    // Copy the plain run up to the next quote or escape in one go.
+    Location plain = findQuoteOrBackslash(current, end, '"');
+    decoded.append(current, plain);
+    if ((current = plain) == end)
+      break;
     Char c = *current++;
     if (c == '"')
       break;
@@ -1726,8 +1968,6 @@ bool OurReader::decodeString(Token& token, String& decoded) {
       default:
         return addError("Bad escape sequence in string", token, current);
       }
-    } else {
-      decoded += c;
     }
   }
   return true;
@@ -1890,8 +2130,109 @@ public:
     }
     return ok;
   }
+  bool parseEvents(char const* beginDoc, char const* endDoc,
+                   SaxHandler& handler, String* errs) override {
+    bool ok = reader_.parse(beginDoc, endDoc, handler);
+    if (errs) {
+      *errs = reader_.getFormattedErrorMessages();
+    }
+    return ok;
+  }
 };
 
+// Tries the two-pass reader of json_structural.cpp first, and leaves
+// whatever it does not take, errors included, to OurReader.
+class StructuralCharReader : public OurCharReader {
+  StructuralFeatures const structural_;
+
+public:
+  StructuralCharReader(bool collectComments, OurFeatures const& features,
+                       unsigned threads)
+      : OurCharReader(collectComments, features),
+        structural_{features.stackLimit_,  threads,
+                    features.skipBom_,     features.strictRoot_,
+                    features.failIfExtra_, features.rejectDupKeys_,
+                    collectComments && features.allowComments_} {}
+  bool parse(char const* beginDoc, char const* endDoc, Value* root,
+             String* errs) override {
+    if (parseStructural(beginDoc, endDoc, structural_, *root)) {
+      if (errs)
+        errs->clear();
+      return true;
+    }
+    return OurCharReader::parse(beginDoc, endDoc, root, errs);
+  }
+};
+
+SaxHandler::~SaxHandler() = default;
+bool SaxHandler::null(ptrdiff_t) { return true; }
+bool SaxHandler::boolean(bool, ptrdiff_t) { return true; }
+bool SaxHandler::integer(LargestInt, ptrdiff_t) { return true; }
+bool SaxHandler::unsignedInteger(LargestUInt, ptrdiff_t) { return true; }
+bool SaxHandler::real(double, ptrdiff_t) { return true; }
+bool SaxHandler::string(char const*, char const*, ptrdiff_t) { return true; }
+bool SaxHandler::startObject(ptrdiff_t) { return true; }
+bool SaxHandler::key(char const*, char const*, ptrdiff_t) { return true; }
+bool SaxHandler::endObject(ptrdiff_t) { return true; }
+bool SaxHandler::startArray(ptrdiff_t) { return true; }
+bool SaxHandler::endArray(ptrdiff_t) { return true; }
+
+namespace {
+// Feeds a parsed tree to a handler as if it was being read.
+bool replayEvents(Value const& value, SaxHandler& handler) {
+  const ptrdiff_t offset = value.getOffsetStart();
+  switch (value.type()) {
+  case nullValue:
+    return handler.null(offset);
+  case booleanValue:
+    return handler.boolean(value.asBool(), offset);
+  case intValue:
+    return handler.integer(value.asLargestInt(), offset);
+  case uintValue:
+    return handler.unsignedInteger(value.asLargestUInt(), offset);
+  case realValue:
+    return handler.real(value.asDouble(), offset);
+  case stringValue: {
+    char const* begin;
+    char const* end;
+    value.getString(&begin, &end);
+    return handler.string(begin, end, offset);
+  }
+  case arrayValue:
+    if (!handler.startArray(offset))
+      return false;
+    for (Value const& element : value)
+      if (!replayEvents(element, handler))
+        return false;
+    return handler.endArray(value.getOffsetLimit() - 1);
+  case objectValue:
+    if (!handler.startObject(offset))
+      return false;
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      char const* end;
+      char const* begin = it.memberName(&end);
+      if (!handler.key(begin, end, (*it).getOffsetStart()) ||
+          !replayEvents(*it, handler))
+        return false;
+    }
+    return handler.endObject(value.getOffsetLimit() - 1);
+  }
+  return true;
+}
+} // namespace
+
+bool CharReader::parseEvents(char const* beginDoc, char const* endDoc,
+                             SaxHandler& handler, String* errs) {
+  Value root;
+  if (!parse(beginDoc, endDoc, &root, errs))
+    return false;
+  if (replayEvents(root, handler))
+    return true;
+  if (errs)
+    *errs = "Parsing stopped by the event handler.\n";
+  return false;
+}
+
 CharReaderBuilder::CharReaderBuilder() { setDefaults(&settings_); }
 CharReaderBuilder::~CharReaderBuilder() = default;
 CharReader* CharReaderBuilder::newCharReader() const {
@@ -1912,6 +2253,9 @@ CharReader* CharReaderBuilder::newCharReader() const {
   features.rejectDupKeys_ = settings_["rejectDupKeys"].asBool();
   features.allowSpecialFloats_ = settings_["allowSpecialFloats"].asBool();
   features.skipBom_ = settings_["skipBom"].asBool();
+  if (settings_["structuralIndex"].asBool())
+    return new StructuralCharReader(collectComments, features,
+                                    settings_["parseThreads"].asUInt());
   return new OurCharReader(collectComments, features);
 }
 
@@ -1929,6 +2273,8 @@ bool CharReaderBuilder::validate(Json::Value* invalid) const {
       "rejectDupKeys",
       "allowSpecialFloats",
       "skipBom",
+      "structuralIndex",
+      "parseThreads",
   };
   for (auto si = settings_.begin(); si != settings_.end(); ++si) {
     auto key = si.name();
@@ -1976,6 +2322,8 @@ void CharReaderBuilder::setDefaults(Json::Value* settings) {
   (*settings)["rejectDupKeys"] = false;
   (*settings)["allowSpecialFloats"] = false;
   (*settings)["skipBom"] = true;
+  (*settings)["structuralIndex"] = false;
+  (*settings)["parseThreads"] = 1;
   //! [CharReaderBuilderDefaults]
 }
 
@@ -1994,6 +2342,138 @@ bool parseFromStream(CharReader::Factory const& fact, IStream& sin, Value* root,
   return reader->parse(begin, end, root, errs);
 }
 
+Document::Document(size_t blockSize) : arena_(blockSize) {
+  root_.bits_.arena_ = arena_.id();
+}
+
+bool Document::parse(char const* beginDoc, char const* endDoc, String* errs) {
+  return parse(CharReaderBuilder(), beginDoc, endDoc, errs);
+}
+
+bool Document::parse(CharReader::Factory const& factory, char const* beginDoc,
+                     char const* endDoc, String* errs) {
+  CharReaderPtr const reader(factory.newCharReader());
+  clear();
+  ArenaScope scope(&arena_);
+  return reader->parse(beginDoc, endDoc, &root_, errs);
+}
+
+void Document::clear() {
+  {
+    ArenaScope scope(&arena_);
+    root_ = Value();
+  }
+  arena_.reset();
+}
+
+PushReader::PushReader() : PushReader(CharReaderBuilder()) {}
+
+PushReader::PushReader(CharReader::Factory const& factory)
+    : reader_(factory.newCharReader()) {}
+
+PushReader::~PushReader() = default;
+
+bool PushReader::feed(char const* begin, char const* end) {
+  if (failed_)
+    return false;
+  // Drop what was handed out before growing the buffer.
+  if (consumed_ != 0) {
+    buffer_.erase(0, consumed_);
+    for (auto& message : messages_) {
+      message.first -= consumed_;
+      message.second -= consumed_;
+    }
+    scanned_ -= consumed_;
+    messageStart_ -= consumed_;
+    consumed_ = 0;
+  }
+  buffer_.append(begin, end);
+  scan();
+  return !failed_;
+}
+
+void PushReader::scan() {
+  char const* const data = buffer_.data();
+  char const* const end = data + buffer_.size();
+  char const* current = data + scanned_;
+  while (current != end) {
+    if (escaped_) {
+      escaped_ = false;
+      ++current;
+    } else if (inString_) {
+      current = findQuoteOrBackslash(current, end, '"');
+      if (current == end)
+        break;
+      escaped_ = *current == '\\';
+      inString_ = *current++ != '"';
+    } else if (depth_ == 0) {
+      const char c = *current++;
+      if (c == '{' || c == '[') {
+        messageStart_ = static_cast<size_t>(current - 1 - data);
+        depth_ = 1;
+      } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+        failed_ = true;
+        break;
+      } else if (messages_.empty()) {
+        // Whitespace between messages need not be kept.
+        consumed_ = static_cast<size_t>(current - data);
+      }
+    } else {
+      switch (*current++) {
+      case '"':
+        inString_ = true;
+        break;
+      case '{':
+      case '[':
+        ++depth_;
+        break;
+      case '}':
+      case ']':
+        if (--depth_ == 0)
+          messages_.emplace_back(messageStart_,
+                                 static_cast<size_t>(current - data));
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  scanned_ = static_cast<size_t>(current - data);
+}
+
+bool PushReader::take(char const*& begin, char const*& end, String* errs) {
+  if (messages_.empty()) {
+    if (errs)
+      *errs = "No complete message available.\n";
+    return false;
+  }
+  begin = buffer_.data() + messages_.front().first;
+  end = buffer_.data() + messages_.front().second;
+  consumed_ = messages_.front().second;
+  messages_.pop_front();
+  return true;
+}
+
+bool PushReader::next(Value* root, String* errs) {
+  char const* begin;
+  char const* end;
+  return take(begin, end, errs) && reader_->parse(begin, end, root, errs);
+}
+
+bool PushReader::nextEvents(SaxHandler& handler, String* errs) {
+  char const* begin;
+  char const* end;
+  return take(begin, end, errs) &&
+         reader_->parseEvents(begin, end, handler, errs);
+}
+
+void PushReader::reset() {
+  buffer_.clear();
+  messages_.clear();
+  consumed_ = scanned_ = messageStart_ = depth_ = 0;
+  inString_ = escaped_ = failed_ = false;
+}
+
 IStream& operator>>(IStream& sin, Value& root) {
   CharReaderBuilder b;
   String errs;
@@ -0,0 +1,172 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/allocator.h>
+#include <json/reclaim.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Json {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosecondsSince(Clock::time_point start) {
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      Clock::now() - start)
+                      .count());
+}
+
+// The number of values in the tree, counted no further than limit.
+size_t countNodes(Value const& value, size_t limit) {
+  size_t count = 1;
+  // The elements of a typed array are not looked up, see Value.
+  if (visitTypedElements(value, [&count](auto begin, auto end) {
+        count += size_t(end - begin);
+      }))
+    return count;
+  if (!value.isArray() && !value.isObject())
+    return count;
+  for (auto it = value.begin(); it != value.end() && count < limit; ++it)
+    count += countNodes(*it, limit - count);
+  return count;
+}
+
+/// Makes the arena with the given id current for the lifetime of the scope.
+class CurrentArena {
+public:
+  explicit CurrentArena(unsigned arenaId)
+      : previous_(Arena::makeCurrent(arenaId)) {}
+  ~CurrentArena() { Arena::makeCurrent(previous_); }
+  CurrentArena(CurrentArena const&) = delete;
+  CurrentArena& operator=(CurrentArena const&) = delete;
+
+private:
+  unsigned previous_;
+};
+
+} // namespace
+
+// The queue and the thread emptying it. Everything but the settings is
+// guarded by mutex.
+struct Reclaimer::State {
+  std::atomic<size_t> nodeThreshold;
+  std::atomic<size_t> queueLimit;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  std::deque<Value> trees;
+  bool busy{false};
+  bool stopping{false};
+  Stats stats;
+  std::thread thread;
+
+  void run();
+};
+
+void Reclaimer::State::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [this] { return !trees.empty() || stopping; });
+    if (trees.empty())
+      return;
+    Clock::time_point start;
+    {
+      Value tree(std::move(trees.front()));
+      trees.pop_front();
+      busy = true;
+      lock.unlock();
+      start = Clock::now();
+    }
+    const uint64_t took = nanosecondsSince(start);
+    lock.lock();
+    busy = false;
+    ++stats.reclaimed;
+    stats.reclaimNanoseconds += took;
+    if (trees.empty())
+      idle.notify_all();
+  }
+}
+
+Reclaimer::Reclaimer(size_t nodeThreshold, size_t queueLimit)
+    : state_(new State()) {
+  state_->nodeThreshold = nodeThreshold;
+  state_->queueLimit = queueLimit;
+}
+
+Reclaimer::~Reclaimer() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopping = true;
+  }
+  state_->wake.notify_one();
+  if (state_->thread.joinable())
+    state_->thread.join();
+}
+
+Reclaimer& Reclaimer::instance() {
+  static Reclaimer& reclaimer = *new Reclaimer();
+  return reclaimer;
+}
+
+void Reclaimer::reclaim(Value&& value) {
+  const Clock::time_point start = Clock::now();
+  // Taken out within the memory of value, so that nothing is copied.
+  CurrentArena scope(value.bits_.arena_);
+  Value tree(std::move(value));
+  // Values in an arena do not free their children, and the arena must not be
+  // used by another thread.
+  const size_t threshold = state_->nodeThreshold;
+  const bool large =
+      tree.bits_.arena_ == 0 && countNodes(tree, threshold) >= threshold;
+  if (large) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->trees.size() < state_->queueLimit) {
+      state_->trees.push_back(std::move(tree));
+      if (!state_->thread.joinable())
+        state_->thread = std::thread(&State::run, state_.get());
+      state_->stats.handOffNanoseconds += nanosecondsSince(start);
+      state_->wake.notify_one();
+      return;
+    }
+    ++state_->stats.overflowed;
+  }
+  tree = Value();
+  const uint64_t took = nanosecondsSince(start);
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  ++state_->stats.destroyedInline;
+  state_->stats.inlineNanoseconds += took;
+}
+
+void Reclaimer::flush() {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->idle.wait(lock,
+                    [this] { return state_->trees.empty() && !state_->busy; });
+}
+
+void Reclaimer::setNodeThreshold(size_t nodeThreshold) {
+  state_->nodeThreshold = nodeThreshold;
+}
+
+void Reclaimer::setQueueLimit(size_t queueLimit) {
+  state_->queueLimit = queueLimit;
+}
+
+Reclaimer::Stats Reclaimer::stats() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  Stats stats = state_->stats;
+  stats.pending = state_->trees.size() + (state_->busy ? 1 : 0);
+  return stats;
+}
+
+} // namespace Json
@@ -0,0 +1,920 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "json_tool.h"
+#include <json/value.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// A reader in the manner of simdjson. The first pass classifies the
+// document 64 bytes at a time into bit masks, works out from them which
+// quotes are escaped and which bytes lie within strings, and records the
+// position of every bracket, brace, colon and comma outside strings, of
+// every opening quote and of the first byte of every other value. The
+// second pass walks those positions to build the tree, so it never looks at
+// whitespace or string contents except to decode them.
+
+namespace Json {
+
+namespace {
+
+// Spreading a top-level array over threads only pays for itself beyond this
+// many positions per thread.
+const size_t minPositionsPerThread = 32 * 1024;
+
+// Bit i of each mask stands for byte i of a 64-byte block.
+struct Block {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t op;
+  uint64_t space;
+};
+
+#if defined(JSONCPP_SIMD_SSE2)
+void classify(char const* in, Block& block) {
+  const __m128i quotes = _mm_set1_epi8('"');
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  // '[' and ']' differ from '{' and '}' only in bit 5.
+  const __m128i caseBit = _mm_set1_epi8(0x20);
+  const __m128i openBraces = _mm_set1_epi8('{');
+  const __m128i closeBraces = _mm_set1_epi8('}');
+  const __m128i colons = _mm_set1_epi8(':');
+  const __m128i commas = _mm_set1_epi8(',');
+  const __m128i spaces = _mm_set1_epi8(' ');
+  const __m128i tabs = _mm_set1_epi8('\t');
+  const __m128i newlines = _mm_set1_epi8('\n');
+  const __m128i returns = _mm_set1_epi8('\r');
+  block = Block();
+  for (unsigned shift = 0; shift != 64; shift += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + shift));
+    const __m128i folded = _mm_or_si128(chunk, caseBit);
+    const __m128i op = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(folded, openBraces),
+                     _mm_cmpeq_epi8(folded, closeBraces)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, colons),
+                     _mm_cmpeq_epi8(chunk, commas)));
+    const __m128i space = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, spaces),
+                     _mm_cmpeq_epi8(chunk, tabs)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, newlines),
+                     _mm_cmpeq_epi8(chunk, returns)));
+    auto bits = [shift](__m128i hits) {
+      return uint64_t(uint32_t(_mm_movemask_epi8(hits)) & 0xFFFF) << shift;
+    };
+    block.quote |= bits(_mm_cmpeq_epi8(chunk, quotes));
+    block.backslash |= bits(_mm_cmpeq_epi8(chunk, backslashes));
+    block.op |= bits(op);
+    block.space |= bits(space);
+  }
+}
+#elif defined(JSONCPP_SIMD_NEON)
+// The top bit of the bytes of the four comparisons, as one 64-bit mask.
+uint64_t toMask(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d) {
+  const uint8x16_t weights = {1, 2, 4, 8, 16, 32, 64, 128,
+                              1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t low = vpaddq_u8(vandq_u8(a, weights), vandq_u8(b, weights));
+  const uint8x16_t high =
+      vpaddq_u8(vandq_u8(c, weights), vandq_u8(d, weights));
+  low = vpaddq_u8(low, high);
+  low = vpaddq_u8(low, low);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(low), 0);
+}
+
+void classify(char const* in, Block& block) {
+  const uint8x16_t quotes = vdupq_n_u8('"');
+  const uint8x16_t backslashes = vdupq_n_u8('\\');
+  const uint8x16_t caseBit = vdupq_n_u8(0x20);
+  const uint8x16_t openBraces = vdupq_n_u8('{');
+  const uint8x16_t closeBraces = vdupq_n_u8('}');
+  const uint8x16_t colons = vdupq_n_u8(':');
+  const uint8x16_t commas = vdupq_n_u8(',');
+  const uint8x16_t spaces = vdupq_n_u8(' ');
+  const uint8x16_t tabs = vdupq_n_u8('\t');
+  const uint8x16_t newlines = vdupq_n_u8('\n');
+  const uint8x16_t returns = vdupq_n_u8('\r');
+  uint8x16_t quote[4];
+  uint8x16_t backslash[4];
+  uint8x16_t op[4];
+  uint8x16_t space[4];
+  for (int i = 0; i < 4; ++i) {
+    const uint8x16_t chunk =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(in + 16 * i));
+    const uint8x16_t folded = vorrq_u8(chunk, caseBit);
+    quote[i] = vceqq_u8(chunk, quotes);
+    backslash[i] = vceqq_u8(chunk, backslashes);
+    op[i] = vorrq_u8(
+        vorrq_u8(vceqq_u8(folded, openBraces), vceqq_u8(folded, closeBraces)),
+        vorrq_u8(vceqq_u8(chunk, colons), vceqq_u8(chunk, commas)));
+    space[i] = vorrq_u8(
+        vorrq_u8(vceqq_u8(chunk, spaces), vceqq_u8(chunk, tabs)),
+        vorrq_u8(vceqq_u8(chunk, newlines), vceqq_u8(chunk, returns)));
+  }
+  block.quote = toMask(quote[0], quote[1], quote[2], quote[3]);
+  block.backslash =
+      toMask(backslash[0], backslash[1], backslash[2], backslash[3]);
+  block.op = toMask(op[0], op[1], op[2], op[3]);
+  block.space = toMask(space[0], space[1], space[2], space[3]);
+}
+#else
+void classify(char const* in, Block& block) {
+  block = Block();
+  for (unsigned i = 0; i != 64; ++i) {
+    const uint64_t bit = uint64_t(1) << i;
+    switch (in[i]) {
+    case '"':
+      block.quote |= bit;
+      break;
+    case '\\':
+      block.backslash |= bit;
+      break;
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+      block.op |= bit;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      block.space |= bit;
+      break;
+    default:
+      break;
+    }
+  }
+}
+#endif
+
+unsigned int countTrailingZeros64(uint64_t mask) {
+  const auto low = static_cast<uint32_t>(mask);
+  return low ? countTrailingZeros(low)
+             : 32 + countTrailingZeros(static_cast<uint32_t>(mask >> 32));
+}
+
+// Bit i is set if an odd number of the bits 0 to i of mask are.
+uint64_t prefixXor(uint64_t mask) {
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+  return mask;
+}
+
+// The bytes that follow an unescaped backslash. \p carry is bit 0 when the
+// last byte of the previous block was such a backslash, and is updated for
+// the next block. Runs of backslashes are rare enough to walk one by one.
+uint64_t escapedBytes(uint64_t backslash, uint64_t& carry) {
+  uint64_t escaped = carry;
+  carry = 0;
+  backslash &= ~escaped;
+  while (backslash) {
+    const unsigned int at = countTrailingZeros64(backslash);
+    if (at == 63) {
+      carry = 1;
+      break;
+    }
+    escaped |= uint64_t(2) << at;
+    backslash &= ~((uint64_t(4) << at) - 1);
+  }
+  return escaped;
+}
+
+// The first pass; false if a string is left open at the end.
+bool indexStructurals(char const* begin, char const* end,
+                      std::vector<uint32_t>& positions) {
+  const size_t length = size_t(end - begin);
+  positions.reserve(length / 8 + 16);
+  uint64_t escapeCarry = 0;
+  uint64_t inStringCarry = 0;
+  uint64_t scalarCarry = 0;
+  char padded[64];
+  for (size_t base = 0; base < length; base += 64) {
+    char const* in = begin + base;
+    if (length - base < 64) {
+      memset(padded, ' ', sizeof(padded));
+      memcpy(padded, in, length - base);
+      in = padded;
+    }
+    Block block;
+    classify(in, block);
+    const uint64_t quotes =
+        block.quote & ~escapedBytes(block.backslash, escapeCarry);
+    // Set from an opening quote up to, but not including, its closing one.
+    const uint64_t inString = prefixXor(quotes) ^ inStringCarry;
+    inStringCarry = uint64_t(int64_t(inString) >> 63);
+    const uint64_t scalar = ~(block.op | block.space | quotes | inString);
+    const uint64_t scalarStarts = scalar & ~(scalar << 1 | scalarCarry);
+    scalarCarry = scalar >> 63;
+    uint64_t structurals =
+        (block.op & ~inString) | (quotes & inString) | scalarStarts;
+    while (structurals) {
+      positions.push_back(
+          static_cast<uint32_t>(base + countTrailingZeros64(structurals)));
+      structurals &= structurals - 1;
+    }
+  }
+  return inStringCarry == 0;
+}
+
+bool isDelimiter(char c) {
+  switch (c) {
+  case ' ':
+  case '\t':
+  case '\n':
+  case '\r':
+  case ',':
+  case ':':
+  case '[':
+  case ']':
+  case '{':
+  case '}':
+  case '"':
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// The end of the RFC 8259 number that starts at current, which a delimiter
+// has to follow, or nullptr. \p integerEnd is where its integer part ends.
+char const* scanNumber(char const* current, char const* end,
+                       char const*& integerEnd) {
+  if (*current == '-')
+    ++current;
+  if (current == end || !isDigit(*current))
+    return nullptr;
+  if (*current == '0')
+    ++current;
+  else
+    while (current != end && isDigit(*current))
+      ++current;
+  integerEnd = current;
+  if (current != end && *current == '.') {
+    if (++current == end || !isDigit(*current))
+      return nullptr;
+    while (current != end && isDigit(*current))
+      ++current;
+  }
+  if (current != end && (*current == 'e' || *current == 'E')) {
+    if (++current != end && (*current == '+' || *current == '-'))
+      ++current;
+    if (current == end || !isDigit(*current))
+      return nullptr;
+    while (current != end && isDigit(*current))
+      ++current;
+  }
+  if (current != end && !isDelimiter(*current))
+    return nullptr;
+  return current;
+}
+
+// As OurReader::decodeDouble(), which reads the few numbers parseDouble()
+// leaves undecided with a stream.
+bool decodeDouble(char const* begin, char const* end, double& value) {
+  if (parseDouble(begin, end, value))
+    return true;
+  value = 0;
+  IStringStream is(String(begin, end));
+  if (!(is >> value)) {
+    if (value == std::numeric_limits<double>::max())
+      value = std::numeric_limits<double>::infinity();
+    else if (value == std::numeric_limits<double>::lowest())
+      value = -std::numeric_limits<double>::infinity();
+    else if (!std::isinf(value))
+      return false;
+  }
+  return true;
+}
+
+// Four hex digits, which the closing quote still has to follow.
+bool decodeUnicodeEscape(char const*& current, char const* end,
+                         unsigned int& unicode) {
+  if (end - current < 5)
+    return false;
+  unicode = 0;
+  for (int index = 0; index < 4; ++index) {
+    const char c = *current++;
+    unicode *= 16;
+    if (c >= '0' && c <= '9')
+      unicode += unsigned(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      unicode += unsigned(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      unicode += unsigned(c - 'A' + 10);
+    else
+      return false;
+  }
+  return true;
+}
+
+// Decodes the string that starts at current, just after its opening quote,
+// as OurReader::decodeString() does, and returns the position after its
+// closing quote, or nullptr.
+char const* decodeString(char const* current, char const* end,
+                         String& decoded) {
+  while (current != end) {
+    char const* const plain = findQuoteOrBackslash(current, end, '"');
+    decoded.append(current, plain);
+    if ((current = plain) == end)
+      return nullptr;
+    if (*current++ == '"')
+      return current;
+    if (current == end)
+      return nullptr;
+    switch (*current++) {
+    case '"':
+      decoded += '"';
+      break;
+    case '/':
+      decoded += '/';
+      break;
+    case '\\':
+      decoded += '\\';
+      break;
+    case 'b':
+      decoded += '\b';
+      break;
+    case 'f':
+      decoded += '\f';
+      break;
+    case 'n':
+      decoded += '\n';
+      break;
+    case 'r':
+      decoded += '\r';
+      break;
+    case 't':
+      decoded += '\t';
+      break;
+    case 'u': {
+      unsigned int unicode;
+      if (!decodeUnicodeEscape(current, end, unicode))
+        return nullptr;
+      if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+        // The second half is not checked to be a low surrogate, the same
+        // as in OurReader.
+        unsigned int surrogatePair;
+        if (end - current < 7 || current[0] != '\\' || current[1] != 'u')
+          return nullptr;
+        current += 2;
+        if (!decodeUnicodeEscape(current, end, surrogatePair))
+          return nullptr;
+        unicode =
+            0x10000 + ((unicode & 0x3FF) << 10) + (surrogatePair & 0x3FF);
+      }
+      decoded += codePointToUTF8(unicode);
+    } break;
+    default:
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+// The second pass. Any failure only means that OurReader has to read the
+// document, so no reasons are kept.
+class StructuralParser {
+public:
+  StructuralParser(char const* begin, char const* end,
+                   std::vector<uint32_t> const& positions,
+                   StructuralFeatures const& features)
+      : begin_(begin), end_(end), positions_(positions.data()),
+        count_(positions.size()), features_(features) {}
+
+  bool parse(Value& root) {
+    if (!readValue(root, 1))
+      return false;
+    // Whatever follows the root is ignored, unless it is an error or, as a
+    // comment, belongs to the root.
+    if ((features_.failIfExtra || features_.collectComments) &&
+        next_ != count_)
+      return false;
+    return !features_.strictRoot || root.isArray() || root.isObject();
+  }
+
+  // Reads the value at positions[position] alone.
+  bool readAt(size_t position, Value& value) {
+    next_ = position;
+    return readValue(value, 1);
+  }
+
+private:
+  bool nextIs(char c) {
+    if (next_ == count_ || begin_[positions_[next_]] != c)
+      return false;
+    ++next_;
+    return true;
+  }
+
+  // Nothing but a delimiter may follow a number or literal.
+  bool endsAtom(char const* current) const {
+    return current == end_ || isDelimiter(*current);
+  }
+
+  bool readValue(Value& value, size_t depth) {
+    if (depth > features_.stackLimit || next_ == count_)
+      return false;
+    const size_t start = positions_[next_++];
+    char const* const current = begin_ + start;
+    switch (*current) {
+    case '{':
+      return readObject(value, start, depth);
+    case '[':
+      if (depth == 1 && features_.threads > 1)
+        return readArrayInParallel(value, start);
+      return readArray(value, start, depth);
+    case '"':
+      return readString(value, start);
+    case 't':
+      return readLiteral(value, start, "true", Value(true));
+    case 'f':
+      return readLiteral(value, start, "false", Value(false));
+    case 'n':
+      return readLiteral(value, start, "null", Value());
+    default:
+      return readNumber(value, start);
+    }
+  }
+
+  bool readLiteral(Value& value, size_t start, char const* literal,
+                   Value decoded) {
+    const size_t length = strlen(literal);
+    char const* const current = begin_ + start;
+    if (size_t(end_ - current) < length ||
+        memcmp(current, literal, length) != 0 ||
+        !endsAtom(current + length))
+      return false;
+    value.swapPayload(decoded);
+    value.setOffsetStart(ptrdiff_t(start));
+    value.setOffsetLimit(ptrdiff_t(start + length));
+    return true;
+  }
+
+  bool readNumber(Value& value, size_t start) {
+    char const* const token = begin_ + start;
+    char const* integerEnd;
+    char const* const current = scanNumber(token, end_, integerEnd);
+    if (!current)
+      return false;
+
+    // Decoded as OurReader::decodeNumber() does.
+    Value decoded;
+    if (current != integerEnd || !decodeInteger(token, current, decoded)) {
+      double number;
+      if (!decodeDouble(token, current, number))
+        return false;
+      decoded = number;
+    }
+    value.swapPayload(decoded);
+    value.setOffsetStart(ptrdiff_t(start));
+    value.setOffsetLimit(current - begin_);
+    return true;
+  }
+
+  // False if the integer does not fit, it is then read as a double.
+  static bool decodeInteger(char const* current, char const* end,
+                            Value& decoded) {
+    const bool isNegative = *current == '-';
+    if (isNegative)
+      ++current;
+    static constexpr Value::LargestUInt positiveThreshold =
+        Value::maxLargestUInt / 10;
+    static constexpr Value::UInt positiveLastDigit =
+        Value::maxLargestUInt % 10;
+    static constexpr auto negativeThreshold =
+        Value::LargestUInt(-(Value::minLargestInt / 10));
+    static constexpr auto negativeLastDigit =
+        Value::UInt(-(Value::minLargestInt % 10));
+    const Value::LargestUInt threshold =
+        isNegative ? negativeThreshold : positiveThreshold;
+    const Value::UInt maxLastDigit =
+        isNegative ? negativeLastDigit : positiveLastDigit;
+
+    Value::LargestUInt value = 0;
+    while (current < end) {
+      const auto digit = static_cast<Value::UInt>(*current++ - '0');
+      if (value >= threshold &&
+          (value > threshold || current != end || digit > maxLastDigit))
+        return false;
+      value = value * 10 + digit;
+    }
+    if (isNegative) {
+      const auto lastDigit = static_cast<Value::UInt>(value % 10);
+      decoded = -Value::LargestInt(value / 10) * 10 - lastDigit;
+    } else if (value <= Value::LargestUInt(Value::maxLargestInt)) {
+      decoded = Value::LargestInt(value);
+    } else {
+      decoded = value;
+    }
+    return true;
+  }
+
+  // The range of a string, decoded into scratch only if it has escapes.
+  char const* readStringBytes(size_t start, char const*& begin,
+                              char const*& end, String& scratch) const {
+    char const* const first = begin_ + start + 1;
+    char const* const plain = findQuoteOrBackslash(first, end_, '"');
+    if (plain != end_ && *plain == '"') {
+      begin = first;
+      end = plain;
+      return plain + 1;
+    }
+    scratch.clear();
+    char const* const limit = decodeString(first, end_, scratch);
+    begin = scratch.data();
+    end = begin + scratch.size();
+    return limit;
+  }
+
+  // The first pass must agree on where the string ended.
+  bool followedByIndex(char const* limit) const {
+    return next_ == count_ || begin_ + positions_[next_] >= limit;
+  }
+
+  bool readString(Value& value, size_t start) {
+    char const* begin;
+    char const* end;
+    char const* const limit = readStringBytes(start, begin, end, scratch_);
+    if (!limit || !followedByIndex(limit))
+      return false;
+    Value decoded(begin, end);
+    value.swapPayload(decoded);
+    value.setOffsetStart(ptrdiff_t(start));
+    value.setOffsetLimit(limit - begin_);
+    return true;
+  }
+
+  bool readObject(Value& value, size_t start, size_t depth) {
+    Value init(objectValue);
+    value.swapPayload(init);
+    value.setOffsetStart(ptrdiff_t(start));
+    if (!nextIs('}')) {
+      do {
+        if (next_ == count_ || begin_[positions_[next_]] != '"')
+          return false;
+        char const* name;
+        char const* nameEnd;
+        char const* const limit =
+            readStringBytes(positions_[next_++], name, nameEnd, scratch_);
+        if (!limit || !followedByIndex(limit) || !nextIs(':'))
+          return false;
+        // OurReader throws for these.
+        if (nameEnd - name >= ptrdiff_t(1) << 30)
+          return false;
+        const ArrayIndex size = value.size();
+        Value* member = value.demand(name, nameEnd);
+        // Otherwise a duplicate replaces the member, as in OurReader.
+        if (features_.rejectDupKeys && value.size() == size)
+          return false;
+        if (!readValue(*member, depth + 1))
+          return false;
+      } while (nextIs(','));
+      if (!nextIs('}'))
+        return false;
+    }
+    value.setOffsetLimit(ptrdiff_t(positions_[next_ - 1]) + 1);
+    return true;
+  }
+
+  bool readArray(Value& value, size_t start, size_t depth) {
+    Value init(arrayValue);
+    value.swapPayload(init);
+    value.setOffsetStart(ptrdiff_t(start));
+    if (!nextIs(']')) {
+      do {
+        if (!readValue(value.append(Value()), depth + 1))
+          return false;
+      } while (nextIs(','));
+      if (!nextIs(']'))
+        return false;
+    }
+    value.setOffsetLimit(ptrdiff_t(positions_[next_ - 1]) + 1);
+    return true;
+  }
+
+  // Reads the elements of [first, last) into elements, each of which has to
+  // end where the next one starts.
+  bool readElements(std::vector<size_t> const& starts, size_t first,
+                    size_t last, size_t close, Value* elements) {
+    for (size_t index = first; index != last; ++index) {
+      next_ = starts[index];
+      if (!readValue(elements[index], 2))
+        return false;
+      const size_t expected =
+          index + 1 == starts.size() ? close : starts[index + 1] - 1;
+      if (next_ != expected)
+        return false;
+    }
+    return true;
+  }
+
+  // The top-level array, split into runs of elements of about the same
+  // number of positions that threads read in parallel. Every thread takes
+  // memory from the heap, so this only happens outside an Arena.
+  bool readArrayInParallel(Value& value, size_t start) {
+    const size_t open = next_;
+    // Find the elements by counting brackets: the index holds no position
+    // within strings.
+    std::vector<size_t> starts;
+    size_t close = open;
+    size_t depth = 0;
+    for (; close != count_; ++close) {
+      const char c = begin_[positions_[close]];
+      if (c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ']' || c == '}') {
+        if (depth-- == 0)
+          break;
+      } else if (c == ',' && depth == 0) {
+        starts.push_back(close + 1);
+      }
+    }
+    const size_t threads =
+        std::min<size_t>({size_t(features_.threads), starts.size() + 1,
+                          (close - open) / minPositionsPerThread});
+    if (close == count_ || threads < 2 || Arena::current() != 0) {
+      next_ = open;
+      return readArray(value, start, 1);
+    }
+    starts.insert(starts.begin(), open);
+
+    Value init(arrayValue);
+    value.swapPayload(init);
+    value.setOffsetStart(ptrdiff_t(start));
+    value.resize(ArrayIndex(starts.size()));
+    Value* const elements = &value[0];
+
+    // Run t starts at the first element at or beyond the t-th part of the
+    // positions.
+    std::vector<size_t> runs(threads + 1, starts.size());
+    for (size_t t = 0; t != threads; ++t) {
+      const size_t target = open + (close - open) * t / threads;
+      runs[t] = size_t(std::lower_bound(starts.begin(), starts.end(), target) -
+                       starts.begin());
+    }
+    std::vector<std::thread> workers;
+    std::vector<char> succeeded(threads, 0);
+    std::vector<std::exception_ptr> failures(threads);
+    auto work = [&](size_t t) {
+      try {
+        StructuralParser parser(*this);
+        succeeded[t] = parser.readElements(starts, runs[t], runs[t + 1],
+                                           close, elements);
+      } catch (...) {
+        failures[t] = std::current_exception();
+      }
+    };
+    for (size_t t = 1; t != threads; ++t)
+      workers.emplace_back(work, t);
+    work(0);
+    for (auto& worker : workers)
+      worker.join();
+    for (auto& failure : failures)
+      if (failure)
+        std::rethrow_exception(failure);
+    if (std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end())
+      return false;
+    next_ = close + 1;
+    value.setOffsetLimit(ptrdiff_t(positions_[close]) + 1);
+    return true;
+  }
+
+  char const* begin_;
+  char const* end_;
+  uint32_t const* positions_;
+  size_t count_;
+  size_t next_{0};
+  StructuralFeatures const& features_;
+  String scratch_;
+};
+
+// Checks a document the way StructuralParser reads it, without building
+// anything, and numbers its arrays and objects on the way.
+class StructuralChecker {
+public:
+  StructuralChecker(char const* begin, char const* end, size_t stackLimit,
+                    StructuralIndex& index)
+      : begin_(begin), end_(end), positions_(index.positions.data()),
+        count_(index.positions.size()), stackLimit_(stackLimit),
+        containers_(index.containers) {}
+
+  bool check() {
+    if (!checkValue(1))
+      return false;
+    return next_ == count_ ||
+           fail(next_, "Extra non-whitespace after JSON value.");
+  }
+
+  size_t errorOffset_{0};
+  char const* error_{nullptr};
+
+private:
+  // Fails at the position with the given index, or at the end.
+  bool fail(size_t at, char const* message) {
+    errorOffset_ = at < count_ ? positions_[at] : size_t(end_ - begin_);
+    error_ = message;
+    return false;
+  }
+
+  bool nextIs(char c) {
+    if (next_ == count_ || begin_[positions_[next_]] != c)
+      return false;
+    ++next_;
+    return true;
+  }
+
+  bool checkValue(size_t depth) {
+    if (depth > stackLimit_)
+      return fail(next_, "Exceeded stackLimit in readValue().");
+    if (next_ == count_)
+      return fail(next_, "Syntax error: value, object or array expected.");
+    const size_t start = positions_[next_++];
+    char const* const current = begin_ + start;
+    char const* integerEnd;
+    switch (*current) {
+    case '{':
+      return checkObject(depth);
+    case '[':
+      return checkArray(depth);
+    case '"':
+      return checkString(start) != nullptr;
+    case 't':
+      return checkLiteral(current, "true");
+    case 'f':
+      return checkLiteral(current, "false");
+    case 'n':
+      return checkLiteral(current, "null");
+    default:
+      return scanNumber(current, end_, integerEnd) ||
+             fail(next_ - 1,
+                  "Syntax error: value, object or array expected.");
+    }
+  }
+
+  bool checkLiteral(char const* current, char const* literal) {
+    const size_t length = strlen(literal);
+    if (size_t(end_ - current) >= length &&
+        memcmp(current, literal, length) == 0 &&
+        (current + length == end_ || isDelimiter(current[length])))
+      return true;
+    return fail(next_ - 1, "Syntax error: value, object or array expected.");
+  }
+
+  // The position after the closing quote of the string at start.
+  char const* checkString(size_t start) {
+    char const* const first = begin_ + start + 1;
+    char const* limit = findQuoteOrBackslash(first, end_, '"');
+    if (limit != end_ && *limit == '"') {
+      ++limit;
+    } else {
+      scratch_.clear();
+      limit = decodeString(first, end_, scratch_);
+      if (!limit) {
+        fail(next_ - 1, "Bad escape sequence in string");
+        return nullptr;
+      }
+    }
+    // The first pass must agree on where the string ended.
+    if (next_ != count_ && begin_ + positions_[next_] < limit) {
+      fail(next_ - 1, "Bad escape sequence in string");
+      return nullptr;
+    }
+    return limit;
+  }
+
+  bool checkObject(size_t depth) {
+    const size_t number = containers_.size();
+    containers_.push_back(StructuralIndex::Container());
+    if (!nextIs('}')) {
+      do {
+        if (next_ == count_ || begin_[positions_[next_]] != '"')
+          return fail(next_, "Missing '}' or object member name");
+        const size_t start = positions_[next_++];
+        char const* const limit = checkString(start);
+        if (!limit)
+          return false;
+        // OurReader throws for these.
+        if (limit - (begin_ + start) - 2 >= ptrdiff_t(1) << 30) {
+          scratch_.clear();
+          decodeString(begin_ + start + 1, end_, scratch_);
+          if (scratch_.size() >= size_t(1) << 30)
+            return fail(next_ - 1, "keylength >= 2^30");
+        }
+        if (!nextIs(':'))
+          return fail(next_, "Missing ':' after object member name");
+        if (!checkValue(depth + 1))
+          return false;
+      } while (nextIs(','));
+      if (!nextIs('}'))
+        return fail(next_, "Missing ',' or '}' in object declaration");
+    }
+    close(number);
+    return true;
+  }
+
+  bool checkArray(size_t depth) {
+    const size_t number = containers_.size();
+    containers_.push_back(StructuralIndex::Container());
+    if (!nextIs(']')) {
+      do {
+        if (!checkValue(depth + 1))
+          return false;
+      } while (nextIs(','));
+      if (!nextIs(']'))
+        return fail(next_, "Missing ',' or ']' in array declaration");
+    }
+    close(number);
+    return true;
+  }
+
+  void close(size_t number) {
+    containers_[number].close = static_cast<uint32_t>(next_ - 1);
+    containers_[number].next = static_cast<uint32_t>(containers_.size());
+  }
+
+  char const* begin_;
+  char const* end_;
+  uint32_t const* positions_;
+  size_t count_;
+  size_t next_{0};
+  size_t stackLimit_;
+  std::vector<StructuralIndex::Container>& containers_;
+  String scratch_;
+};
+
+} // namespace
+
+bool parseStructural(char const* begin, char const* end,
+                     StructuralFeatures const& features, Value& root) {
+  if (features.skipBom && end - begin >= 3 &&
+      memcmp(begin, "\xEF\xBB\xBF", 3) == 0)
+    begin += 3;
+  // Positions are kept in 32 bits.
+  if (size_t(end - begin) > 0xFFFFFFFFu)
+    return false;
+  std::vector<uint32_t> positions;
+  if (!indexStructurals(begin, end, positions))
+    return false;
+  Value parsed;
+  StructuralParser parser(begin, end, positions, features);
+  if (!parser.parse(parsed))
+    return false;
+  root.swapPayload(parsed);
+  root.setOffsetStart(parsed.getOffsetStart());
+  root.setOffsetLimit(parsed.getOffsetLimit());
+  return true;
+}
+
+bool indexStructural(char const* begin, char const* end, size_t stackLimit,
+                     StructuralIndex& index, size_t& errorOffset,
+                     char const*& error) {
+  index.positions.clear();
+  index.containers.clear();
+  errorOffset = 0;
+  if (size_t(end - begin) > 0xFFFFFFFFu) {
+    error = "The document is larger than 4 GiB.";
+    return false;
+  }
+  if (!indexStructurals(begin, end, index.positions)) {
+    errorOffset = size_t(end - begin);
+    error = "Missing '\"' at the end of a string.";
+    return false;
+  }
+  StructuralChecker checker(begin, end, stackLimit, index);
+  if (!checker.check()) {
+    errorOffset = checker.errorOffset_;
+    error = checker.error_;
+    return false;
+  }
+  return true;
+}
+
+bool readStructural(char const* begin, char const* end,
+                    StructuralIndex const& index, size_t position,
+                    Value& value) {
+  // The checks were done by indexStructural().
+  static const StructuralFeatures features{size_t(-1), 1,     false, false,
+                                           false,      false, false};
+  StructuralParser parser(begin, end, index.positions, features);
+  return parser.readAt(position, value);
+}
+
+} // namespace Json
@@ -8,6 +8,8 @@
 
 #if !defined(JSON_IS_AMALGAMATION)
 #include <json/config.h>
+#include <json/forwards.h>
+#include <json/value.h>
 #endif
 
 // Also support old flag NO_LOCALE_SUPPORT
@@ -19,6 +21,23 @@
 #include <clocale>
 #endif
 
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSONCPP_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define JSONCPP_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 /* This header provides common string manipulation support, such as UTF-8,
  * portable conversion from/to string...
  *
@@ -133,6 +152,232 @@ Iter fixZerosInTheEnd(Iter begin, Iter end, unsigned int precision) {
   return end;
 }
 
+/** Writes the shortest decimal text that reads back as the finite \p value,
+ * laid out like printf's "%.17g" but without its trailing noise digits.
+ * \p buffer needs room for 24 characters, the end of the output is
+ * returned. Implemented in json_double.cpp.
+ */
+char* writeShortestDouble(double value, char* buffer);
+
+/** Parses [begin, end) as a JSON number into the nearest double, which
+ * overflows to infinity and underflows to zero. Returns false if the text
+ * is not plain number syntax or is too ambiguous to decide quickly; the
+ * caller then falls back to a stream.
+ */
+bool parseDouble(char const* begin, char const* end, double& value);
+
+/// The reader settings that parseStructural() has to follow.
+struct StructuralFeatures {
+  size_t stackLimit;
+  unsigned threads;
+  bool skipBom;
+  bool strictRoot;
+  bool failIfExtra;
+  bool rejectDupKeys;
+  /// Whether OurReader would keep comments, which may follow the root.
+  bool collectComments;
+};
+
+/** Parses [begin, end) into \p root in two passes: the first indexes the
+ * structural characters with SIMD, the second builds the tree from that
+ * index, spreading the elements of a big top-level array over up to
+ * features.threads threads. Only plain RFC 8259 JSON is taken, and read
+ * exactly as OurReader would, offsets included. Returns false, leaving
+ * \p root alone, for anything else (comments, errors, duplicate keys that
+ * are to be rejected, a too deep tree...); the caller then reads the
+ * document with OurReader, which reports the error or accepts whatever its
+ * other settings allow. Implemented in json_structural.cpp.
+ */
+bool parseStructural(char const* begin, char const* end,
+                     StructuralFeatures const& features, Value& root);
+
+/// The first pass of parseStructural() over a whole document, which
+/// LazyDocument keeps to find values without reading what lies between them.
+struct StructuralIndex {
+  /// Offsets of the structural characters.
+  std::vector<uint32_t> positions;
+  struct Container {
+    /// Index in positions of the closing bracket or brace.
+    uint32_t close;
+    /// Number of the first array or object after this one's end.
+    uint32_t next;
+  };
+  /// Every array and object, numbered in the order they open.
+  std::vector<Container> containers;
+};
+
+/** Indexes [begin, end), which has to hold a single value of plain RFC 8259
+ * JSON, nested at most \p stackLimit deep, such that parseStructural() could
+ * read it. Nothing is decoded but the strings that have escapes. On failure
+ * returns false, with the offset and the reason in \p errorOffset and
+ * \p error. Implemented in json_structural.cpp.
+ */
+bool indexStructural(char const* begin, char const* end, size_t stackLimit,
+                     StructuralIndex& index, size_t& errorOffset,
+                     char const*& error);
+
+/** Reads the value at index.positions[position] of a document that
+ * indexStructural() took, as parseStructural() would with duplicate keys
+ * allowed, offsets counted from \p begin. Implemented in
+ * json_structural.cpp.
+ */
+bool readStructural(char const* begin, char const* end,
+                    StructuralIndex const& index, size_t position,
+                    Value& value);
+
+/// Index of the lowest set bit, \p mask must not be zero.
+static inline unsigned int countTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+
+/** Returns the first position in [begin, end) that holds \p quote or a
+ * backslash, or end if there is none.
+ *
+ * Everything before that position can be copied verbatim by a string
+ * decoder. SSE2 or NEON look at 16 bytes per step, elsewhere 8 bytes are
+ * checked at once with the usual "has zero byte" word trick.
+ */
+static inline char const* findQuoteOrBackslash(char const* begin,
+                                               char const* end, char quote) {
+#if defined(JSONCPP_SIMD_SSE2)
+  const __m128i quotes = _mm_set1_epi8(quote);
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, backslashes)));
+    if (mask)
+      return begin + countTrailingZeros(static_cast<uint32_t>(mask));
+  }
+#elif defined(JSONCPP_SIMD_NEON)
+  const uint8x16_t quotes = vdupq_n_u8(static_cast<uint8_t>(quote));
+  const uint8x16_t backslashes = vdupq_n_u8('\\');
+  for (; end - begin >= 16; begin += 16) {
+    const uint8x16_t chunk =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+    const uint8x16_t hits =
+        vorrq_u8(vceqq_u8(chunk, quotes), vceqq_u8(chunk, backslashes));
+    if (vmaxvq_u8(hits))
+      break;
+  }
+#else
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  const uint64_t quotes = ones * static_cast<unsigned char>(quote);
+  const uint64_t backslashes = ones * static_cast<unsigned char>('\\');
+  for (; end - begin >= 8; begin += 8) {
+    uint64_t word;
+    std::memcpy(&word, begin, sizeof(word));
+    const uint64_t q = word ^ quotes;
+    const uint64_t b = word ^ backslashes;
+    if (((q - ones) & ~q & highs) | ((b - ones) & ~b & highs))
+      break;
+  }
+#endif
+  while (begin != end && *begin != quote && *begin != '\\')
+    ++begin;
+  return begin;
+}
+
+/** Returns the first position in [begin, end) that a string writer cannot
+ * copy verbatim: a quote, a backslash, a control char or, unless \p emitUTF8,
+ * any byte outside ASCII. Returns end if there is none.
+ */
+static inline char const* findCharToEscape(char const* begin, char const* end,
+                                           bool emitUTF8) {
+#if defined(JSONCPP_SIMD_SSE2)
+  // Flipping the top bit turns the signed compare into an unsigned one, so
+  // bytes from 0x80 only count as "below 0x20" when they must be escaped.
+  const __m128i bias = _mm_set1_epi8(static_cast<char>(emitUTF8 ? 0x80 : 0));
+  const __m128i limit = _mm_xor_si128(_mm_set1_epi8(0x20), bias);
+  const __m128i quotes = _mm_set1_epi8('"');
+  const __m128i backslashes = _mm_set1_epi8('\\');
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i hits = _mm_or_si128(
+        _mm_cmplt_epi8(_mm_xor_si128(chunk, bias), limit),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes),
+                     _mm_cmpeq_epi8(chunk, backslashes)));
+    const int mask = _mm_movemask_epi8(hits);
+    if (mask)
+      return begin + countTrailingZeros(static_cast<uint32_t>(mask));
+  }
+#elif defined(JSONCPP_SIMD_NEON)
+  const uint8x16_t controls = vdupq_n_u8(0x20);
+  const uint8x16_t nonAscii = vdupq_n_u8(emitUTF8 ? 0 : 0x80);
+  const uint8x16_t quotes = vdupq_n_u8('"');
+  const uint8x16_t backslashes = vdupq_n_u8('\\');
+  for (; end - begin >= 16; begin += 16) {
+    const uint8x16_t chunk =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+    const uint8x16_t hits = vorrq_u8(
+        vorrq_u8(vcltq_u8(chunk, controls), vandq_u8(chunk, nonAscii)),
+        vorrq_u8(vceqq_u8(chunk, quotes), vceqq_u8(chunk, backslashes)));
+    if (vmaxvq_u8(hits))
+      break;
+  }
+#else
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  const uint64_t nonAscii = emitUTF8 ? 0 : highs;
+  const uint64_t quotes = ones * static_cast<unsigned char>('"');
+  const uint64_t backslashes = ones * static_cast<unsigned char>('\\');
+  for (; end - begin >= 8; begin += 8) {
+    uint64_t word;
+    std::memcpy(&word, begin, sizeof(word));
+    const uint64_t q = word ^ quotes;
+    const uint64_t b = word ^ backslashes;
+    if (((word - ones * 0x20) & ~word & highs) | (word & nonAscii) |
+        ((q - ones) & ~q & highs) | ((b - ones) & ~b & highs))
+      break;
+  }
+#endif
+  for (; begin != end; ++begin) {
+    const unsigned char c = static_cast<unsigned char>(*begin);
+    if (c == '"' || c == '\\' || c < 0x20 || (c > 0x7F && !emitUTF8))
+      break;
+  }
+  return begin;
+}
+
+/** Calls visit(begin, end) with the elements of an array made from doubles,
+ * Int64s or bools (see Value(const double*, const double*)), so a writer can
+ * loop over them without making a Value of each. Returns false, without
+ * calling visit, for any other value.
+ */
+template <typename Visitor>
+bool visitTypedElements(Value const& value, Visitor&& visit) {
+  double const* doubles;
+  double const* doublesEnd;
+  if (value.getDoubles(&doubles, &doublesEnd)) {
+    visit(doubles, doublesEnd);
+    return true;
+  }
+#if defined(JSON_HAS_INT64)
+  Int64 const* ints;
+  Int64 const* intsEnd;
+  if (value.getInt64s(&ints, &intsEnd)) {
+    visit(ints, intsEnd);
+    return true;
+  }
+#endif // if defined(JSON_HAS_INT64)
+  bool const* bools;
+  bool const* boolsEnd;
+  if (value.getBools(&bools, &boolsEnd)) {
+    visit(bools, boolsEnd);
+    return true;
+  }
+  return false;
+}
+
 } // namespace Json
 
 #endif // LIB_JSONCPP_JSON_TOOL_H_INCLUDED
@@ -9,12 +9,17 @@
 #include <json/writer.h>
 #endif // if !defined(JSON_IS_AMALGAMATION)
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <mutex>
+#include <new>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 // Provide implementation equivalent of std::snprintf for older _MSC compilers
@@ -57,6 +62,11 @@ static std::unique_ptr<T> cloneUnique(const std::unique_ptr<T>& p) {
   return r;
 }
 
+#if JSON_USE_LEAN_VALUE
+static_assert(sizeof(Value) <= 16,
+              "a lean Value is a payload plus its type and flags");
+#endif
+
 // This is a walkaround to avoid the static initialization of Value::null.
 // kNull must be word-aligned to avoid crashing on ARM.  We use an alignment of
 // 8 (instead of 4) as a bit of future-proofing.
@@ -110,15 +120,19 @@ static inline bool InRange(double d, T min, U max) {
  *              length is "unknown".
  * @param length Length of the value. if equals to unknown, then it will be
  *               computed using strlen(value).
+ * @param arenaId Arena to take the memory from, 0 for malloc.
  * @return Pointer on the duplicate instance of string.
  */
-static inline char* duplicateStringValue(const char* value, size_t length) {
+static inline char* duplicateStringValue(const char* value, size_t length,
+                                         unsigned arenaId = 0) {
   // Avoid an integer overflow in the call to malloc below by limiting length
   // to a sane value.
   if (length >= static_cast<size_t>(Value::maxInt))
     length = Value::maxInt - 1;
 
-  auto newString = static_cast<char*>(malloc(length + 1));
+  auto newString =
+      static_cast<char*>(arenaId ? Arena::allocateIn(arenaId, length + 1)
+                                 : malloc(length + 1));
   if (newString == nullptr) {
     throwRuntimeError("in Json::Value::duplicateStringValue(): "
                       "Failed to allocate string value buffer");
@@ -131,7 +145,8 @@ static inline char* duplicateStringValue(const char* value, size_t length) {
 /* Record the length as a prefix.
  */
 static inline char* duplicateAndPrefixStringValue(const char* value,
-                                                  unsigned int length) {
+                                                  unsigned int length,
+                                                  unsigned arenaId) {
   // Avoid an integer overflow in the call to malloc below by limiting length
   // to a sane value.
   JSON_ASSERT_MESSAGE(length <= static_cast<unsigned>(Value::maxInt) -
@@ -139,7 +154,9 @@ static inline char* duplicateAndPrefixStringValue(const char* value,
                       "in Json::Value::duplicateAndPrefixStringValue(): "
                       "length too big for prefixing");
   size_t actualLength = sizeof(length) + length + 1;
-  auto newString = static_cast<char*>(malloc(actualLength));
+  auto newString =
+      static_cast<char*>(arenaId ? Arena::allocateIn(arenaId, actualLength)
+                                 : malloc(actualLength));
   if (newString == nullptr) {
     throwRuntimeError("in Json::Value::duplicateAndPrefixStringValue(): "
                       "Failed to allocate string value buffer");
@@ -183,6 +200,828 @@ static inline void releasePrefixedStringValue(char* value) { free(value); }
 static inline void releaseStringValue(char* value, unsigned) { free(value); }
 #endif // JSONCPP_USING_SECURE_MEMORY
 
+static inline int compareKeys(char const* a, unsigned aLength, char const* b,
+                              unsigned bLength) {
+  int comp = memcmp(a, b, std::min<unsigned>(aLength, bLength));
+  if (comp != 0)
+    return comp;
+  return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+static inline uint64_t hashKey(char const* key, unsigned length) {
+  uint64_t hash = 0x9E3779B97F4A7C15ULL ^ length;
+  for (; length >= 8; key += 8, length -= 8) {
+    uint64_t word;
+    memcpy(&word, key, 8);
+    hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 32;
+  }
+  uint64_t word = 0;
+  memcpy(&word, key, length);
+  hash = (hash ^ word) * 0xC4CEB9FE1A85EC53ULL;
+  return hash ^ (hash >> 29);
+}
+
+// Object keys of up to kMaxInternedKeyLength bytes are stored once per
+// process, the first kMaxInternedKeys distinct ones at least.
+static const unsigned kMaxInternedKeyLength = 32;
+static const size_t kMaxInternedKeys = 64 * 1024;
+
+namespace {
+// Open addressing sets of the interned keys, split in shards with a lock of
+// their own so threads building trees at the same time rarely wait. The
+// keys are copied into blocks that are never freed, zero-terminated and
+// preceded by their length.
+class KeyTable {
+public:
+  char const* intern(char const* key, unsigned length) {
+    const uint64_t hash = hashKey(key, length);
+    Shard& shard = shards_[hash >> (64 - kShardBits)];
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    size_t mask = shard.slots_.size() - 1;
+    size_t slot = size_t(hash) & mask;
+    for (; shard.slots_[slot]; slot = (slot + 1) & mask) {
+      char const* interned = shard.slots_[slot];
+      unsigned internedLength;
+      memcpy(&internedLength, interned - sizeof(unsigned), sizeof(unsigned));
+      if (internedLength == length && memcmp(interned, key, length) == 0)
+        return interned;
+    }
+    if (shard.count_ == kMaxInternedKeys >> kShardBits)
+      return nullptr;
+    char* interned = shard.store(key, length);
+    shard.slots_[slot] = interned;
+    if (++shard.count_ * 2 > shard.slots_.size())
+      shard.grow();
+    return interned;
+  }
+
+private:
+  static const unsigned kShardBits = 4;
+  static const size_t kBlockSize = 16 * 1024;
+
+  struct Shard {
+    Shard() : slots_(256, nullptr) {}
+
+    char* store(char const* key, unsigned length) {
+      const size_t size = (sizeof(unsigned) + length + 1 + 7) & ~size_t(7);
+      if (size > left_) {
+        free_ = static_cast<char*>(malloc(kBlockSize));
+        if (free_ == nullptr)
+          throwRuntimeError("in Json::Value::CZString: Failed to allocate "
+                            "an interned key");
+        left_ = kBlockSize;
+      }
+      memcpy(free_, &length, sizeof(unsigned));
+      char* interned = free_ + sizeof(unsigned);
+      memcpy(interned, key, length);
+      interned[length] = 0;
+      free_ += size;
+      left_ -= size;
+      return interned;
+    }
+
+    void grow() {
+      std::vector<char const*> slots(slots_.size() * 2, nullptr);
+      const size_t mask = slots.size() - 1;
+      for (char const* interned : slots_) {
+        if (!interned)
+          continue;
+        unsigned length;
+        memcpy(&length, interned - sizeof(unsigned), sizeof(unsigned));
+        size_t slot = size_t(hashKey(interned, length)) & mask;
+        while (slots[slot])
+          slot = (slot + 1) & mask;
+        slots[slot] = interned;
+      }
+      slots_.swap(slots);
+    }
+
+    std::mutex mutex_;
+    std::vector<char const*> slots_;
+    size_t count_{0};
+    char* free_{nullptr};
+    size_t left_{0};
+  };
+
+  Shard shards_[1 << kShardBits];
+};
+} // namespace
+
+/** Returns the copy of key shared by all objects in the process, or nullptr
+ * if key is too long or too many keys were interned already. The copy lives
+ * until the process ends, so a key can refer to it like to a StaticString.
+ */
+static char const* internKey(char const* key, unsigned length) {
+  if (length > kMaxInternedKeyLength)
+    return nullptr;
+  // Never destroyed, keys may still be copied by static destructors.
+  static KeyTable& table = *new KeyTable;
+  return table.intern(key, length);
+}
+
+// The finalizer of splitmix64.
+static inline uint64_t mixHash(uint64_t hash) {
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+  return hash ^ (hash >> 31);
+}
+
+static inline unsigned highestBit(uint32_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse(&index, value);
+  return static_cast<unsigned>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+  return 31U - static_cast<unsigned>(__builtin_clz(value));
+#else
+  unsigned index = 0;
+  while (value >>= 1)
+    ++index;
+  return index;
+#endif
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Arena
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+static constexpr unsigned kArenaIds = 1U << 12; // width of Value::bits_.arena_
+static std::atomic<Arena*> arenasById[kArenaIds];
+static thread_local unsigned currentArenaId = 0;
+
+static constexpr size_t kArenaAlignment = alignof(std::max_align_t);
+
+static inline size_t alignedArenaSize(size_t size) {
+  return (size + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+}
+
+Arena::Arena(size_t blockSize)
+    : blockSize_(std::max<size_t>(blockSize, 1024)) {
+  for (unsigned id = 1; id < kArenaIds; ++id) {
+    Arena* expected = nullptr;
+    if (arenasById[id].load(std::memory_order_relaxed) == nullptr &&
+        arenasById[id].compare_exchange_strong(expected, this)) {
+      id_ = id;
+      break;
+    }
+  }
+}
+
+Arena::~Arena() {
+  reset();
+  if (id_)
+    arenasById[id_].store(nullptr);
+}
+
+Arena::Block* Arena::newBlock(size_t size) {
+  auto block = static_cast<Block*>(
+      ::operator new(alignedArenaSize(sizeof(Block)) + size));
+  reserved_ += size;
+  return block;
+}
+
+void* Arena::allocate(size_t size) {
+  size = alignedArenaSize(size == 0 ? 1 : size);
+  used_ += size;
+  if (size > size_t(end_ - cursor_)) {
+    if (size > blockSize_ / 4) {
+      // Big requests get a block of their own, behind the current one, so
+      // the remainder of that one is not wasted.
+      Block* block = newBlock(size);
+      if (blocks_) {
+        block->next_ = blocks_->next_;
+        blocks_->next_ = block;
+      } else {
+        block->next_ = nullptr;
+        blocks_ = block;
+      }
+      return reinterpret_cast<char*>(block) + alignedArenaSize(sizeof(Block));
+    }
+    Block* block = newBlock(blockSize_);
+    block->next_ = blocks_;
+    blocks_ = block;
+    cursor_ = reinterpret_cast<char*>(block) + alignedArenaSize(sizeof(Block));
+    end_ = cursor_ + blockSize_;
+  }
+  void* memory = cursor_;
+  cursor_ += size;
+  return memory;
+}
+
+void Arena::reset() {
+  while (blocks_) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+  cursor_ = end_ = nullptr;
+  used_ = reserved_ = 0;
+}
+
+unsigned Arena::current() { return currentArenaId; }
+
+unsigned Arena::makeCurrent(unsigned arenaId) {
+  unsigned previous = currentArenaId;
+  currentArenaId = arenaId;
+  return previous;
+}
+
+void* Arena::allocateIn(unsigned arenaId, size_t size) {
+  if (arenaId == 0)
+    return ::operator new(size);
+  return arenasById[arenaId].load(std::memory_order_relaxed)->allocate(size);
+}
+
+void Arena::deallocateIn(unsigned arenaId, void* memory) {
+  if (arenaId == 0)
+    ::operator delete(memory);
+}
+
+namespace {
+/// Makes an arena current by id for the lifetime of the scope.
+class ArenaIdScope {
+public:
+  explicit ArenaIdScope(unsigned arenaId)
+      : previous_(Arena::makeCurrent(arenaId)) {}
+  ~ArenaIdScope() { Arena::makeCurrent(previous_); }
+  ArenaIdScope(ArenaIdScope const&) = delete;
+  ArenaIdScope& operator=(ArenaIdScope const&) = delete;
+
+private:
+  unsigned previous_;
+};
+} // namespace
+
+template <typename T, typename... Args>
+static T* createIn(unsigned arenaId, Args&&... args) {
+  if (arenaId == 0)
+    return new T(std::forward<Args>(args)...);
+  return new (Arena::allocateIn(arenaId, sizeof(T)))
+      T(std::forward<Args>(args)...);
+}
+
+/// Counterpart of createIn(), objects in an arena are not destroyed.
+template <typename T> static void destroyIn(unsigned arenaId, T* object) {
+  if (arenaId == 0)
+    delete object;
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Value::ArrayValues
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+/** Reference count, cached hash and NaN flag of an array or object payload.
+ *
+ * Copies of a Value share its payload until one of them is modified, which
+ * first takes a copy of its own (see Value::detach()). The count is atomic,
+ * so values sharing a payload can be used from different threads. The hash
+ * and whether the payload holds a NaN are only cached while nothing can
+ * modify the payload, see Value::hash() and Value::operator==().
+ */
+class SharedPayload {
+public:
+  SharedPayload() = default;
+  SharedPayload(SharedPayload const&) = delete;
+  SharedPayload& operator=(SharedPayload const&) = delete;
+
+  void ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+  /// Drops a reference, returns false if that was the last one.
+  bool deref() { return refs_.fetch_sub(1, std::memory_order_acq_rel) != 1; }
+  bool isShared() const { return refs_.load(std::memory_order_acquire) != 1; }
+
+  /// The cached hash, 0 if there is none.
+  uint64_t cachedHash() const { return hash_.load(std::memory_order_relaxed); }
+  void cacheHash(uint64_t hash) const {
+    hash_.store(hash, std::memory_order_relaxed);
+  }
+  void forgetHash() {
+    hash_.store(0, std::memory_order_relaxed);
+    nans_.store(unknownNaNs, std::memory_order_relaxed);
+  }
+
+  enum NaNs : unsigned char { unknownNaNs, noNaNs, someNaNs };
+  /// Whether the payload holds a NaN anywhere, if that is known.
+  NaNs cachedNaNs() const { return nans_.load(std::memory_order_relaxed); }
+  void cacheNaNs(NaNs nans) const {
+    nans_.store(nans, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<unsigned> refs_{1};
+  mutable std::atomic<uint64_t> hash_{0};
+  mutable std::atomic<NaNs> nans_{unknownNaNs};
+};
+
+/** Storage of the elements of an arrayValue.
+ *
+ * An array made from a range of doubles, integers or bools keeps them in one
+ * block of that type, typed_, instead of as Values. The Values are made from
+ * it the first time an element is looked up (see box()), which is why they
+ * may be added to a const array. The array stays typed until something is
+ * about to modify it, which first turns it into an ordinary one (untype()).
+ */
+class Value::ArrayValues : public std::vector<Value, ArenaAllocator<Value>>,
+                           public SharedPayload {
+public:
+  enum Kind { generic, doubles, ints, bools };
+
+  explicit ArrayValues(unsigned arenaId)
+      : vector(ArenaAllocator<Value>(arenaId)), arena_(arenaId) {}
+  ArrayValues(ArrayValues const& other, unsigned arenaId);
+  ArrayValues(Kind kind, void const* elements, size_t count,
+              unsigned arenaId);
+  ~ArrayValues() { releaseTyped(); }
+
+  Kind kind() const { return kind_; }
+  template <typename T> T const* typed() const {
+    return static_cast<T const*>(typed_);
+  }
+  /// Number of elements, whether they were made into Values or not.
+  size_t count() const { return kind_ == generic ? size() : typedSize_; }
+  /// Calls visit(begin, end) with the elements of a typed array.
+  template <typename Visitor> void visitTyped(Visitor&& visit) const;
+  /// Makes the Values of a typed array, if that was not done yet. May be
+  /// called by several threads sharing the array.
+  void box() const;
+  /// Makes a typed array an ordinary one.
+  void untype();
+
+private:
+  void setTyped(Kind kind, void const* elements, size_t count);
+  void releaseTyped();
+
+  unsigned arena_;
+  Kind kind_{generic};
+  void* typed_{nullptr};
+  size_t typedSize_{0};
+  mutable std::atomic<bool> boxed_{false};
+};
+
+static size_t typedElementSize(Value::ArrayValues::Kind kind) {
+  switch (kind) {
+  case Value::ArrayValues::doubles:
+    return sizeof(double);
+  case Value::ArrayValues::ints:
+    return sizeof(LargestInt);
+  case Value::ArrayValues::bools:
+    return sizeof(bool);
+  default:
+    return 0;
+  }
+}
+
+Value::ArrayValues::ArrayValues(ArrayValues const& other, unsigned arenaId)
+    : vector(ArenaAllocator<Value>(arenaId)), arena_(arenaId) {
+  // Values made from a typed array are not copied, the copy can make its own.
+  if (other.kind_ == generic)
+    assign(other.begin(), other.end());
+  else
+    setTyped(other.kind_, other.typed_, other.typedSize_);
+}
+
+Value::ArrayValues::ArrayValues(Kind kind, void const* elements, size_t count,
+                                unsigned arenaId)
+    : vector(ArenaAllocator<Value>(arenaId)), arena_(arenaId) {
+  setTyped(kind, elements, count);
+}
+
+template <typename Visitor>
+void Value::ArrayValues::visitTyped(Visitor&& visit) const {
+  switch (kind_) {
+  case doubles:
+    visit(typed<double>(), typed<double>() + typedSize_);
+    break;
+  case ints:
+    visit(typed<LargestInt>(), typed<LargestInt>() + typedSize_);
+    break;
+  case bools:
+    visit(typed<bool>(), typed<bool>() + typedSize_);
+    break;
+  case generic:
+    break;
+  }
+}
+
+void Value::ArrayValues::box() const {
+  if (kind_ == generic || boxed_.load(std::memory_order_acquire))
+    return;
+  // Typed arrays are rarely looked into element by element, so one lock for
+  // all of them will do.
+  static std::mutex& boxing = *new std::mutex;
+  std::lock_guard<std::mutex> lock(boxing);
+  if (boxed_.load(std::memory_order_relaxed))
+    return;
+  auto& values = const_cast<ArrayValues&>(*this);
+  values.reserve(typedSize_);
+  visitTyped([&values](auto begin, auto end) {
+    for (; begin != end; ++begin)
+      values.emplace_back(*begin);
+  });
+  boxed_.store(true, std::memory_order_release);
+}
+
+void Value::ArrayValues::untype() {
+  if (kind_ == generic)
+    return;
+  box();
+  releaseTyped();
+  kind_ = generic;
+  typedSize_ = 0;
+  boxed_.store(false, std::memory_order_relaxed);
+}
+
+void Value::ArrayValues::setTyped(Kind kind, void const* elements,
+                                  size_t count) {
+  kind_ = kind;
+  typedSize_ = count;
+  if (count == 0)
+    return;
+  const size_t bytes = count * typedElementSize(kind);
+  typed_ = Arena::allocateIn(arena_, bytes);
+  memcpy(typed_, elements, bytes);
+}
+
+void Value::ArrayValues::releaseTyped() {
+  if (typed_)
+    Arena::deallocateIn(arena_, typed_);
+  typed_ = nullptr;
+}
+
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class Value::ObjectValues
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+/** Storage of the members of an objectValue.
+ *
+ * Members are constructed in slots that never move, so references to member
+ * values stay valid while other members are added or removed (as they did
+ * with the std::map this replaces). The first kInlineSlots slots are part of
+ * the object itself, after that every chunk doubles the capacity. Erased
+ * slots are reused before new ones are taken.
+ *
+ * Next to the slots the members are kept in key order, which is the order of
+ * iteration. As long as no more than kSmallSlots slots are used, that order
+ * is a list of 4 bit slot numbers packed into smallOrder_ and lookups are a
+ * linear scan comparing lengths first. Larger objects switch to a vector of
+ * slot numbers plus an open addressing hash index on the keys.
+ *
+ * All of this, and the members themselves, live in the Arena arena_ of the
+ * object value (the heap for 0).
+ */
+class Value::ObjectValues : public SharedPayload {
+public:
+  struct Entry {
+    Entry(CZString const& key) : key_(key) {}
+    Entry(CZString const& key, Value const& value) : key_(key), value_(value) {}
+    CZString key_;
+    Value value_;
+  };
+
+  explicit ObjectValues(unsigned arenaId)
+      : arena_(arenaId), chunks_(ArenaAllocator<void*>(arenaId)) {}
+  ObjectValues(ObjectValues const& other, unsigned arenaId);
+  ObjectValues& operator=(ObjectValues const& other) = delete;
+  ~ObjectValues() { release(); }
+
+  ArrayIndex size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /// The member at position in key order.
+  Entry& at(ArrayIndex position) const { return slot(orderAt(position)); }
+
+  Value* find(char const* key, unsigned length) const;
+  /// Returns the member named key, adding a null member if there is none.
+  Value& resolve(CZString const& key);
+  bool erase(char const* key, unsigned length, Value* removed);
+  void clear();
+
+private:
+  static constexpr uint32_t kInlineSlots = 2;
+  static constexpr uint32_t kSmallSlots = 16;
+  static constexpr uint32_t kNoSlot = 0xFFFFFFFF;
+
+  struct LargeIndex {
+    using Order = std::vector<uint32_t, ArenaAllocator<uint32_t>>;
+    LargeIndex(Order order)
+        : order_(std::move(order)), buckets_(order_.get_allocator()) {}
+    Order order_;
+    // (upper half of hash << 32) | (slot + 1), 0 marks an empty bucket.
+    std::vector<uint64_t, ArenaAllocator<uint64_t>> buckets_;
+  };
+
+  // Interned keys are the same pointer, which spares comparing their bytes.
+  static bool sameKey(CZString const& probe, char const* key,
+                      unsigned length) {
+    return probe.length() == length &&
+           (probe.data() == key || memcmp(probe.data(), key, length) == 0);
+  }
+
+  Entry& slot(uint32_t index) const;
+  uint32_t orderAt(ArrayIndex position) const;
+  ArrayIndex lowerBound(char const* key, unsigned length) const;
+  bool findPosition(char const* key, unsigned length,
+                    ArrayIndex* position) const;
+  uint32_t takeSlot();
+  void freeSlot(uint32_t index);
+  void insertOrder(ArrayIndex position, uint32_t index);
+  void eraseOrder(ArrayIndex position);
+  void becomeLarge();
+  size_t findBucket(char const* key, unsigned length) const;
+  void insertBucket(uint32_t index);
+  void eraseBucket(size_t bucket);
+  void growBuckets();
+  void append(CZString const& key, Value const& value);
+  void release();
+
+  unsigned arena_;
+  ArrayIndex size_{0};
+  uint32_t used_{0};
+  uint32_t freeHead_{kNoSlot};
+  uint64_t smallOrder_{0};
+  LargeIndex* large_{nullptr};
+  std::vector<void*, ArenaAllocator<void*>> chunks_;
+  alignas(Entry) unsigned char inline_[kInlineSlots * sizeof(Entry)];
+};
+
+Value::ObjectValues::ObjectValues(ObjectValues const& other, unsigned arenaId)
+    : ObjectValues(arenaId) {
+  for (ArrayIndex position = 0; position < other.size_; ++position) {
+    Entry const& entry = other.at(position);
+    append(entry.key_, entry.value_);
+  }
+}
+
+Value::ObjectValues::Entry& Value::ObjectValues::slot(uint32_t index) const {
+  if (index < kInlineSlots)
+    return reinterpret_cast<Entry*>(const_cast<unsigned char*>(inline_))[index];
+  // Chunk k holds the slots [2^k, 2^(k+1)).
+  unsigned chunk = highestBit(index);
+  return static_cast<Entry*>(chunks_[chunk - 1])[index - (1U << chunk)];
+}
+
+uint32_t Value::ObjectValues::orderAt(ArrayIndex position) const {
+  if (large_)
+    return large_->order_[position];
+  return static_cast<uint32_t>(smallOrder_ >> (4 * position)) & 0xF;
+}
+
+ArrayIndex Value::ObjectValues::lowerBound(char const* key,
+                                           unsigned length) const {
+  ArrayIndex first = 0;
+  ArrayIndex count = size_;
+  while (count > 0) {
+    ArrayIndex half = count / 2;
+    CZString const& probe = at(first + half).key_;
+    if (compareKeys(probe.data(), probe.length(), key, length) < 0) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+bool Value::ObjectValues::findPosition(char const* key, unsigned length,
+                                       ArrayIndex* position) const {
+  if (large_) {
+    *position = lowerBound(key, length);
+    if (*position == size_)
+      return false;
+    return sameKey(at(*position).key_, key, length);
+  }
+  for (ArrayIndex i = 0; i < size_; ++i) {
+    if (sameKey(at(i).key_, key, length)) {
+      *position = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+Value* Value::ObjectValues::find(char const* key, unsigned length) const {
+  if (large_) {
+    size_t bucket = findBucket(key, length);
+    if (bucket == size_t(-1))
+      return nullptr;
+    return &slot(uint32_t(large_->buckets_[bucket]) - 1).value_;
+  }
+  for (ArrayIndex i = 0; i < size_; ++i) {
+    Entry& entry = at(i);
+    if (sameKey(entry.key_, key, length))
+      return &entry.value_;
+  }
+  return nullptr;
+}
+
+Value& Value::ObjectValues::resolve(CZString const& key) {
+  Value* found = find(key.data(), key.length());
+  if (found)
+    return *found;
+
+  uint32_t index = takeSlot();
+  Entry* entry;
+  {
+    ArenaIdScope scope(arena_);
+    entry = new (&slot(index)) Entry(key);
+  }
+  ArrayIndex position = size_;
+  if (size_ > 0) {
+    CZString const& last = at(size_ - 1).key_;
+    if (compareKeys(last.data(), last.length(), key.data(), key.length()) > 0)
+      position = lowerBound(key.data(), key.length());
+  }
+  insertOrder(position, index);
+  if (large_)
+    insertBucket(index);
+  return entry->value_;
+}
+
+void Value::ObjectValues::append(CZString const& key, Value const& value) {
+  uint32_t index = takeSlot();
+  {
+    ArenaIdScope scope(arena_);
+    new (&slot(index)) Entry(key, value);
+  }
+  insertOrder(size_, index);
+  if (large_)
+    insertBucket(index);
+}
+
+bool Value::ObjectValues::erase(char const* key, unsigned length,
+                                Value* removed) {
+  ArrayIndex position;
+  if (!findPosition(key, length, &position))
+    return false;
+  uint32_t index = orderAt(position);
+  Entry& entry = slot(index);
+  if (removed)
+    *removed = std::move(entry.value_);
+  if (large_)
+    eraseBucket(findBucket(key, length));
+  eraseOrder(position);
+  entry.~Entry();
+  freeSlot(index);
+  return true;
+}
+
+uint32_t Value::ObjectValues::takeSlot() {
+  if (freeHead_ != kNoSlot) {
+    uint32_t index = freeHead_;
+    memcpy(&freeHead_, &slot(index), sizeof(freeHead_));
+    return index;
+  }
+  if (used_ == kSmallSlots && !large_)
+    becomeLarge();
+  uint32_t index = used_;
+  if (index >= kInlineSlots && (index & (index - 1)) == 0) {
+    // index is a power of two, so it starts a new chunk of index slots.
+    void* chunk = Arena::allocateIn(arena_, sizeof(Entry) * index);
+    chunks_.push_back(chunk);
+  }
+  ++used_;
+  return index;
+}
+
+void Value::ObjectValues::freeSlot(uint32_t index) {
+  // The free list is threaded through the storage of the erased entries.
+  memcpy(static_cast<void*>(&slot(index)), &freeHead_, sizeof(freeHead_));
+  freeHead_ = index;
+}
+
+void Value::ObjectValues::insertOrder(ArrayIndex position, uint32_t index) {
+  if (large_) {
+    large_->order_.insert(large_->order_.begin() + position, index);
+  } else {
+    unsigned shift = 4 * position;
+    uint64_t low = shift ? smallOrder_ & (~uint64_t(0) >> (64 - shift)) : 0;
+    uint64_t high = shift < 64 ? smallOrder_ >> shift : 0;
+    smallOrder_ = low | (uint64_t(index) << shift);
+    if (shift + 4 < 64)
+      smallOrder_ |= high << (shift + 4);
+  }
+  ++size_;
+}
+
+void Value::ObjectValues::eraseOrder(ArrayIndex position) {
+  if (large_) {
+    large_->order_.erase(large_->order_.begin() + position);
+  } else {
+    unsigned shift = 4 * position;
+    uint64_t low = shift ? smallOrder_ & (~uint64_t(0) >> (64 - shift)) : 0;
+    smallOrder_ = low | ((smallOrder_ >> shift >> 4) << shift);
+  }
+  --size_;
+}
+
+void Value::ObjectValues::becomeLarge() {
+  LargeIndex::Order order{ArenaAllocator<uint32_t>(arena_)};
+  order.reserve(size_ * 2);
+  for (ArrayIndex position = 0; position < size_; ++position)
+    order.push_back(orderAt(position));
+  large_ = createIn<LargeIndex>(arena_, std::move(order));
+  growBuckets();
+}
+
+size_t Value::ObjectValues::findBucket(char const* key,
+                                       unsigned length) const {
+  uint64_t hash = hashKey(key, length);
+  size_t mask = large_->buckets_.size() - 1;
+  for (size_t bucket = size_t(hash) & mask;; bucket = (bucket + 1) & mask) {
+    uint64_t content = large_->buckets_[bucket];
+    if (content == 0)
+      return size_t(-1);
+    if ((content >> 32) == (hash >> 32)) {
+      if (sameKey(slot(uint32_t(content) - 1).key_, key, length))
+        return bucket;
+    }
+  }
+}
+
+void Value::ObjectValues::insertBucket(uint32_t index) {
+  if ((size_ + 1) * 2 > large_->buckets_.size())
+    growBuckets(); // also indexes the new member, which is already in order_
+  else {
+    CZString const& key = slot(index).key_;
+    uint64_t hash = hashKey(key.data(), key.length());
+    size_t mask = large_->buckets_.size() - 1;
+    size_t bucket = size_t(hash) & mask;
+    while (large_->buckets_[bucket] != 0)
+      bucket = (bucket + 1) & mask;
+    large_->buckets_[bucket] = (hash & 0xFFFFFFFF00000000ULL) | (index + 1);
+  }
+}
+
+void Value::ObjectValues::eraseBucket(size_t bucket) {
+  // Backward shift deletion keeps the probe sequences intact without
+  // tombstones.
+  auto& buckets = large_->buckets_;
+  size_t mask = buckets.size() - 1;
+  size_t next = bucket;
+  for (;;) {
+    next = (next + 1) & mask;
+    if (buckets[next] == 0)
+      break;
+    CZString const& key = slot(uint32_t(buckets[next]) - 1).key_;
+    size_t home = size_t(hashKey(key.data(), key.length())) & mask;
+    bool stays = bucket <= next ? (bucket < home && home <= next)
+                                : (bucket < home || home <= next);
+    if (!stays) {
+      buckets[bucket] = buckets[next];
+      bucket = next;
+    }
+  }
+  buckets[bucket] = 0;
+}
+
+void Value::ObjectValues::growBuckets() {
+  size_t capacity = 64;
+  while (capacity < (size_t(size_) + 1) * 4)
+    capacity *= 2;
+  auto& buckets = large_->buckets_;
+  buckets.assign(capacity, 0);
+  size_t mask = capacity - 1;
+  for (uint32_t index : large_->order_) {
+    CZString const& key = slot(index).key_;
+    uint64_t hash = hashKey(key.data(), key.length());
+    size_t bucket = size_t(hash) & mask;
+    while (buckets[bucket] != 0)
+      bucket = (bucket + 1) & mask;
+    buckets[bucket] = (hash & 0xFFFFFFFF00000000ULL) | (index + 1);
+  }
+}
+
+void Value::ObjectValues::release() {
+  for (ArrayIndex position = 0; position < size_; ++position)
+    at(position).~Entry();
+  for (void* chunk : chunks_)
+    Arena::deallocateIn(arena_, chunk);
+  destroyIn(arena_, large_);
+}
+
+void Value::ObjectValues::clear() {
+  release();
+  size_ = 0;
+  used_ = 0;
+  freeHead_ = kNoSlot;
+  smallOrder_ = 0;
+  large_ = nullptr;
+  chunks_.clear();
+}
+
 } // namespace Json
 
 // //////////////////////////////////////////////////////////////////
@@ -231,41 +1070,56 @@ JSONCPP_NORETURN void throwLogicError(String const& msg) {
 // //////////////////////////////////////////////////////////////////
 
 // Notes: policy_ indicates if the string was allocated when
-// a string is stored.
-
-Value::CZString::CZString(ArrayIndex index) : cstr_(nullptr), index_(index) {}
+// a string is stored. Keys are only duplicated by the copy constructor, which
+// keeps the short ones in chars_ (see isInline()) and shares the interned
+// copy of longer ones up to kMaxInternedKeyLength, as if it was static.
 
 Value::CZString::CZString(char const* str, unsigned length,
                           DuplicationPolicy allocate)
     : cstr_(str) {
   // allocate != duplicate
   storage_.policy_ = allocate & 0x3;
+  storage_.interned_ = 0;
   storage_.length_ = length & 0x3FFFFFFF;
 }
 
-Value::CZString::CZString(const CZString& other) {
-  cstr_ = (other.storage_.policy_ != noDuplication && other.cstr_ != nullptr
-               ? duplicateStringValue(other.cstr_, other.storage_.length_)
-               : other.cstr_);
-  storage_.policy_ =
-      static_cast<unsigned>(
-          other.cstr_
-              ? (static_cast<DuplicationPolicy>(other.storage_.policy_) ==
-                         noDuplication
-                     ? noDuplication
-                     : duplicate)
-              : static_cast<DuplicationPolicy>(other.storage_.policy_)) &
-      3U;
-  storage_.length_ = other.storage_.length_;
+Value::CZString::CZString(const CZString& other) : storage_(other.storage_) {
+  if (other.isInline()) {
+    memcpy(chars_, other.chars_, sizeof(chars_));
+    return;
+  }
+  if (other.storage_.policy_ == noDuplication || other.cstr_ == nullptr) {
+    cstr_ = other.cstr_;
+    return;
+  }
+  unsigned length = other.storage_.length_;
+  storage_.policy_ = duplicate;
+  if (length < sizeof(chars_)) {
+    memset(chars_, 0, sizeof(chars_));
+    memcpy(chars_, other.cstr_, length);
+    return;
+  }
+  if ((cstr_ = internKey(other.cstr_, length)) != nullptr) {
+    storage_.policy_ = noDuplication;
+    storage_.interned_ = 1;
+    return;
+  }
+  // Keys are copied into the arena that is current, which is the one of the
+  // object they are added to.
+  unsigned arenaId = Arena::current();
+  cstr_ = duplicateStringValue(other.cstr_, length, arenaId);
+  if (arenaId)
+    storage_.policy_ = arenaOwned;
 }
 
 Value::CZString::CZString(CZString&& other) noexcept
-    : cstr_(other.cstr_), index_(other.index_) {
+    : storage_(other.storage_) {
+  memcpy(chars_, other.chars_, sizeof(chars_));
   other.cstr_ = nullptr;
 }
 
 Value::CZString::~CZString() {
-  if (cstr_ && storage_.policy_ == duplicate) {
+  if (storage_.policy_ == duplicate && !isInline() && cstr_) {
     releaseStringValue(const_cast<char*>(cstr_),
                        storage_.length_ + 1U); // +1 for null terminating
                                                // character for sake of
@@ -276,60 +1130,43 @@ Value::CZString::~CZString() {
 
 void Value::CZString::swap(CZString& other) {
   std::swap(cstr_, other.cstr_);
-  std::swap(index_, other.index_);
+  std::swap(storage_, other.storage_);
 }
 
 Value::CZString& Value::CZString::operator=(const CZString& other) {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
+  memcpy(chars_, other.chars_, sizeof(chars_));
+  storage_ = other.storage_;
   return *this;
 }
 
 Value::CZString& Value::CZString::operator=(CZString&& other) noexcept {
-  cstr_ = other.cstr_;
-  index_ = other.index_;
+  memcpy(chars_, other.chars_, sizeof(chars_));
+  storage_ = other.storage_;
   other.cstr_ = nullptr;
   return *this;
 }
 
 bool Value::CZString::operator<(const CZString& other) const {
-  if (!cstr_)
-    return index_ < other.index_;
-  // return strcmp(cstr_, other.cstr_) < 0;
-  // Assume both are strings.
-  unsigned this_len = this->storage_.length_;
-  unsigned other_len = other.storage_.length_;
-  unsigned min_len = std::min<unsigned>(this_len, other_len);
-  JSON_ASSERT(this->cstr_ && other.cstr_);
-  int comp = memcmp(this->cstr_, other.cstr_, min_len);
-  if (comp < 0)
-    return true;
-  if (comp > 0)
-    return false;
-  return (this_len < other_len);
+  return compareKeys(data(), length(), other.data(), other.length()) < 0;
 }
 
 bool Value::CZString::operator==(const CZString& other) const {
-  if (!cstr_)
-    return index_ == other.index_;
-  // return strcmp(cstr_, other.cstr_) == 0;
-  // Assume both are strings.
-  unsigned this_len = this->storage_.length_;
-  unsigned other_len = other.storage_.length_;
-  if (this_len != other_len)
-    return false;
-  JSON_ASSERT(this->cstr_ && other.cstr_);
-  int comp = memcmp(this->cstr_, other.cstr_, this_len);
-  return comp == 0;
+  return length() == other.length() &&
+         (data() == other.data() ||
+          memcmp(data(), other.data(), length()) == 0);
 }
 
-ArrayIndex Value::CZString::index() const { return index_; }
+bool Value::CZString::isInline() const {
+  return storage_.policy_ == duplicate && storage_.length_ < sizeof(chars_);
+}
 
 // const char* Value::CZString::c_str() const { return cstr_; }
-const char* Value::CZString::data() const { return cstr_; }
+const char* Value::CZString::data() const {
+  return isInline() ? chars_ : cstr_;
+}
 unsigned Value::CZString::length() const { return storage_.length_; }
 bool Value::CZString::isStaticString() const {
-  return storage_.policy_ == noDuplication;
+  return storage_.policy_ == noDuplication && !storage_.interned_;
 }
 
 // //////////////////////////////////////////////////////////////////
@@ -362,8 +1199,10 @@ Value::Value(ValueType type) {
     value_.string_ = const_cast<char*>(static_cast<char const*>(emptyString));
     break;
   case arrayValue:
+    value_.array_ = createIn<ArrayValues>(bits_.arena_, unsigned(bits_.arena_));
+    break;
   case objectValue:
-    value_.map_ = new ObjectValues();
+    value_.map_ = createIn<ObjectValues>(bits_.arena_, unsigned(bits_.arena_));
     break;
   case booleanValue:
     value_.bool_ = false;
@@ -398,24 +1237,44 @@ Value::Value(double value) {
   value_.real_ = value;
 }
 
+Value::Value(const double* begin, const double* end) {
+  initBasic(arrayValue);
+  value_.array_ =
+      createIn<ArrayValues>(bits_.arena_, ArrayValues::doubles, begin,
+                            size_t(end - begin), unsigned(bits_.arena_));
+}
+
+#if defined(JSON_HAS_INT64)
+Value::Value(const Int64* begin, const Int64* end) {
+  initBasic(arrayValue);
+  value_.array_ =
+      createIn<ArrayValues>(bits_.arena_, ArrayValues::ints, begin,
+                            size_t(end - begin), unsigned(bits_.arena_));
+}
+#endif // defined(JSON_HAS_INT64)
+
+Value::Value(const bool* begin, const bool* end) {
+  initBasic(arrayValue);
+  value_.array_ =
+      createIn<ArrayValues>(bits_.arena_, ArrayValues::bools, begin,
+                            size_t(end - begin), unsigned(bits_.arena_));
+}
+
 Value::Value(const char* value) {
-  initBasic(stringValue, true);
+  initBasic(stringValue);
   JSON_ASSERT_MESSAGE(value != nullptr,
                       "Null Value Passed to Value Constructor");
-  value_.string_ = duplicateAndPrefixStringValue(
-      value, static_cast<unsigned>(strlen(value)));
+  initString(value, static_cast<unsigned>(strlen(value)));
 }
 
 Value::Value(const char* begin, const char* end) {
-  initBasic(stringValue, true);
-  value_.string_ =
-      duplicateAndPrefixStringValue(begin, static_cast<unsigned>(end - begin));
+  initBasic(stringValue);
+  initString(begin, static_cast<unsigned>(end - begin));
 }
 
 Value::Value(const String& value) {
-  initBasic(stringValue, true);
-  value_.string_ = duplicateAndPrefixStringValue(
-      value.data(), static_cast<unsigned>(value.length()));
+  initBasic(stringValue);
+  initString(value.data(), static_cast<unsigned>(value.length()));
 }
 
 Value::Value(const StaticString& value) {
@@ -429,6 +1288,7 @@ Value::Value(bool value) {
 }
 
 Value::Value(const Value& other) {
+  bits_.arena_ = Arena::current();
   dupPayload(other);
   dupMeta(other);
 }
@@ -444,7 +1304,18 @@ Value::~Value() {
 }
 
 Value& Value::operator=(const Value& other) {
-  Value(other).swap(*this);
+  // Copy straight into the arena of this value, not the current one.
+  ArenaIdScope scope(bits_.arena_);
+  // Assigning a value to one of its own members, as in v["self"] = v, must
+  // not share the payload that is to hold the copy, or the tree would contain
+  // itself. The copy gets its own levels down to this value instead, which
+  // gives what a deep copy gave: the value as it was before.
+  std::vector<ArrayIndex> path;
+  const bool inside = other.findPath(this, &path);
+  Value copy(other);
+  if (inside)
+    copy.detachPath(path);
+  copy.swap(*this);
   return *this;
 }
 
@@ -454,20 +1325,46 @@ Value& Value::operator=(Value&& other) noexcept {
 }
 
 void Value::swapPayload(Value& other) {
+  if (bits_.arena_ != other.bits_.arena_) {
+    // A value keeps living where it is, so each payload is copied into the
+    // memory of the value that receives it.
+    Value mine;
+    mine.bits_.arena_ = other.bits_.arena_;
+    mine.dupPayload(*this);
+    Value theirs;
+    theirs.bits_.arena_ = bits_.arena_;
+    theirs.dupPayload(other);
+    std::swap(bits_, theirs.bits_);
+    std::swap(value_, theirs.value_);
+    std::swap(other.bits_, mine.bits_);
+    std::swap(other.value_, mine.value_);
+    return;
+  }
   std::swap(bits_, other.bits_);
   std::swap(value_, other.value_);
 }
 
 void Value::copyPayload(const Value& other) {
-  releasePayload();
-  dupPayload(other);
+  ArenaIdScope scope(bits_.arena_);
+  std::vector<ArrayIndex> path;
+  const bool inside = other.findPath(this, &path);
+  Value copy(other);
+  if (inside)
+    copy.detachPath(path);
+  swapPayload(copy);
 }
 
 void Value::swap(Value& other) {
   swapPayload(other);
+#if !JSON_USE_LEAN_VALUE
   std::swap(comments_, other.comments_);
+  if (bits_.arena_ != other.bits_.arena_) {
+    // Values in an arena keep no comments.
+    (bits_.arena_ ? comments_ : other.comments_) = Comments{};
+  }
   std::swap(start_, other.start_);
   std::swap(limit_, other.limit_);
+#endif
 }
 
 void Value::copy(const Value& other) {
@@ -503,17 +1400,15 @@ bool Value::operator<(const Value& other) const {
   case booleanValue:
     return value_.bool_ < other.value_.bool_;
   case stringValue: {
-    if ((value_.string_ == nullptr) || (other.value_.string_ == nullptr)) {
-      return other.value_.string_ != nullptr;
-    }
     unsigned this_len;
     unsigned other_len;
     char const* this_str;
     char const* other_str;
-    decodePrefixedString(this->isAllocated(), this->value_.string_, &this_len,
-                         &this_str);
-    decodePrefixedString(other.isAllocated(), other.value_.string_, &other_len,
-                         &other_str);
+    bool const thisHasString = decodeString(&this_len, &this_str);
+    bool const otherHasString = other.decodeString(&other_len, &other_str);
+    if (!thisHasString || !otherHasString) {
+      return otherHasString;
+    }
     unsigned min_len = std::min<unsigned>(this_len, other_len);
     JSON_ASSERT(this_str && other_str);
     int comp = memcmp(this_str, other_str, min_len);
@@ -523,13 +1418,33 @@ bool Value::operator<(const Value& other) const {
       return false;
     return (this_len < other_len);
   }
-  case arrayValue:
+  case arrayValue: {
+    auto thisSize = value_.array_->count();
+    auto otherSize = other.value_.array_->count();
+    if (thisSize != otherSize)
+      return thisSize < otherSize;
+    value_.array_->box();
+    other.value_.array_->box();
+    return (*value_.array_) < (*other.value_.array_);
+  }
   case objectValue: {
     auto thisSize = value_.map_->size();
     auto otherSize = other.value_.map_->size();
     if (thisSize != otherSize)
       return thisSize < otherSize;
-    return (*value_.map_) < (*other.value_.map_);
+    for (ArrayIndex position = 0; position < thisSize; ++position) {
+      const ObjectValues::Entry& mine = value_.map_->at(position);
+      const ObjectValues::Entry& theirs = other.value_.map_->at(position);
+      if (mine.key_ < theirs.key_)
+        return true;
+      if (theirs.key_ < mine.key_)
+        return false;
+      if (mine.value_ < theirs.value_)
+        return true;
+      if (theirs.value_ < mine.value_)
+        return false;
+    }
+    return false;
   }
   default:
     JSON_ASSERT_UNREACHABLE;
@@ -543,6 +1458,14 @@ bool Value::operator>=(const Value& other) const { return !(*this < other); }
 
 bool Value::operator>(const Value& other) const { return other < *this; }
 
+/// True if both payloads have a cached hash and these differ.
+static inline bool cachedHashesDiffer(SharedPayload const& a,
+                                      SharedPayload const& b) {
+  uint64_t hashA = a.cachedHash();
+  uint64_t hashB = b.cachedHash();
+  return hashA != 0 && hashB != 0 && hashA != hashB;
+}
+
 bool Value::operator==(const Value& other) const {
   if (type() != other.type())
     return false;
@@ -558,17 +1481,15 @@ bool Value::operator==(const Value& other) const {
   case booleanValue:
     return value_.bool_ == other.value_.bool_;
   case stringValue: {
-    if ((value_.string_ == nullptr) || (other.value_.string_ == nullptr)) {
-      return (value_.string_ == other.value_.string_);
-    }
     unsigned this_len;
     unsigned other_len;
     char const* this_str;
     char const* other_str;
-    decodePrefixedString(this->isAllocated(), this->value_.string_, &this_len,
-                         &this_str);
-    decodePrefixedString(other.isAllocated(), other.value_.string_, &other_len,
-                         &other_str);
+    bool const thisHasString = decodeString(&this_len, &this_str);
+    bool const otherHasString = other.decodeString(&other_len, &other_str);
+    if (!thisHasString || !otherHasString) {
+      return thisHasString == otherHasString;
+    }
     if (this_len != other_len)
       return false;
     JSON_ASSERT(this_str && other_str);
@@ -576,9 +1497,43 @@ bool Value::operator==(const Value& other) const {
     return comp == 0;
   }
   case arrayValue:
-  case objectValue:
-    return value_.map_->size() == other.value_.map_->size() &&
-           (*value_.map_) == (*other.value_.map_);
+    // The same contents are equal, unless a NaN makes them unequal.
+    if (value_.array_ == other.value_.array_ && !holdsNaN(false))
+      return true;
+    if (cachedHashesDiffer(*value_.array_, *other.value_.array_))
+      return false;
+    if (value_.array_->count() != other.value_.array_->count())
+      return false;
+    if (value_.array_->kind() != ArrayValues::generic &&
+        value_.array_->kind() == other.value_.array_->kind()) {
+      bool equal = true;
+      ArrayValues const& theirs = *other.value_.array_;
+      value_.array_->visitTyped([&equal, &theirs](auto begin, auto end) {
+        using Element = std::remove_const_t<std::remove_reference_t<
+            decltype(*begin)>>;
+        equal = std::equal(begin, end, theirs.typed<Element>());
+      });
+      return equal;
+    }
+    value_.array_->box();
+    other.value_.array_->box();
+    return (*value_.array_) == (*other.value_.array_);
+  case objectValue: {
+    if (value_.map_ == other.value_.map_ && !holdsNaN(false))
+      return true;
+    if (cachedHashesDiffer(*value_.map_, *other.value_.map_))
+      return false;
+    ArrayIndex thisSize = value_.map_->size();
+    if (thisSize != other.value_.map_->size())
+      return false;
+    for (ArrayIndex position = 0; position < thisSize; ++position) {
+      const ObjectValues::Entry& mine = value_.map_->at(position);
+      const ObjectValues::Entry& theirs = other.value_.map_->at(position);
+      if (!(mine.key_ == theirs.key_) || mine.value_ != theirs.value_)
+        return false;
+    }
+    return true;
+  }
   default:
     JSON_ASSERT_UNREACHABLE;
   }
@@ -587,15 +1542,119 @@ bool Value::operator==(const Value& other) const {
 
 bool Value::operator!=(const Value& other) const { return !(*this == other); }
 
+std::uint64_t Value::hash() const { return structuralHash(false); }
+
+uint64_t Value::structuralHash(bool frozen) const {
+  // Every type has its own seed, so 1, 1u and 1.0 hash apart.
+  const uint64_t seed = (uint64_t(type()) + 1) * 0x9E3779B97F4A7C15ULL;
+  switch (type()) {
+  case nullValue:
+    return mixHash(seed);
+  case intValue:
+  case uintValue:
+    return mixHash(seed ^ value_.uint_);
+  case realValue: {
+    // -0.0 == 0.0, so both hash alike.
+    const double real = value_.real_ == 0.0 ? 0.0 : value_.real_;
+    uint64_t bits;
+    memcpy(&bits, &real, sizeof(bits));
+    return mixHash(seed ^ bits);
+  }
+  case booleanValue:
+    return mixHash(seed ^ uint64_t(value_.bool_));
+  case stringValue: {
+    unsigned length = 0;
+    char const* str = "";
+    decodeString(&length, &str);
+    return mixHash(seed ^ hashKey(str, length));
+  }
+  default:
+    break;
+  }
+
+  SharedPayload const& payload =
+      type() == arrayValue ? static_cast<SharedPayload const&>(*value_.array_)
+                           : *value_.map_;
+  // Contents shared with a copy cannot be modified, nor can anything in them.
+  frozen = frozen || payload.isShared();
+  if (frozen) {
+    uint64_t cached = payload.cachedHash();
+    if (cached != 0)
+      return cached;
+  }
+  uint64_t hash = seed ^ size();
+  if (type() == arrayValue && value_.array_->kind() != ArrayValues::generic) {
+    // As the hash of the same array made of Values.
+    value_.array_->visitTyped([&hash](auto begin, auto end) {
+      for (; begin != end; ++begin)
+        hash = mixHash(hash ^ Value(*begin).hash());
+    });
+  } else if (type() == arrayValue) {
+    for (Value const& element : *value_.array_)
+      hash = mixHash(hash ^ element.structuralHash(frozen));
+  } else {
+    // Members are summed up, so their order does not matter.
+    uint64_t members = 0;
+    for (ArrayIndex position = 0; position < value_.map_->size(); ++position) {
+      const ObjectValues::Entry& entry = value_.map_->at(position);
+      members += mixHash(hashKey(entry.key_.data(), entry.key_.length()) ^
+                         entry.value_.structuralHash(frozen) *
+                             0xC2B2AE3D27D4EB4FULL);
+    }
+    hash = mixHash(hash ^ members);
+  }
+  if (hash == 0)
+    hash = 1; // 0 means no cached hash
+  if (frozen)
+    payload.cacheHash(hash);
+  return hash;
+}
+
+bool Value::holdsNaN(bool frozen) const {
+  switch (type()) {
+  case realValue:
+    return std::isnan(value_.real_);
+  case arrayValue:
+  case objectValue:
+    break;
+  default:
+    return false;
+  }
+
+  SharedPayload const& payload =
+      type() == arrayValue ? static_cast<SharedPayload const&>(*value_.array_)
+                           : *value_.map_;
+  // As in structuralHash().
+  frozen = frozen || payload.isShared();
+  if (frozen && payload.cachedNaNs() != SharedPayload::unknownNaNs)
+    return payload.cachedNaNs() == SharedPayload::someNaNs;
+  bool nans = false;
+  if (type() == arrayValue && value_.array_->kind() == ArrayValues::doubles) {
+    double const* reals = value_.array_->typed<double>();
+    nans = std::any_of(reals, reals + value_.array_->count(),
+                       [](double real) { return std::isnan(real); });
+  } else if (type() == arrayValue &&
+             value_.array_->kind() == ArrayValues::generic) {
+    nans = std::any_of(
+        value_.array_->begin(), value_.array_->end(),
+        [frozen](Value const& element) { return element.holdsNaN(frozen); });
+  } else if (type() == objectValue) {
+    for (ArrayIndex position = 0; position < value_.map_->size() && !nans;
+         ++position)
+      nans = value_.map_->at(position).value_.holdsNaN(frozen);
+  }
+  if (frozen)
+    payload.cacheNaNs(nans ? SharedPayload::someNaNs : SharedPayload::noNaNs);
+  return nans;
+}
+
 const char* Value::asCString() const {
   JSON_ASSERT_MESSAGE(type() == stringValue,
                       "in Json::Value::asCString(): requires stringValue");
-  if (value_.string_ == nullptr)
-    return nullptr;
   unsigned this_len;
   char const* this_str;
-  decodePrefixedString(this->isAllocated(), this->value_.string_, &this_len,
-                       &this_str);
+  if (!decodeString(&this_len, &this_str))
+    return nullptr;
   return this_str;
 }
 
@@ -603,12 +1662,10 @@ const char* Value::asCString() const {
 unsigned Value::getCStringLength() const {
   JSON_ASSERT_MESSAGE(type() == stringValue,
                       "in Json::Value::asCString(): requires stringValue");
-  if (value_.string_ == 0)
-    return 0;
   unsigned this_len;
   char const* this_str;
-  decodePrefixedString(this->isAllocated(), this->value_.string_, &this_len,
-                       &this_str);
+  if (!decodeString(&this_len, &this_str))
+    return 0;
   return this_len;
 }
 #endif
@@ -616,26 +1673,48 @@ unsigned Value::getCStringLength() const {
 bool Value::getString(char const** begin, char const** end) const {
   if (type() != stringValue)
     return false;
-  if (value_.string_ == nullptr)
-    return false;
   unsigned length;
-  decodePrefixedString(this->isAllocated(), this->value_.string_, &length,
-                       begin);
+  if (!decodeString(&length, begin))
+    return false;
   *end = *begin + length;
   return true;
 }
 
+bool Value::getDoubles(double const** begin, double const** end) const {
+  if (type() != arrayValue || value_.array_->kind() != ArrayValues::doubles)
+    return false;
+  *begin = value_.array_->typed<double>();
+  *end = *begin + value_.array_->count();
+  return true;
+}
+
+#if defined(JSON_HAS_INT64)
+bool Value::getInt64s(Int64 const** begin, Int64 const** end) const {
+  if (type() != arrayValue || value_.array_->kind() != ArrayValues::ints)
+    return false;
+  *begin = value_.array_->typed<Int64>();
+  *end = *begin + value_.array_->count();
+  return true;
+}
+#endif // defined(JSON_HAS_INT64)
+
+bool Value::getBools(bool const** begin, bool const** end) const {
+  if (type() != arrayValue || value_.array_->kind() != ArrayValues::bools)
+    return false;
+  *begin = value_.array_->typed<bool>();
+  *end = *begin + value_.array_->count();
+  return true;
+}
+
 String Value::asString() const {
   switch (type()) {
   case nullValue:
     return "";
   case stringValue: {
-    if (value_.string_ == nullptr)
-      return "";
     unsigned this_len;
     char const* this_str;
-    decodePrefixedString(this->isAllocated(), this->value_.string_, &this_len,
-                         &this_str);
+    if (!decodeString(&this_len, &this_str))
+      return "";
     return String(this_str, this_len);
   }
   case booleanValue:
@@ -828,7 +1907,7 @@ bool Value::isConvertibleTo(ValueType other) const {
     return (isNumeric() && asDouble() == 0.0) ||
            (type() == booleanValue && !value_.bool_) ||
            (type() == stringValue && asString().empty()) ||
-           (type() == arrayValue && value_.map_->empty()) ||
+           (type() == arrayValue && value_.array_->count() == 0) ||
            (type() == objectValue && value_.map_->empty()) ||
            type() == nullValue;
   case intValue:
@@ -865,13 +1944,8 @@ ArrayIndex Value::size() const {
   case booleanValue:
   case stringValue:
     return 0;
-  case arrayValue: // size of the array is highest index + 1
-    if (!value_.map_->empty()) {
-      ObjectValues::const_iterator itLast = value_.map_->end();
-      --itLast;
-      return (*itLast).first.index() + 1;
-    }
-    return 0;
+  case arrayValue:
+    return ArrayIndex(value_.array_->count());
   case objectValue:
     return ArrayIndex(value_.map_->size());
   }
@@ -891,10 +1965,24 @@ void Value::clear() {
   JSON_ASSERT_MESSAGE(type() == nullValue || type() == arrayValue ||
                           type() == objectValue,
                       "in Json::Value::clear(): requires complex value");
-  start_ = 0;
-  limit_ = 0;
+  setOffsetStart(0);
+  setOffsetLimit(0);
+  if (type() != nullValue &&
+      (type() == arrayValue ? value_.array_->isShared() ||
+                                  value_.array_->kind() != ArrayValues::generic
+                            : value_.map_->isShared())) {
+    // Leave shared contents to the other owners instead of copying them,
+    // and typed elements unmade.
+    ArenaIdScope scope(bits_.arena_);
+    Value empty(type());
+    swapPayload(empty);
+    return;
+  }
+  detach();
   switch (type()) {
   case arrayValue:
+    value_.array_->clear();
+    break;
   case objectValue:
     value_.map_->clear();
     break;
@@ -908,34 +1996,33 @@ void Value::resize(ArrayIndex newSize) {
                       "in Json::Value::resize(): requires arrayValue");
   if (type() == nullValue)
     *this = Value(arrayValue);
-  ArrayIndex oldSize = size();
-  if (newSize == 0)
+  if (newSize == 0) {
     clear();
-  else if (newSize > oldSize)
-    for (ArrayIndex i = oldSize; i < newSize; ++i)
-      (*this)[i];
-  else {
-    for (ArrayIndex index = newSize; index < oldSize; ++index) {
-      value_.map_->erase(index);
-    }
-    JSON_ASSERT(size() == newSize);
+  } else {
+    detach();
+    value_.array_->resize(newSize);
   }
 }
 
+void Value::reserve(ArrayIndex newCapacity) {
+  JSON_ASSERT_MESSAGE(type() == nullValue || type() == arrayValue,
+                      "in Json::Value::reserve(): requires arrayValue");
+  if (type() == nullValue)
+    *this = Value(arrayValue);
+  detach();
+  value_.array_->reserve(newCapacity);
+}
+
 Value& Value::operator[](ArrayIndex index) {
   JSON_ASSERT_MESSAGE(
       type() == nullValue || type() == arrayValue,
       "in Json::Value::operator[](ArrayIndex): requires arrayValue");
   if (type() == nullValue)
     *this = Value(arrayValue);
-  CZString key(index);
-  auto it = value_.map_->lower_bound(key);
-  if (it != value_.map_->end() && (*it).first == key)
-    return (*it).second;
-
-  ObjectValues::value_type defaultValue(key, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
-  return (*it).second;
+  detach();
+  if (index >= value_.array_->size())
+    value_.array_->resize(size_t(index) + 1);
+  return (*value_.array_)[index];
 }
 
 Value& Value::operator[](int index) {
@@ -949,13 +2036,10 @@ const Value& Value::operator[](ArrayIndex index) const {
   JSON_ASSERT_MESSAGE(
       type() == nullValue || type() == arrayValue,
       "in Json::Value::operator[](ArrayIndex)const: requires arrayValue");
-  if (type() == nullValue)
-    return nullSingleton();
-  CZString key(index);
-  ObjectValues::const_iterator it = value_.map_->find(key);
-  if (it == value_.map_->end())
+  if (type() == nullValue || index >= value_.array_->count())
     return nullSingleton();
-  return (*it).second;
+  value_.array_->box();
+  return (*value_.array_)[index];
 }
 
 const Value& Value::operator[](int index) const {
@@ -968,14 +2052,44 @@ const Value& Value::operator[](int index) const {
 void Value::initBasic(ValueType type, bool allocated) {
   setType(type);
   setIsAllocated(allocated);
+  bits_.inline_ = false;
+  bits_.arena_ = Arena::current();
+#if !JSON_USE_LEAN_VALUE
   comments_ = Comments{};
   start_ = 0;
   limit_ = 0;
+#endif
+}
+
+void Value::initString(char const* str, unsigned length) {
+  if (length < sizeof(value_.chars_)) {
+    value_.uint_ = 0;
+    if (length > 0)
+      memcpy(value_.chars_, str, length);
+    bits_.inline_ = true;
+    bits_.inlineLength_ = length;
+  } else {
+    value_.string_ = duplicateAndPrefixStringValue(str, length, bits_.arena_);
+    setIsAllocated(true);
+  }
+}
+
+bool Value::decodeString(unsigned* length, char const** str) const {
+  if (bits_.inline_) {
+    *length = bits_.inlineLength_;
+    *str = value_.chars_;
+    return true;
+  }
+  if (value_.string_ == nullptr)
+    return false;
+  decodePrefixedString(isAllocated(), value_.string_, length, str);
+  return true;
 }
 
 void Value::dupPayload(const Value& other) {
   setType(other.type());
   setIsAllocated(false);
+  bits_.inline_ = false;
   switch (type()) {
   case nullValue:
   case intValue:
@@ -985,27 +2099,111 @@ void Value::dupPayload(const Value& other) {
     value_ = other.value_;
     break;
   case stringValue:
-    if (other.value_.string_ && other.isAllocated()) {
-      unsigned len;
-      char const* str;
-      decodePrefixedString(other.isAllocated(), other.value_.string_, &len,
-                           &str);
-      value_.string_ = duplicateAndPrefixStringValue(str, len);
-      setIsAllocated(true);
+    if (other.isAllocated()) {
+      unsigned len = 0;
+      char const* str = nullptr;
+      other.decodeString(&len, &str);
+      initString(str, len);
     } else {
-      value_.string_ = other.value_.string_;
+      // Inline and static strings are copied as they are.
+      value_ = other.value_;
+      bits_.inline_ = other.bits_.inline_;
+      bits_.inlineLength_ = other.bits_.inlineLength_;
     }
     break;
   case arrayValue:
+    // Values in the same memory share the payload until one is modified.
+    if (bits_.arena_ == other.bits_.arena_) {
+      value_.array_ = other.value_.array_;
+      value_.array_->ref();
+    } else {
+      value_.array_ = createIn<ArrayValues>(
+          bits_.arena_, *other.value_.array_, unsigned(bits_.arena_));
+    }
+    break;
   case objectValue:
-    value_.map_ = new ObjectValues(*other.value_.map_);
+    if (bits_.arena_ == other.bits_.arena_) {
+      value_.map_ = other.value_.map_;
+      value_.map_->ref();
+    } else {
+      value_.map_ = createIn<ObjectValues>(bits_.arena_, *other.value_.map_,
+                                           unsigned(bits_.arena_));
+    }
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
   }
 }
 
+void Value::detach() {
+  // The copy shares the payloads one level down, so modifying a member
+  // copies only the path to it.
+  switch (type()) {
+  case arrayValue:
+    if (value_.array_->isShared()) {
+      ArenaIdScope scope(bits_.arena_);
+      ArrayValues* shared = value_.array_;
+      value_.array_ = createIn<ArrayValues>(bits_.arena_, *shared,
+                                            unsigned(bits_.arena_));
+      if (!shared->deref())
+        destroyIn(bits_.arena_, shared);
+    }
+    value_.array_->untype();
+    value_.array_->forgetHash();
+    break;
+  case objectValue:
+    if (value_.map_->isShared()) {
+      ArenaIdScope scope(bits_.arena_);
+      ObjectValues* shared = value_.map_;
+      value_.map_ = createIn<ObjectValues>(bits_.arena_, *shared,
+                                           unsigned(bits_.arena_));
+      if (!shared->deref())
+        destroyIn(bits_.arena_, shared);
+    }
+    value_.map_->forgetHash();
+    break;
+  default:
+    break;
+  }
+}
+
+bool Value::findPath(Value const* target,
+                     std::vector<ArrayIndex>* path) const {
+  // A value being modified is reached through unshared payloads only (see
+  // detach()), so shared ones need not be searched. Typed arrays hold no
+  // arrays or objects, and are left unmade.
+  ArrayIndex count = 0;
+  if (type() == arrayValue && !value_.array_->isShared() &&
+      value_.array_->kind() == ArrayValues::generic)
+    count = ArrayIndex(value_.array_->size());
+  else if (type() == objectValue && !value_.map_->isShared())
+    count = value_.map_->size();
+  for (ArrayIndex position = 0; position < count; ++position) {
+    Value const& element = type() == arrayValue
+                               ? (*value_.array_)[position]
+                               : value_.map_->at(position).value_;
+    if (&element == target ||
+        (element.type() >= arrayValue && element.findPath(target, path))) {
+      path->push_back(position);
+      return true;
+    }
+  }
+  return false;
+}
+
+void Value::detachPath(std::vector<ArrayIndex> const& path) {
+  Value* node = this;
+  for (auto position = path.rbegin(); position != path.rend(); ++position) {
+    node->detach();
+    node = node->type() == arrayValue
+               ? &(*node->value_.array_)[*position]
+               : &node->value_.map_->at(*position).value_;
+  }
+}
+
 void Value::releasePayload() {
+  // Memory of an arena is released with the arena, all at once, but shared
+  // payloads are counted there too.
   switch (type()) {
   case nullValue:
   case intValue:
@@ -1014,12 +2212,16 @@ void Value::releasePayload() {
   case booleanValue:
     break;
   case stringValue:
-    if (isAllocated())
+    if (isAllocated() && !bits_.arena_)
       releasePrefixedStringValue(value_.string_);
     break;
   case arrayValue:
+    if (!value_.array_->deref())
+      destroyIn(bits_.arena_, value_.array_);
+    break;
   case objectValue:
-    delete value_.map_;
+    if (!value_.map_->deref())
+      destroyIn(bits_.arena_, value_.map_);
     break;
   default:
     JSON_ASSERT_UNREACHABLE;
@@ -1027,9 +2229,13 @@ void Value::releasePayload() {
 }
 
 void Value::dupMeta(const Value& other) {
-  comments_ = other.comments_;
+#if !JSON_USE_LEAN_VALUE
+  comments_ = bits_.arena_ ? Comments{} : other.comments_;
   start_ = other.start_;
   limit_ = other.limit_;
+#else
+  (void)other;
+#endif
 }
 
 // Access an object value by name, create a null member if it does not exist.
@@ -1041,16 +2247,10 @@ Value& Value::resolveReference(const char* key) {
       "in Json::Value::resolveReference(): requires objectValue");
   if (type() == nullValue)
     *this = Value(objectValue);
+  detach();
   CZString actualKey(key, static_cast<unsigned>(strlen(key)),
                      CZString::noDuplication); // NOTE!
-  auto it = value_.map_->lower_bound(actualKey);
-  if (it != value_.map_->end() && (*it).first == actualKey)
-    return (*it).second;
-
-  ObjectValues::value_type defaultValue(actualKey, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
-  Value& value = (*it).second;
-  return value;
+  return value_.map_->resolve(actualKey);
 }
 
 // @param key is not null-terminated.
@@ -1060,16 +2260,10 @@ Value& Value::resolveReference(char const* key, char const* end) {
       "in Json::Value::resolveReference(key, end): requires objectValue");
   if (type() == nullValue)
     *this = Value(objectValue);
+  detach();
   CZString actualKey(key, static_cast<unsigned>(end - key),
                      CZString::duplicateOnCopy);
-  auto it = value_.map_->lower_bound(actualKey);
-  if (it != value_.map_->end() && (*it).first == actualKey)
-    return (*it).second;
-
-  ObjectValues::value_type defaultValue(actualKey, nullSingleton());
-  it = value_.map_->insert(it, defaultValue);
-  Value& value = (*it).second;
-  return value;
+  return value_.map_->resolve(actualKey);
 }
 
 Value Value::get(ArrayIndex index, const Value& defaultValue) const {
@@ -1085,12 +2279,7 @@ Value const* Value::find(char const* begin, char const* end) const {
                       "objectValue or nullValue");
   if (type() == nullValue)
     return nullptr;
-  CZString actualKey(begin, static_cast<unsigned>(end - begin),
-                     CZString::noDuplication);
-  ObjectValues::const_iterator it = value_.map_->find(actualKey);
-  if (it == value_.map_->end())
-    return nullptr;
-  return &(*it).second;
+  return value_.map_->find(begin, static_cast<unsigned>(end - begin));
 }
 Value* Value::demand(char const* begin, char const* end) {
   JSON_ASSERT_MESSAGE(type() == nullValue || type() == objectValue,
@@ -1123,7 +2312,10 @@ Value& Value::operator[](const StaticString& key) {
   return resolveReference(key.c_str());
 }
 
-Value& Value::append(const Value& value) { return append(Value(value)); }
+Value& Value::append(const Value& value) {
+  ArenaIdScope scope(bits_.arena_);
+  return append(Value(value));
+}
 
 Value& Value::append(Value&& value) {
   JSON_ASSERT_MESSAGE(type() == nullValue || type() == arrayValue,
@@ -1131,24 +2323,26 @@ Value& Value::append(Value&& value) {
   if (type() == nullValue) {
     *this = Value(arrayValue);
   }
-  return this->value_.map_->emplace(size(), std::move(value)).first->second;
+  detach();
+  value_.array_->push_back(std::move(value));
+  return value_.array_->back();
 }
 
 bool Value::insert(ArrayIndex index, const Value& newValue) {
+  ArenaIdScope scope(bits_.arena_);
   return insert(index, Value(newValue));
 }
 
 bool Value::insert(ArrayIndex index, Value&& newValue) {
   JSON_ASSERT_MESSAGE(type() == nullValue || type() == arrayValue,
                       "in Json::Value::insert: requires arrayValue");
-  ArrayIndex length = size();
-  if (index > length) {
+  if (type() == nullValue)
+    *this = Value(arrayValue);
+  if (index > size()) {
     return false;
   }
-  for (ArrayIndex i = length; i > index; i--) {
-    (*this)[i] = std::move((*this)[i - 1]);
-  }
-  (*this)[index] = std::move(newValue);
+  detach();
+  value_.array_->insert(value_.array_->begin() + index, std::move(newValue));
   return true;
 }
 
@@ -1165,18 +2359,12 @@ Value Value::get(String const& key, Value const& defaultValue) const {
 }
 
 bool Value::removeMember(const char* begin, const char* end, Value* removed) {
-  if (type() != objectValue) {
+  if (type() != objectValue || !find(begin, end)) {
     return false;
   }
-  CZString actualKey(begin, static_cast<unsigned>(end - begin),
-                     CZString::noDuplication);
-  auto it = value_.map_->find(actualKey);
-  if (it == value_.map_->end())
-    return false;
-  if (removed)
-    *removed = std::move(it->second);
-  value_.map_->erase(it);
-  return true;
+  detach();
+  return value_.map_->erase(begin, static_cast<unsigned>(end - begin),
+                            removed);
 }
 bool Value::removeMember(const char* key, Value* removed) {
   return removeMember(key, key + strlen(key), removed);
@@ -1190,32 +2378,19 @@ void Value::removeMember(const char* key) {
   if (type() == nullValue)
     return;
 
-  CZString actualKey(key, unsigned(strlen(key)), CZString::noDuplication);
-  value_.map_->erase(actualKey);
+  removeMember(key, key + strlen(key), nullptr);
 }
 void Value::removeMember(const String& key) { removeMember(key.c_str()); }
 
 bool Value::removeIndex(ArrayIndex index, Value* removed) {
-  if (type() != arrayValue) {
-    return false;
-  }
-  CZString key(index);
-  auto it = value_.map_->find(key);
-  if (it == value_.map_->end()) {
+  if (type() != arrayValue || index >= size()) {
     return false;
   }
+  detach();
+  auto it = value_.array_->begin() + index;
   if (removed)
-    *removed = it->second;
-  ArrayIndex oldSize = size();
-  // shift left all items left, into the place of the "removed"
-  for (ArrayIndex i = index; i < (oldSize - 1); ++i) {
-    CZString keey(i);
-    (*value_.map_)[keey] = (*this)[i + 1];
-  }
-  // erase the last one ("leftover")
-  CZString keyLast(oldSize - 1);
-  auto itLast = value_.map_->find(keyLast);
-  value_.map_->erase(itLast);
+    *removed = std::move(*it);
+  value_.array_->erase(it);
   return true;
 }
 
@@ -1237,15 +2412,27 @@ Value::Members Value::getMemberNames() const {
   if (type() == nullValue)
     return Value::Members();
   Members members;
-  members.reserve(value_.map_->size());
-  ObjectValues::const_iterator it = value_.map_->begin();
-  ObjectValues::const_iterator itEnd = value_.map_->end();
-  for (; it != itEnd; ++it) {
-    members.push_back(String((*it).first.data(), (*it).first.length()));
+  ArrayIndex size = value_.map_->size();
+  members.reserve(size);
+  for (ArrayIndex position = 0; position < size; ++position) {
+    const CZString& key = value_.map_->at(position).key_;
+    members.push_back(String(key.data(), key.length()));
   }
   return members;
 }
 
+Value::MemberRange Value::members() {
+  JSON_ASSERT_MESSAGE(type() == nullValue || type() == objectValue,
+                      "in Json::Value::members(), value must be objectValue");
+  return MemberRange(begin(), end());
+}
+
+Value::ConstMemberRange Value::members() const {
+  JSON_ASSERT_MESSAGE(type() == nullValue || type() == objectValue,
+                      "in Json::Value::members(), value must be objectValue");
+  return ConstMemberRange(begin(), end());
+}
+
 static bool IsIntegral(double d) {
   double integral_part;
   return modf(d, &integral_part) == 0.0;
@@ -1371,6 +2558,7 @@ bool Value::isArray() const { return type() == arrayValue; }
 
 bool Value::isObject() const { return type() == objectValue; }
 
+#if !JSON_USE_LEAN_VALUE
 Value::Comments::Comments(const Comments& that)
     : ptr_{cloneUnique(that.ptr_)} {}
 
@@ -1404,6 +2592,7 @@ void Value::Comments::set(CommentPlacement slot, String comment) {
     ptr_ = std::unique_ptr<Array>(new Array());
   (*ptr_)[slot] = std::move(comment);
 }
+#endif // if !JSON_USE_LEAN_VALUE
 
 void Value::setComment(String comment, CommentPlacement placement) {
   if (!comment.empty() && (comment.back() == '\n')) {
@@ -1414,9 +2603,16 @@ void Value::setComment(String comment, CommentPlacement placement) {
   JSON_ASSERT_MESSAGE(
       comment[0] == '\0' || comment[0] == '/',
       "in Json::Value::setComment(): Comments must start with /");
+#if !JSON_USE_LEAN_VALUE
+  if (bits_.arena_)
+    return; // see Arena
   comments_.set(placement, std::move(comment));
+#else
+  (void)placement;
+#endif
 }
 
+#if !JSON_USE_LEAN_VALUE
 bool Value::hasComment(CommentPlacement placement) const {
   return comments_.has(placement);
 }
@@ -1432,6 +2628,19 @@ void Value::setOffsetLimit(ptrdiff_t limit) { limit_ = limit; }
 ptrdiff_t Value::getOffsetStart() const { return start_; }
 
 ptrdiff_t Value::getOffsetLimit() const { return limit_; }
+#else  // if !JSON_USE_LEAN_VALUE
+bool Value::hasComment(CommentPlacement) const { return false; }
+
+String Value::getComment(CommentPlacement) const { return {}; }
+
+void Value::setOffsetStart(ptrdiff_t) {}
+
+void Value::setOffsetLimit(ptrdiff_t) {}
+
+ptrdiff_t Value::getOffsetStart() const { return 0; }
+
+ptrdiff_t Value::getOffsetLimit() const { return 0; }
+#endif // if !JSON_USE_LEAN_VALUE
 
 String Value::toStyledString() const {
   StreamWriterBuilder builder;
@@ -1446,9 +2655,11 @@ String Value::toStyledString() const {
 Value::const_iterator Value::begin() const {
   switch (type()) {
   case arrayValue:
+    value_.array_->box();
+    return const_iterator(value_.array_, 0);
   case objectValue:
     if (value_.map_)
-      return const_iterator(value_.map_->begin());
+      return const_iterator(value_.map_, 0);
     break;
   default:
     break;
@@ -1459,9 +2670,11 @@ Value::const_iterator Value::begin() const {
 Value::const_iterator Value::end() const {
   switch (type()) {
   case arrayValue:
+    value_.array_->box();
+    return const_iterator(value_.array_, size());
   case objectValue:
     if (value_.map_)
-      return const_iterator(value_.map_->end());
+      return const_iterator(value_.map_, value_.map_->size());
     break;
   default:
     break;
@@ -1470,11 +2683,13 @@ Value::const_iterator Value::end() const {
 }
 
 Value::iterator Value::begin() {
+  detach();
   switch (type()) {
   case arrayValue:
+    return iterator(value_.array_, 0);
   case objectValue:
     if (value_.map_)
-      return iterator(value_.map_->begin());
+      return iterator(value_.map_, 0);
     break;
   default:
     break;
@@ -1483,11 +2698,13 @@ Value::iterator Value::begin() {
 }
 
 Value::iterator Value::end() {
+  detach();
   switch (type()) {
   case arrayValue:
+    return iterator(value_.array_, size());
   case objectValue:
     if (value_.map_)
-      return iterator(value_.map_->end());
+      return iterator(value_.map_, value_.map_->size());
     break;
   default:
     break;
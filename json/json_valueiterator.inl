@@ -15,69 +15,67 @@ namespace Json {
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
 
-ValueIteratorBase::ValueIteratorBase() : current_() {}
+ValueIteratorBase::ValueIteratorBase() = default;
 
-ValueIteratorBase::ValueIteratorBase(
-    const Value::ObjectValues::iterator& current)
-    : current_(current), isNull_(false) {}
+ValueIteratorBase::ValueIteratorBase(Value::ArrayValues* array,
+                                     ArrayIndex index)
+    : array_(array), index_(index), isNull_(false) {}
 
-Value& ValueIteratorBase::deref() { return current_->second; }
-const Value& ValueIteratorBase::deref() const { return current_->second; }
+ValueIteratorBase::ValueIteratorBase(Value::ObjectValues* object,
+                                     ArrayIndex index)
+    : object_(object), index_(index), isNull_(false) {}
 
-void ValueIteratorBase::increment() { ++current_; }
+Value& ValueIteratorBase::deref() {
+  if (array_)
+    return (*array_)[index_];
+  return object_->at(index_).value_;
+}
+const Value& ValueIteratorBase::deref() const {
+  if (array_)
+    return (*array_)[index_];
+  return object_->at(index_).value_;
+}
 
-void ValueIteratorBase::decrement() { --current_; }
+void ValueIteratorBase::increment() { ++index_; }
+
+void ValueIteratorBase::decrement() { --index_; }
 
 ValueIteratorBase::difference_type
 ValueIteratorBase::computeDistance(const SelfType& other) const {
-  // Iterator for null value are initialized using the default
-  // constructor, which initialize current_ to the default
-  // std::map::iterator. As begin() and end() are two instance
-  // of the default std::map::iterator, they can not be compared.
-  // To allow this, we handle this comparison specifically.
+  // Iterators for null values are default constructed and have no position.
   if (isNull_ && other.isNull_) {
     return 0;
   }
-
-  // Usage of std::distance is not portable (does not compile with Sun Studio 12
-  // RogueWave STL,
-  // which is the one used by default).
-  // Using a portable hand-made version for non random iterator instead:
-  //   return difference_type( std::distance( current_, other.current_ ) );
-  difference_type myDistance = 0;
-  for (Value::ObjectValues::iterator it = current_; it != other.current_;
-       ++it) {
-    ++myDistance;
-  }
-  return myDistance;
+  return difference_type(other.index_) - difference_type(index_);
 }
 
 bool ValueIteratorBase::isEqual(const SelfType& other) const {
   if (isNull_) {
     return other.isNull_;
   }
-  return current_ == other.current_;
+  return array_ == other.array_ && object_ == other.object_ &&
+         index_ == other.index_;
 }
 
 void ValueIteratorBase::copy(const SelfType& other) {
-  current_ = other.current_;
+  array_ = other.array_;
+  object_ = other.object_;
+  index_ = other.index_;
   isNull_ = other.isNull_;
 }
 
 Value ValueIteratorBase::key() const {
-  const Value::CZString czstring = (*current_).first;
-  if (czstring.data()) {
-    if (czstring.isStaticString())
-      return Value(StaticString(czstring.data()));
-    return Value(czstring.data(), czstring.data() + czstring.length());
-  }
-  return Value(czstring.index());
+  if (array_)
+    return Value(index_);
+  const Value::CZString& czstring = object_->at(index_).key_;
+  if (czstring.isStaticString())
+    return Value(StaticString(czstring.data()));
+  return Value(czstring.data(), czstring.data() + czstring.length());
 }
 
 UInt ValueIteratorBase::index() const {
-  const Value::CZString czstring = (*current_).first;
-  if (!czstring.data())
-    return czstring.index();
+  if (array_)
+    return index_;
   return Value::UInt(-1);
 }
 
@@ -91,18 +89,19 @@ String ValueIteratorBase::name() const {
 }
 
 char const* ValueIteratorBase::memberName() const {
-  const char* cname = (*current_).first.data();
-  return cname ? cname : "";
+  if (!object_)
+    return "";
+  return object_->at(index_).key_.data();
 }
 
 char const* ValueIteratorBase::memberName(char const** end) const {
-  const char* cname = (*current_).first.data();
-  if (!cname) {
+  if (!object_) {
     *end = nullptr;
     return nullptr;
   }
-  *end = cname + (*current_).first.length();
-  return cname;
+  const Value::CZString& czstring = object_->at(index_).key_;
+  *end = czstring.data() + czstring.length();
+  return czstring.data();
 }
 
 // //////////////////////////////////////////////////////////////////
@@ -115,9 +114,13 @@ char const* ValueIteratorBase::memberName(char const** end) const {
 
 ValueConstIterator::ValueConstIterator() = default;
 
-ValueConstIterator::ValueConstIterator(
-    const Value::ObjectValues::iterator& current)
-    : ValueIteratorBase(current) {}
+ValueConstIterator::ValueConstIterator(Value::ArrayValues* array,
+                                       ArrayIndex index)
+    : ValueIteratorBase(array, index) {}
+
+ValueConstIterator::ValueConstIterator(Value::ObjectValues* object,
+                                       ArrayIndex index)
+    : ValueIteratorBase(object, index) {}
 
 ValueConstIterator::ValueConstIterator(ValueIterator const& other)
     : ValueIteratorBase(other) {}
@@ -138,8 +141,11 @@ operator=(const ValueIteratorBase& other) {
 
 ValueIterator::ValueIterator() = default;
 
-ValueIterator::ValueIterator(const Value::ObjectValues::iterator& current)
-    : ValueIteratorBase(current) {}
+ValueIterator::ValueIterator(Value::ArrayValues* array, ArrayIndex index)
+    : ValueIteratorBase(array, index) {}
+
+ValueIterator::ValueIterator(Value::ObjectValues* object, ArrayIndex index)
+    : ValueIteratorBase(object, index) {}
 
 ValueIterator::ValueIterator(const ValueConstIterator& other)
     : ValueIteratorBase(other) {
@@ -124,23 +124,62 @@ String valueToString(UInt value) { return valueToString(LargestUInt(value)); }
 #endif // # if defined(JSON_HAS_INT64)
 
 namespace {
+double avoidSubnormal(double value) {
+#ifdef __clang__
+  //Avoid subnormal representation as istream fails on it, thus making roundtrip impossible https://stackoverflow.com/a/48087390
+  if(std::abs(value) < std::numeric_limits<double>::min())
+    value = std::abs(value) > (std::numeric_limits<double>::min()/2) ? std::numeric_limits<double>::min() * !std::signbit(value): 0;
+#endif
+  return value;
+}
+
+const char* nonFiniteText(double value, bool useSpecialFloats) {
+  static const char* const reps[2][3] = {{"NaN", "-Infinity", "Infinity"},
+                                         {"null", "-1e+9999", "1e+9999"}};
+  return reps[useSpecialFloats ? 0 : 1]
+              [isnan(value) ? 0 : (value < 0) ? 1 : 2];
+}
+
+// The longest text writeRoundTripDouble writes: "-2.2250738585072014e-308".
+constexpr size_t maxRoundTripDoubleLength = 24;
+
+// Writes the shortest text that reads back as value and returns its end.
+char* writeRoundTripDouble(char* out, double value, bool useSpecialFloats) {
+  if (!isfinite(value)) {
+    const char* rep = nonFiniteText(value, useSpecialFloats);
+    size_t length = strlen(rep);
+    memcpy(out, rep, length);
+    return out + length;
+  }
+
+  char* end = writeShortestDouble(avoidSubnormal(value), out);
+  // try to ensure we preserve the fact that this was given to us as a double
+  // on input
+  if (std::find_if(out, end, [](char c) { return c == '.' || c == 'e'; }) ==
+      end) {
+    *end++ = '.';
+    *end++ = '0';
+  }
+  return end;
+}
+
 String valueToString(double value, bool useSpecialFloats,
                      unsigned int precision, PrecisionType precisionType) {
+  // 17 significant digits always round-trip, so from there on the shortest
+  // text that does is written instead.
+  if (precisionType == PrecisionType::significantDigits && precision >= 17) {
+    char buffer[maxRoundTripDoubleLength];
+    return String(buffer,
+                  writeRoundTripDouble(buffer, value, useSpecialFloats));
+  }
+
   // Print into the buffer. We need not request the alternative representation
   // that always has a decimal point because JSON doesn't distinguish the
   // concepts of reals and integers.
-  if (!isfinite(value)) {
-    static const char* const reps[2][3] = {{"NaN", "-Infinity", "Infinity"},
-                                           {"null", "-1e+9999", "1e+9999"}};
-    return reps[useSpecialFloats ? 0 : 1]
-               [isnan(value) ? 0 : (value < 0) ? 1 : 2];
-  }
+  if (!isfinite(value))
+    return nonFiniteText(value, useSpecialFloats);
 
-#ifdef __clang__
-  //Avoid subnormal representation as istream fails on it, thus making roundtrip impossible https://stackoverflow.com/a/48087390
-  if(std::abs(value) < std::numeric_limits<double>::min())
-    value = std::abs(value) > (std::numeric_limits<double>::min()/2) ? std::numeric_limits<double>::min() * !std::signbit(value): 0;
-#endif
+  value = avoidSubnormal(value);
 
   String buffer(size_t(36), '\0');
   while (true) {
@@ -183,14 +222,6 @@ String valueToString(double value, unsigned int precision,
 
 String valueToString(bool value) { return value ? "true" : "false"; }
 
-static bool doesAnyCharRequireEscaping(char const* s, size_t n) {
-  assert(s || !n);
-
-  return std::any_of(s, s + n, [](unsigned char c) {
-    return c == '\\' || c == '"' || c < 0x20 || c > 0x7F;
-  });
-}
-
 static unsigned int utf8ToCodepoint(const char*& s, const char* e) {
   const unsigned int REPLACEMENT_CHARACTER = 0xFFFD;
 
@@ -259,62 +290,69 @@ static const char hex2[] = "000102030405060708090a0b0c0d0e0f"
                            "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
                            "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
 
-static String toHex16Bit(unsigned int x) {
-  const unsigned int hi = (x >> 8) & 0xff;
-  const unsigned int lo = x & 0xff;
-  String result(4, ' ');
-  result[0] = hex2[2 * hi];
-  result[1] = hex2[2 * hi + 1];
-  result[2] = hex2[2 * lo];
-  result[3] = hex2[2 * lo + 1];
-  return result;
-}
-
-static void appendRaw(String& result, unsigned ch) {
-  result += static_cast<char>(ch);
-}
-
-static void appendHex(String& result, unsigned ch) {
-  result.append("\\u").append(toHex16Bit(ch));
-}
+namespace {
+// Counts the chars of an escaped string without writing them.
+struct EscapeCounter {
+  size_t length{0};
+  void raw(char const*, size_t n) { length += n; }
+  void hex(unsigned) { length += 6; }
+};
 
-static String valueToQuotedStringN(const char* value, size_t length,
-                                   bool emitUTF8 = false) {
-  if (value == nullptr)
-    return "";
+// Writes the chars of an escaped string to a buffer sized by EscapeCounter.
+struct EscapeWriter {
+  char* out;
+  void raw(char const* s, size_t n) {
+    memcpy(out, s, n);
+    out += n;
+  }
+  void hex(unsigned ch) {
+    const unsigned int hi = (ch >> 8) & 0xff;
+    const unsigned int lo = ch & 0xff;
+    out[0] = '\\';
+    out[1] = 'u';
+    out[2] = hex2[2 * hi];
+    out[3] = hex2[2 * hi + 1];
+    out[4] = hex2[2 * lo];
+    out[5] = hex2[2 * lo + 1];
+    out += 6;
+  }
+};
 
-  if (!doesAnyCharRequireEscaping(value, length))
-    return String("\"") + value + "\"";
-  // We have to walk value and escape any special characters.
-  // Appending to String is not efficient, but this should be rare.
-  // (Note: forward slashes are *not* rare, but I am not escaping them.)
-  String::size_type maxsize = length * 2 + 3; // allescaped+quotes+NULL
-  String result;
-  result.reserve(maxsize); // to avoid lots of mallocs
-  result += "\"";
+// Hands value to sink as the inside of a JSON string. Runs that need no
+// escaping are found a block at a time and handed over in one piece, so a
+// clean string costs one scan and one copy.
+template <typename Sink>
+void escapeString(const char* value, size_t length, bool emitUTF8,
+                  Sink& sink) {
   char const* end = value + length;
   for (const char* c = value; c != end; ++c) {
+    char const* run = c;
+    c = findCharToEscape(c, end, emitUTF8);
+    if (c != run)
+      sink.raw(run, static_cast<size_t>(c - run));
+    if (c == end)
+      break;
     switch (*c) {
     case '\"':
-      result += "\\\"";
+      sink.raw("\\\"", 2);
       break;
     case '\\':
-      result += "\\\\";
+      sink.raw("\\\\", 2);
       break;
     case '\b':
-      result += "\\b";
+      sink.raw("\\b", 2);
       break;
     case '\f':
-      result += "\\f";
+      sink.raw("\\f", 2);
       break;
     case '\n':
-      result += "\\n";
+      sink.raw("\\n", 2);
       break;
     case '\r':
-      result += "\\r";
+      sink.raw("\\r", 2);
       break;
     case '\t':
-      result += "\\t";
+      sink.raw("\\t", 2);
       break;
     // case '/':
     // Even though \/ is considered a legal escape in JSON, a bare
@@ -328,30 +366,57 @@ static String valueToQuotedStringN(const char* value, size_t length,
       if (emitUTF8) {
         unsigned codepoint = static_cast<unsigned char>(*c);
         if (codepoint < 0x20) {
-          appendHex(result, codepoint);
+          sink.hex(codepoint);
         } else {
-          appendRaw(result, codepoint);
+          sink.raw(c, 1);
         }
       } else {
         unsigned codepoint = utf8ToCodepoint(c, end); // modifies `c`
         if (codepoint < 0x20) {
-          appendHex(result, codepoint);
+          sink.hex(codepoint);
         } else if (codepoint < 0x80) {
-          appendRaw(result, codepoint);
+          sink.raw(c, 1);
         } else if (codepoint < 0x10000) {
           // Basic Multilingual Plane
-          appendHex(result, codepoint);
+          sink.hex(codepoint);
         } else {
           // Extended Unicode. Encode 20 bits as a surrogate pair.
           codepoint -= 0x10000;
-          appendHex(result, 0xd800 + ((codepoint >> 10) & 0x3ff));
-          appendHex(result, 0xdc00 + (codepoint & 0x3ff));
+          sink.hex(0xd800 + ((codepoint >> 10) & 0x3ff));
+          sink.hex(0xdc00 + (codepoint & 0x3ff));
         }
       }
     } break;
     }
   }
-  result += "\"";
+}
+
+/// Length of value once quoted and escaped by writeQuoted.
+size_t quotedLength(const char* value, size_t length, bool emitUTF8) {
+  EscapeCounter counter;
+  escapeString(value, length, emitUTF8, counter);
+  return counter.length + 2;
+}
+
+/// Writes value quoted and escaped to out, which must have room for
+/// quotedLength(value, length, emitUTF8) chars, and returns the end.
+char* writeQuoted(char* out, const char* value, size_t length,
+                  bool emitUTF8) {
+  EscapeWriter writer{out};
+  *writer.out++ = '"';
+  escapeString(value, length, emitUTF8, writer);
+  *writer.out++ = '"';
+  return writer.out;
+}
+} // namespace
+
+static String valueToQuotedStringN(const char* value, size_t length,
+                                   bool emitUTF8 = false) {
+  if (value == nullptr)
+    return "";
+
+  String result(quotedLength(value, length, emitUTF8), '\0');
+  writeQuoted(&result[0], value, length, emitUTF8);
   return result;
 }
 
@@ -376,67 +441,298 @@ void FastWriter::dropNullPlaceholders() { dropNullPlaceholders_ = true; }
 
 void FastWriter::omitEndingLineFeed() { omitEndingLineFeed_ = true; }
 
-String FastWriter::write(const Value& root) {
-  document_.clear();
-  writeValue(root);
+namespace {
+size_t decimalLength(LargestUInt value) {
+  size_t length = 1;
+  for (; value >= 10; value /= 10)
+    ++length;
+  return length;
+}
+
+char* writeDecimal(char* out, LargestUInt value) {
+  char* end = out + decimalLength(value);
+  char* current = end;
+  do {
+    *--current = static_cast<char>(value % 10U + static_cast<unsigned>('0'));
+    value /= 10;
+  } while (value != 0);
+  return end;
+}
+
+LargestUInt magnitude(LargestInt value) {
+  return value < 0 ? LargestUInt(0) - LargestUInt(value) : LargestUInt(value);
+}
+
+// How FastWriter writes the scalars an array can be made from, with the most
+// room each may take.
+size_t scalarSize(LargestInt value) {
+  return decimalLength(magnitude(value)) + (value < 0 ? 1 : 0);
+}
+size_t scalarSize(double) { return maxRoundTripDoubleLength; }
+size_t scalarSize(bool value) { return value ? 4 : 5; }
+
+char* writeScalar(char* out, LargestInt value) {
+  if (value < 0)
+    *out++ = '-';
+  return writeDecimal(out, magnitude(value));
+}
+char* writeScalar(char* out, double value) {
+  return writeRoundTripDouble(out, value, false);
+}
+char* writeScalar(char* out, bool value) {
+  if (value) {
+    memcpy(out, "true", 4);
+    return out + 4;
+  }
+  memcpy(out, "false", 5);
+  return out + 5;
+}
+} // namespace
+
+size_t FastWriter::sizeBound(const Value& root) const {
+  return valueSize(root) + (omitEndingLineFeed_ ? 0 : 1);
+}
+
+char* FastWriter::write(const Value& root, char* buffer) const {
+  char* end = writeValue(root, buffer);
   if (!omitEndingLineFeed_)
-    document_ += '\n';
-  return document_;
+    *end++ = '\n';
+  return end;
 }
 
-void FastWriter::writeValue(const Value& value) {
+String FastWriter::write(const Value& root) {
+  String document(sizeBound(root), '\0');
+  document.resize(static_cast<size_t>(write(root, &document[0]) -
+                                      document.data()));
+  return document;
+}
+
+size_t FastWriter::valueSize(const Value& value) const {
+  switch (value.type()) {
+  case nullValue:
+    return dropNullPlaceholders_ ? 0 : 4;
+  case intValue:
+    return scalarSize(value.asLargestInt());
+  case uintValue:
+    return decimalLength(value.asLargestUInt());
+  case realValue:
+    return scalarSize(value.asDouble());
+  case stringValue: {
+    // Is NULL possible for value.string_? No.
+    char const* str;
+    char const* end;
+    if (!value.getString(&str, &end))
+      return 0;
+    return quotedLength(str, static_cast<size_t>(end - str), false);
+  }
+  case booleanValue:
+    return scalarSize(value.asBool());
+  case arrayValue: {
+    size_t size = 2;
+    const bool typed = visitTypedElements(value, [&size](auto begin, auto end) {
+      for (; begin != end; ++begin)
+        size += scalarSize(*begin) + 1;
+    });
+    if (!typed) {
+      for (auto it = value.begin(); it != value.end(); ++it)
+        size += valueSize(*it) + 1;
+    }
+    return value.empty() ? size : size - 1;
+  }
+  case objectValue: {
+    const size_t separator = yamlCompatibilityEnabled_ ? 2 : 1;
+    size_t size = 2;
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      char const* end;
+      char const* name = it.memberName(&end);
+      size += quotedLength(name, static_cast<size_t>(end - name), false) +
+              separator + valueSize(*it) + 1;
+    }
+    return value.empty() ? size : size - 1;
+  }
+  }
+  return 0;
+}
+
+char* FastWriter::writeValue(const Value& value, char* out) const {
   switch (value.type()) {
   case nullValue:
-    if (!dropNullPlaceholders_)
-      document_ += "null";
+    if (!dropNullPlaceholders_) {
+      memcpy(out, "null", 4);
+      out += 4;
+    }
     break;
   case intValue:
-    document_ += valueToString(value.asLargestInt());
+    out = writeScalar(out, value.asLargestInt());
     break;
   case uintValue:
-    document_ += valueToString(value.asLargestUInt());
+    out = writeDecimal(out, value.asLargestUInt());
     break;
   case realValue:
-    document_ += valueToString(value.asDouble());
+    out = writeScalar(out, value.asDouble());
     break;
   case stringValue: {
-    // Is NULL possible for value.string_? No.
     char const* str;
     char const* end;
-    bool ok = value.getString(&str, &end);
-    if (ok)
-      document_ += valueToQuotedStringN(str, static_cast<size_t>(end - str));
+    if (value.getString(&str, &end))
+      out = writeQuoted(out, str, static_cast<size_t>(end - str), false);
     break;
   }
   case booleanValue:
-    document_ += valueToString(value.asBool());
+    out = writeScalar(out, value.asBool());
     break;
   case arrayValue: {
-    document_ += '[';
-    ArrayIndex size = value.size();
-    for (ArrayIndex index = 0; index < size; ++index) {
-      if (index > 0)
-        document_ += ',';
-      writeValue(value[index]);
+    *out++ = '[';
+    const bool typed = visitTypedElements(value, [&out](auto begin, auto end) {
+      for (auto it = begin; it != end; ++it) {
+        if (it != begin)
+          *out++ = ',';
+        out = writeScalar(out, *it);
+      }
+    });
+    if (!typed) {
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        if (it != value.begin())
+          *out++ = ',';
+        out = writeValue(*it, out);
+      }
     }
-    document_ += ']';
+    *out++ = ']';
   } break;
   case objectValue: {
-    Value::Members members(value.getMemberNames());
-    document_ += '{';
-    for (auto it = members.begin(); it != members.end(); ++it) {
-      const String& name = *it;
-      if (it != members.begin())
-        document_ += ',';
-      document_ += valueToQuotedStringN(name.data(), name.length());
-      document_ += yamlCompatibilityEnabled_ ? ": " : ":";
-      writeValue(value[name]);
+    *out++ = '{';
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      if (it != value.begin())
+        *out++ = ',';
+      char const* end;
+      char const* name = it.memberName(&end);
+      out = writeQuoted(out, name, static_cast<size_t>(end - name), false);
+      *out++ = ':';
+      if (yamlCompatibilityEnabled_)
+        *out++ = ' ';
+      out = writeValue(*it, out);
     }
-    document_ += '}';
+    *out++ = '}';
   } break;
   }
+  return out;
+}
+
+namespace {
+// Output is handed to the stream in pieces of about this size.
+constexpr size_t streamChunkSize = 64 * 1024;
+
+void appendQuoted(String& out, const char* value, size_t length,
+                  bool emitUTF8) {
+  size_t at = out.size();
+  out.resize(at + quotedLength(value, length, emitUTF8));
+  writeQuoted(&out[at], value, length, emitUTF8);
+}
+
+// How the styled writers write the scalars an array can be made from.
+void appendElement(String& out, LargestInt value, bool, unsigned int,
+                   PrecisionType) {
+  UIntToStringBuffer buffer;
+  char* end = buffer;
+  if (value < 0)
+    *end++ = '-';
+  end = writeDecimal(end, magnitude(value));
+  out.append(buffer, end);
+}
+void appendElement(String& out, double value, bool useSpecialFloats,
+                   unsigned int precision, PrecisionType precisionType) {
+  if (precisionType == PrecisionType::significantDigits && precision >= 17) {
+    char buffer[maxRoundTripDoubleLength];
+    out.append(buffer,
+               writeRoundTripDouble(buffer, value, useSpecialFloats));
+  } else {
+    out += valueToString(value, useSpecialFloats, precision, precisionType);
+  }
+}
+void appendElement(String& out, bool value, bool, unsigned int,
+                   PrecisionType) {
+  out += value ? "true" : "false";
 }
 
+/// Appends a value that is always written on a single line: a scalar or an
+/// empty array or object. A null is written as nullSymbol.
+void appendScalar(String& out, const Value& value, const char* nullSymbol,
+                  bool emitUTF8 = false, bool useSpecialFloats = false,
+                  unsigned int precision = Value::defaultRealPrecision,
+                  PrecisionType precisionType =
+                      PrecisionType::significantDigits) {
+  switch (value.type()) {
+  case nullValue:
+    out += nullSymbol;
+    break;
+  case intValue:
+    appendElement(out, value.asLargestInt(), useSpecialFloats, precision,
+                  precisionType);
+    break;
+  case uintValue: {
+    UIntToStringBuffer buffer;
+    out.append(buffer, writeDecimal(buffer, value.asLargestUInt()));
+  } break;
+  case realValue:
+    appendElement(out, value.asDouble(), useSpecialFloats, precision,
+                  precisionType);
+    break;
+  case stringValue: {
+    // Is NULL possible for value.string_? No.
+    char const* str;
+    char const* end;
+    if (value.getString(&str, &end))
+      appendQuoted(out, str, static_cast<size_t>(end - str), emitUTF8);
+  } break;
+  case booleanValue:
+    appendElement(out, value.asBool(), useSpecialFloats, precision,
+                  precisionType);
+    break;
+  case arrayValue:
+    out += "[]";
+    break;
+  case objectValue:
+    out += "{}";
+    break;
+  }
+}
+
+/// Appends the elements of an array made from doubles, Int64s or bools as
+/// appendScalar() would, noting where each one ends like pushValue() does.
+/// Returns false for any other value.
+bool appendTypedElements(String& childText, std::vector<size_t>& childEnds,
+                         const Value& value, bool useSpecialFloats = false,
+                         unsigned int precision = Value::defaultRealPrecision,
+                         PrecisionType precisionType =
+                             PrecisionType::significantDigits) {
+  return visitTypedElements(value, [&](auto begin, auto end) {
+    childEnds.reserve(static_cast<size_t>(end - begin));
+    for (; begin != end; ++begin) {
+      appendElement(childText, *begin, useSpecialFloats, precision,
+                    precisionType);
+      childEnds.push_back(childText.size());
+    }
+  });
+}
+
+bool isTypedArray(const Value& value) {
+  return visitTypedElements(value, [](auto, auto) {});
+}
+
+/// Appends the text pushValue() left for the child at index.
+void appendChildValue(String& out, const String& childText,
+                      const std::vector<size_t>& childEnds, size_t index) {
+  size_t begin = index == 0 ? 0 : childEnds[index - 1];
+  out.append(childText, begin, childEnds[index] - begin);
+}
+
+/// The length of a member name as the legacy writers quote it, which is up
+/// to its first null char.
+size_t legacyNameLength(char const* name, char const* end) {
+  return static_cast<size_t>(std::find(name, end, '\0') - name);
+}
+} // namespace
+
 // Class StyledWriter
 // //////////////////////////////////////////////////////////////////
 
@@ -456,50 +752,33 @@ String StyledWriter::write(const Value& root) {
 void StyledWriter::writeValue(const Value& value) {
   switch (value.type()) {
   case nullValue:
-    pushValue("null");
-    break;
   case intValue:
-    pushValue(valueToString(value.asLargestInt()));
-    break;
   case uintValue:
-    pushValue(valueToString(value.asLargestUInt()));
-    break;
   case realValue:
-    pushValue(valueToString(value.asDouble()));
-    break;
-  case stringValue: {
-    // Is NULL possible for value.string_? No.
-    char const* str;
-    char const* end;
-    bool ok = value.getString(&str, &end);
-    if (ok)
-      pushValue(valueToQuotedStringN(str, static_cast<size_t>(end - str)));
-    else
-      pushValue("");
-    break;
-  }
+  case stringValue:
   case booleanValue:
-    pushValue(valueToString(value.asBool()));
+    pushValue(value);
     break;
   case arrayValue:
     writeArrayValue(value);
     break;
   case objectValue: {
-    Value::Members members(value.getMemberNames());
-    if (members.empty())
-      pushValue("{}");
+    if (value.empty())
+      pushValue(value);
     else {
       writeWithIndent("{");
       indent();
-      auto it = members.begin();
+      auto it = value.begin();
       for (;;) {
-        const String& name = *it;
-        const Value& childValue = value[name];
+        const Value& childValue = *it;
+        char const* end;
+        char const* name = it.memberName(&end);
         writeCommentBeforeValue(childValue);
-        writeWithIndent(valueToQuotedString(name.c_str()));
+        writeIndent();
+        appendQuoted(document_, name, legacyNameLength(name, end), false);
         document_ += " : ";
         writeValue(childValue);
-        if (++it == members.end()) {
+        if (++it == value.end()) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
@@ -516,23 +795,26 @@ void StyledWriter::writeValue(const Value& value) {
 void StyledWriter::writeArrayValue(const Value& value) {
   size_t size = value.size();
   if (size == 0)
-    pushValue("[]");
+    pushValue(value);
   else {
     bool isArrayMultiLine = isMultilineArray(value);
     if (isArrayMultiLine) {
       writeWithIndent("[");
       indent();
-      bool hasChildValue = !childValues_.empty();
+      bool hasChildValue = !childEnds_.empty();
+      // isMultilineArray() wrote all elements of a typed array, which have
+      // no comments, so they are not looked up.
+      const bool typed = isTypedArray(value);
       ArrayIndex index = 0;
       for (;;) {
-        const Value& childValue = value[index];
+        const Value& childValue =
+            typed ? Value::nullSingleton() : value[index];
         writeCommentBeforeValue(childValue);
+        writeIndent();
         if (hasChildValue)
-          writeWithIndent(childValues_[index]);
-        else {
-          writeIndent();
+          appendChildValue(document_, childText_, childEnds_, index);
+        else
           writeValue(childValue);
-        }
         if (++index == size) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
@@ -544,22 +826,30 @@ void StyledWriter::writeArrayValue(const Value& value) {
       writeWithIndent("]");
     } else // output on a single line
     {
-      assert(childValues_.size() == size);
+      assert(childEnds_.size() == size);
       document_ += "[ ";
       for (size_t index = 0; index < size; ++index) {
         if (index > 0)
           document_ += ", ";
-        document_ += childValues_[index];
+        appendChildValue(document_, childText_, childEnds_, index);
       }
       document_ += " ]";
     }
   }
 }
 
+// Only arrays of scalars and empty containers may fit on one line, so their
+// children are written once into childText_ to measure them, and that text is
+// reused whichever way the array is laid out.
 bool StyledWriter::isMultilineArray(const Value& value) {
   ArrayIndex const size = value.size();
   bool isMultiLine = size * 3 >= rightMargin_;
-  childValues_.clear();
+  childText_.clear();
+  childEnds_.clear();
+  if (appendTypedElements(childText_, childEnds_, value)) {
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
+    return isMultiLine || lineLength >= rightMargin_;
+  }
   for (ArrayIndex index = 0; index < size && !isMultiLine; ++index) {
     const Value& childValue = value[index];
     isMultiLine = ((childValue.isArray() || childValue.isObject()) &&
@@ -567,27 +857,28 @@ bool StyledWriter::isMultilineArray(const Value& value) {
   }
   if (!isMultiLine) // check if line length > max line length
   {
-    childValues_.reserve(size);
+    childEnds_.reserve(size);
     addChildValues_ = true;
-    ArrayIndex lineLength = 4 + (size - 1) * 2; // '[ ' + ', '*n + ' ]'
     for (ArrayIndex index = 0; index < size; ++index) {
       if (hasCommentForValue(value[index])) {
         isMultiLine = true;
       }
       writeValue(value[index]);
-      lineLength += static_cast<ArrayIndex>(childValues_[index].length());
     }
     addChildValues_ = false;
+    // '[ ' + ', '*n + ' ]'
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
     isMultiLine = isMultiLine || lineLength >= rightMargin_;
   }
   return isMultiLine;
 }
 
-void StyledWriter::pushValue(const String& value) {
-  if (addChildValues_)
-    childValues_.push_back(value);
-  else
-    document_ += value;
+void StyledWriter::pushValue(const Value& value) {
+  if (addChildValues_) {
+    appendScalar(childText_, value, "null");
+    childEnds_.push_back(childText_.size());
+  } else
+    appendScalar(document_, value, "null");
 }
 
 void StyledWriter::writeIndent() {
@@ -658,6 +949,7 @@ StyledStreamWriter::StyledStreamWriter(String indentation)
 
 void StyledStreamWriter::write(OStream& out, const Value& root) {
   document_ = &out;
+  buffer_.clear();
   addChildValues_ = false;
   indentString_.clear();
   indented_ = true;
@@ -667,61 +959,49 @@ void StyledStreamWriter::write(OStream& out, const Value& root) {
   indented_ = true;
   writeValue(root);
   writeCommentAfterValueOnSameLine(root);
-  *document_ << "\n";
+  buffer_ += '\n';
+  flush();
   document_ = nullptr; // Forget the stream, for safety.
 }
 
 void StyledStreamWriter::writeValue(const Value& value) {
+  if (buffer_.size() >= streamChunkSize)
+    flush();
   switch (value.type()) {
   case nullValue:
-    pushValue("null");
-    break;
   case intValue:
-    pushValue(valueToString(value.asLargestInt()));
-    break;
   case uintValue:
-    pushValue(valueToString(value.asLargestUInt()));
-    break;
   case realValue:
-    pushValue(valueToString(value.asDouble()));
-    break;
-  case stringValue: {
-    // Is NULL possible for value.string_? No.
-    char const* str;
-    char const* end;
-    bool ok = value.getString(&str, &end);
-    if (ok)
-      pushValue(valueToQuotedStringN(str, static_cast<size_t>(end - str)));
-    else
-      pushValue("");
-    break;
-  }
+  case stringValue:
   case booleanValue:
-    pushValue(valueToString(value.asBool()));
+    pushValue(value);
     break;
   case arrayValue:
     writeArrayValue(value);
     break;
   case objectValue: {
-    Value::Members members(value.getMemberNames());
-    if (members.empty())
-      pushValue("{}");
+    if (value.empty())
+      pushValue(value);
     else {
       writeWithIndent("{");
       indent();
-      auto it = members.begin();
+      auto it = value.begin();
       for (;;) {
-        const String& name = *it;
-        const Value& childValue = value[name];
+        const Value& childValue = *it;
+        char const* end;
+        char const* name = it.memberName(&end);
         writeCommentBeforeValue(childValue);
-        writeWithIndent(valueToQuotedString(name.c_str()));
-        *document_ << " : ";
+        if (!indented_)
+          writeIndent();
+        appendQuoted(buffer_, name, legacyNameLength(name, end), false);
+        indented_ = false;
+        buffer_ += " : ";
         writeValue(childValue);
-        if (++it == members.end()) {
+        if (++it == value.end()) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *document_ << ",";
+        buffer_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
@@ -734,20 +1014,27 @@ void StyledStreamWriter::writeValue(const Value& value) {
 void StyledStreamWriter::writeArrayValue(const Value& value) {
   unsigned size = value.size();
   if (size == 0)
-    pushValue("[]");
+    pushValue(value);
   else {
     bool isArrayMultiLine = isMultilineArray(value);
     if (isArrayMultiLine) {
       writeWithIndent("[");
       indent();
-      bool hasChildValue = !childValues_.empty();
+      bool hasChildValue = !childEnds_.empty();
+      // isMultilineArray() wrote all elements of a typed array, which have
+      // no comments, so they are not looked up.
+      const bool typed = isTypedArray(value);
       unsigned index = 0;
       for (;;) {
-        const Value& childValue = value[index];
+        const Value& childValue =
+            typed ? Value::nullSingleton() : value[index];
         writeCommentBeforeValue(childValue);
-        if (hasChildValue)
-          writeWithIndent(childValues_[index]);
-        else {
+        if (hasChildValue) {
+          if (!indented_)
+            writeIndent();
+          appendChildValue(buffer_, childText_, childEnds_, index);
+          indented_ = false;
+        } else {
           if (!indented_)
             writeIndent();
           indented_ = true;
@@ -758,21 +1045,21 @@ void StyledStreamWriter::writeArrayValue(const Value& value) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *document_ << ",";
+        buffer_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
       writeWithIndent("]");
     } else // output on a single line
     {
-      assert(childValues_.size() == size);
-      *document_ << "[ ";
+      assert(childEnds_.size() == size);
+      buffer_ += "[ ";
       for (unsigned index = 0; index < size; ++index) {
         if (index > 0)
-          *document_ << ", ";
-        *document_ << childValues_[index];
+          buffer_ += ", ";
+        appendChildValue(buffer_, childText_, childEnds_, index);
       }
-      *document_ << " ]";
+      buffer_ += " ]";
     }
   }
 }
@@ -780,7 +1067,12 @@ void StyledStreamWriter::writeArrayValue(const Value& value) {
 bool StyledStreamWriter::isMultilineArray(const Value& value) {
   ArrayIndex const size = value.size();
   bool isMultiLine = size * 3 >= rightMargin_;
-  childValues_.clear();
+  childText_.clear();
+  childEnds_.clear();
+  if (appendTypedElements(childText_, childEnds_, value)) {
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
+    return isMultiLine || lineLength >= rightMargin_;
+  }
   for (ArrayIndex index = 0; index < size && !isMultiLine; ++index) {
     const Value& childValue = value[index];
     isMultiLine = ((childValue.isArray() || childValue.isObject()) &&
@@ -788,27 +1080,28 @@ bool StyledStreamWriter::isMultilineArray(const Value& value) {
   }
   if (!isMultiLine) // check if line length > max line length
   {
-    childValues_.reserve(size);
+    childEnds_.reserve(size);
     addChildValues_ = true;
-    ArrayIndex lineLength = 4 + (size - 1) * 2; // '[ ' + ', '*n + ' ]'
     for (ArrayIndex index = 0; index < size; ++index) {
       if (hasCommentForValue(value[index])) {
         isMultiLine = true;
       }
       writeValue(value[index]);
-      lineLength += static_cast<ArrayIndex>(childValues_[index].length());
     }
     addChildValues_ = false;
+    // '[ ' + ', '*n + ' ]'
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
     isMultiLine = isMultiLine || lineLength >= rightMargin_;
   }
   return isMultiLine;
 }
 
-void StyledStreamWriter::pushValue(const String& value) {
-  if (addChildValues_)
-    childValues_.push_back(value);
-  else
-    *document_ << value;
+void StyledStreamWriter::pushValue(const Value& value) {
+  if (addChildValues_) {
+    appendScalar(childText_, value, "null");
+    childEnds_.push_back(childText_.size());
+  } else
+    appendScalar(buffer_, value, "null");
 }
 
 void StyledStreamWriter::writeIndent() {
@@ -816,16 +1109,23 @@ void StyledStreamWriter::writeIndent() {
   // to determine whether we are already indented, but
   // with a stream we cannot do that. So we rely on some saved state.
   // The caller checks indented_.
-  *document_ << '\n' << indentString_;
+  buffer_ += '\n';
+  buffer_ += indentString_;
 }
 
 void StyledStreamWriter::writeWithIndent(const String& value) {
   if (!indented_)
     writeIndent();
-  *document_ << value;
+  buffer_ += value;
   indented_ = false;
 }
 
+void StyledStreamWriter::flush() {
+  document_->write(buffer_.data(),
+                   static_cast<std::streamsize>(buffer_.size()));
+  buffer_.clear();
+}
+
 void StyledStreamWriter::indent() { indentString_ += indentation_; }
 
 void StyledStreamWriter::unindent() {
@@ -842,22 +1142,24 @@ void StyledStreamWriter::writeCommentBeforeValue(const Value& root) {
   const String& comment = root.getComment(commentBefore);
   String::const_iterator iter = comment.begin();
   while (iter != comment.end()) {
-    *document_ << *iter;
+    buffer_ += *iter;
     if (*iter == '\n' && ((iter + 1) != comment.end() && *(iter + 1) == '/'))
       // writeIndent();  // would include newline
-      *document_ << indentString_;
+      buffer_ += indentString_;
     ++iter;
   }
   indented_ = false;
 }
 
 void StyledStreamWriter::writeCommentAfterValueOnSameLine(const Value& root) {
-  if (root.hasComment(commentAfterOnSameLine))
-    *document_ << ' ' << root.getComment(commentAfterOnSameLine);
+  if (root.hasComment(commentAfterOnSameLine)) {
+    buffer_ += ' ';
+    buffer_ += root.getComment(commentAfterOnSameLine);
+  }
 
   if (root.hasComment(commentAfter)) {
     writeIndent();
-    *document_ << root.getComment(commentAfter);
+    buffer_ += root.getComment(commentAfter);
   }
   indented_ = false;
 }
@@ -893,18 +1195,19 @@ private:
   void writeValue(Value const& value);
   void writeArrayValue(Value const& value);
   bool isMultilineArray(Value const& value);
-  void pushValue(String const& value);
+  void pushValue(Value const& value);
   void writeIndent();
   void writeWithIndent(String const& value);
+  void flush();
   void indent();
   void unindent();
   void writeCommentBeforeValue(Value const& root);
   void writeCommentAfterValueOnSameLine(Value const& root);
   static bool hasCommentForValue(const Value& value);
 
-  using ChildValues = std::vector<String>;
-
-  ChildValues childValues_;
+  String buffer_;
+  String childText_;
+  std::vector<size_t> childEnds_;
   String indentString_;
   unsigned int rightMargin_;
   String indentation_;
@@ -931,6 +1234,7 @@ BuiltStyledStreamWriter::BuiltStyledStreamWriter(
       precision_(precision), precisionType_(precisionType) {}
 int BuiltStyledStreamWriter::write(Value const& root, OStream* sout) {
   sout_ = sout;
+  buffer_.clear();
   addChildValues_ = false;
   indented_ = true;
   indentString_.clear();
@@ -940,64 +1244,50 @@ int BuiltStyledStreamWriter::write(Value const& root, OStream* sout) {
   indented_ = true;
   writeValue(root);
   writeCommentAfterValueOnSameLine(root);
-  *sout_ << endingLineFeedSymbol_;
+  buffer_ += endingLineFeedSymbol_;
+  flush();
   sout_ = nullptr;
   return 0;
 }
 void BuiltStyledStreamWriter::writeValue(Value const& value) {
+  if (buffer_.size() >= streamChunkSize)
+    flush();
   switch (value.type()) {
   case nullValue:
-    pushValue(nullSymbol_);
-    break;
   case intValue:
-    pushValue(valueToString(value.asLargestInt()));
-    break;
   case uintValue:
-    pushValue(valueToString(value.asLargestUInt()));
-    break;
   case realValue:
-    pushValue(valueToString(value.asDouble(), useSpecialFloats_, precision_,
-                            precisionType_));
-    break;
-  case stringValue: {
-    // Is NULL is possible for value.string_? No.
-    char const* str;
-    char const* end;
-    bool ok = value.getString(&str, &end);
-    if (ok)
-      pushValue(
-          valueToQuotedStringN(str, static_cast<size_t>(end - str), emitUTF8_));
-    else
-      pushValue("");
-    break;
-  }
+  case stringValue:
   case booleanValue:
-    pushValue(valueToString(value.asBool()));
+    pushValue(value);
     break;
   case arrayValue:
     writeArrayValue(value);
     break;
   case objectValue: {
-    Value::Members members(value.getMemberNames());
-    if (members.empty())
-      pushValue("{}");
+    if (value.empty())
+      pushValue(value);
     else {
       writeWithIndent("{");
       indent();
-      auto it = members.begin();
+      auto it = value.begin();
       for (;;) {
-        String const& name = *it;
-        Value const& childValue = value[name];
+        Value const& childValue = *it;
+        char const* end;
+        char const* name = it.memberName(&end);
         writeCommentBeforeValue(childValue);
-        writeWithIndent(
-            valueToQuotedStringN(name.data(), name.length(), emitUTF8_));
-        *sout_ << colonSymbol_;
+        if (!indented_)
+          writeIndent();
+        appendQuoted(buffer_, name, static_cast<size_t>(end - name),
+                     emitUTF8_);
+        indented_ = false;
+        buffer_ += colonSymbol_;
         writeValue(childValue);
-        if (++it == members.end()) {
+        if (++it == value.end()) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *sout_ << ",";
+        buffer_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
@@ -1010,20 +1300,29 @@ void BuiltStyledStreamWriter::writeValue(Value const& value) {
 void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
   unsigned size = value.size();
   if (size == 0)
-    pushValue("[]");
+    pushValue(value);
   else {
-    bool isMultiLine = (cs_ == CommentStyle::All) || isMultilineArray(value);
+    // isMultilineArray() writes all elements of a typed array, which have
+    // no comments, so they are not looked up.
+    const bool typed = isTypedArray(value);
+    bool isMultiLine =
+        typed ? isMultilineArray(value) || cs_ == CommentStyle::All
+              : cs_ == CommentStyle::All || isMultilineArray(value);
     if (isMultiLine) {
       writeWithIndent("[");
       indent();
-      bool hasChildValue = !childValues_.empty();
+      bool hasChildValue = !childEnds_.empty();
       unsigned index = 0;
       for (;;) {
-        Value const& childValue = value[index];
+        Value const& childValue =
+            typed ? Value::nullSingleton() : value[index];
         writeCommentBeforeValue(childValue);
-        if (hasChildValue)
-          writeWithIndent(childValues_[index]);
-        else {
+        if (hasChildValue) {
+          if (!indented_)
+            writeIndent();
+          appendChildValue(buffer_, childText_, childEnds_, index);
+          indented_ = false;
+        } else {
           if (!indented_)
             writeIndent();
           indented_ = true;
@@ -1034,25 +1333,25 @@ void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
           writeCommentAfterValueOnSameLine(childValue);
           break;
         }
-        *sout_ << ",";
+        buffer_ += ',';
         writeCommentAfterValueOnSameLine(childValue);
       }
       unindent();
       writeWithIndent("]");
     } else // output on a single line
     {
-      assert(childValues_.size() == size);
-      *sout_ << "[";
+      assert(childEnds_.size() == size);
+      buffer_ += '[';
       if (!indentation_.empty())
-        *sout_ << " ";
+        buffer_ += ' ';
       for (unsigned index = 0; index < size; ++index) {
         if (index > 0)
-          *sout_ << ((!indentation_.empty()) ? ", " : ",");
-        *sout_ << childValues_[index];
+          buffer_ += ((!indentation_.empty()) ? ", " : ",");
+        appendChildValue(buffer_, childText_, childEnds_, index);
       }
       if (!indentation_.empty())
-        *sout_ << " ";
-      *sout_ << "]";
+        buffer_ += ' ';
+      buffer_ += ']';
     }
   }
 }
@@ -1060,7 +1359,13 @@ void BuiltStyledStreamWriter::writeArrayValue(Value const& value) {
 bool BuiltStyledStreamWriter::isMultilineArray(Value const& value) {
   ArrayIndex const size = value.size();
   bool isMultiLine = size * 3 >= rightMargin_;
-  childValues_.clear();
+  childText_.clear();
+  childEnds_.clear();
+  if (appendTypedElements(childText_, childEnds_, value, useSpecialFloats_,
+                          precision_, precisionType_)) {
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
+    return isMultiLine || lineLength >= rightMargin_;
+  }
   for (ArrayIndex index = 0; index < size && !isMultiLine; ++index) {
     Value const& childValue = value[index];
     isMultiLine = ((childValue.isArray() || childValue.isObject()) &&
@@ -1068,27 +1373,28 @@ bool BuiltStyledStreamWriter::isMultilineArray(Value const& value) {
   }
   if (!isMultiLine) // check if line length > max line length
   {
-    childValues_.reserve(size);
+    childEnds_.reserve(size);
     addChildValues_ = true;
-    ArrayIndex lineLength = 4 + (size - 1) * 2; // '[ ' + ', '*n + ' ]'
     for (ArrayIndex index = 0; index < size; ++index) {
       if (hasCommentForValue(value[index])) {
         isMultiLine = true;
       }
       writeValue(value[index]);
-      lineLength += static_cast<ArrayIndex>(childValues_[index].length());
     }
     addChildValues_ = false;
+    // '[ ' + ', '*n + ' ]'
+    size_t lineLength = 4 + (size - 1) * 2 + childText_.size();
     isMultiLine = isMultiLine || lineLength >= rightMargin_;
   }
   return isMultiLine;
 }
 
-void BuiltStyledStreamWriter::pushValue(String const& value) {
+void BuiltStyledStreamWriter::pushValue(Value const& value) {
+  String& out = addChildValues_ ? childText_ : buffer_;
+  appendScalar(out, value, nullSymbol_.c_str(), emitUTF8_, useSpecialFloats_,
+               precision_, precisionType_);
   if (addChildValues_)
-    childValues_.push_back(value);
-  else
-    *sout_ << value;
+    childEnds_.push_back(childText_.size());
 }
 
 void BuiltStyledStreamWriter::writeIndent() {
@@ -1099,17 +1405,23 @@ void BuiltStyledStreamWriter::writeIndent() {
 
   if (!indentation_.empty()) {
     // In this case, drop newlines too.
-    *sout_ << '\n' << indentString_;
+    buffer_ += '\n';
+    buffer_ += indentString_;
   }
 }
 
 void BuiltStyledStreamWriter::writeWithIndent(String const& value) {
   if (!indented_)
     writeIndent();
-  *sout_ << value;
+  buffer_ += value;
   indented_ = false;
 }
 
+void BuiltStyledStreamWriter::flush() {
+  sout_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  buffer_.clear();
+}
+
 void BuiltStyledStreamWriter::indent() { indentString_ += indentation_; }
 
 void BuiltStyledStreamWriter::unindent() {
@@ -1128,10 +1440,10 @@ void BuiltStyledStreamWriter::writeCommentBeforeValue(Value const& root) {
   const String& comment = root.getComment(commentBefore);
   String::const_iterator iter = comment.begin();
   while (iter != comment.end()) {
-    *sout_ << *iter;
+    buffer_ += *iter;
     if (*iter == '\n' && ((iter + 1) != comment.end() && *(iter + 1) == '/'))
       // writeIndent();  // would write extra newline
-      *sout_ << indentString_;
+      buffer_ += indentString_;
     ++iter;
   }
   indented_ = false;
@@ -1141,12 +1453,14 @@ void BuiltStyledStreamWriter::writeCommentAfterValueOnSameLine(
     Value const& root) {
   if (cs_ == CommentStyle::None)
     return;
-  if (root.hasComment(commentAfterOnSameLine))
-    *sout_ << " " + root.getComment(commentAfterOnSameLine);
+  if (root.hasComment(commentAfterOnSameLine)) {
+    buffer_ += ' ';
+    buffer_ += root.getComment(commentAfterOnSameLine);
+  }
 
   if (root.hasComment(commentAfter)) {
     writeIndent();
-    *sout_ << root.getComment(commentAfter);
+    buffer_ += root.getComment(commentAfter);
   }
 }
 
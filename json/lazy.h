@@ -0,0 +1,164 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_LAZY_H_INCLUDED
+#define JSON_LAZY_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cstdint>
+#include <memory>
+
+// Disable warning C4251: <data member>: <type> needs to have dll-interface to
+// be used by...
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+class LazyDocument;
+
+/** \brief Read-only view of a value in a LazyDocument.
+ *
+ * The members or elements of an array or object are listed the first time
+ * one of them is looked up, and nothing below them is read then. A value is
+ * decoded only by a conversion or by toValue(). The accessors behave like
+ * those of Value: a missing member or index gives a null view, and
+ * conversions check their ranges the same way. A view is a pointer into the
+ * document and must not be used after the document is cleared.
+ */
+class JSON_API LazyValue {
+public:
+  /// A null view.
+  LazyValue() = default;
+
+  ValueType type() const;
+  bool isNull() const { return type() == nullValue; }
+  bool isBool() const { return type() == booleanValue; }
+  bool isString() const { return type() == stringValue; }
+  bool isArray() const { return type() == arrayValue; }
+  bool isObject() const { return type() == objectValue; }
+
+  bool asBool() const { return scalar().asBool(); }
+  Int asInt() const { return scalar().asInt(); }
+  UInt asUInt() const { return scalar().asUInt(); }
+#if defined(JSON_HAS_INT64)
+  Int64 asInt64() const { return scalar().asInt64(); }
+  UInt64 asUInt64() const { return scalar().asUInt64(); }
+#endif // if defined(JSON_HAS_INT64)
+  LargestInt asLargestInt() const { return scalar().asLargestInt(); }
+  LargestUInt asLargestUInt() const { return scalar().asLargestUInt(); }
+  double asDouble() const { return scalar().asDouble(); }
+  String asString() const { return scalar().asString(); }
+
+  /// Number of elements or members, 0 for scalars.
+  ArrayIndex size() const;
+  /// As Value::empty(), false for strings, numbers and bools.
+  bool empty() const {
+    return (isNull() || isArray() || isObject()) && size() == 0;
+  }
+
+  /// The element at index, or a null view if there is none.
+  /// \pre type() is arrayValue or nullValue
+  LazyValue operator[](ArrayIndex index) const;
+  /// The member named key, or a null view if there is none.
+  /// \pre type() is objectValue or nullValue
+  LazyValue operator[](const char* key) const;
+  LazyValue operator[](const String& key) const;
+  /// Looks a member up by binary search; false if there is none.
+  bool find(char const* begin, char const* end, LazyValue* found) const;
+  bool isMember(const char* key) const;
+  bool isMember(const String& key) const;
+
+  /// Name of the member at position, in the order getMemberNames() lists
+  /// them.
+  /// \pre type() is objectValue and position < size()
+  char const* memberName(ArrayIndex position, char const** end) const;
+  /// Value of the member at position.
+  LazyValue member(ArrayIndex position) const;
+  Value::Members getMemberNames() const;
+
+  /// The text of this value in the document, as it was parsed; empty for a
+  /// null view.
+  void getText(char const** begin, char const** end) const;
+  /// Reads this value and everything below it into a Value.
+  Value toValue() const;
+
+private:
+  friend class LazyDocument;
+  LazyValue(LazyDocument const* document, uint32_t position,
+            uint32_t container)
+      : document_(document), position_(position), container_(container) {}
+
+  Value scalar() const;
+  char first() const;
+
+  LazyDocument const* document_{nullptr};
+  // Index of the value's first character in the structural index.
+  uint32_t position_{0};
+  // Number of the array or object, if the value is one.
+  uint32_t container_{0};
+};
+
+/** \brief JSON text that is read only as far as it is used.
+ *
+ * parse() checks the whole text in one fast pass that finds where every
+ * value starts and where every array and object ends, but builds nothing.
+ * Reading a few members of a big document then costs little more than that
+ * pass:
+ *   \code
+ *   Json::LazyDocument known;
+ *   if (known.parse(text.data(), text.data() + text.size(), &errs))
+ *     issues = known.root()[version].toValue();
+ *   \endcode
+ * The text has to be JSON as RFC 8259 defines it: no comments, nothing but
+ * whitespace after the value, nesting at most 1000 deep. A byte order mark
+ * is skipped and of duplicate member names the last one is kept. For such
+ * text every view gives what the Value read by CharReaderBuilder with its
+ * default settings would, offsets included; anything else fails to parse.
+ *
+ * A document and its views may be used by several threads at once.
+ */
+class JSON_API LazyDocument {
+public:
+  LazyDocument();
+  LazyDocument(LazyDocument const&) = delete;
+  LazyDocument& operator=(LazyDocument const&) = delete;
+  ~LazyDocument();
+
+  /// Copies and checks [begin, end). On failure, errs (if not null) gets
+  /// the reason and the document is empty.
+  bool parse(char const* begin, char const* end, String* errs);
+  /// Checks text, which the document keeps without copying it.
+  bool parse(String text, String* errs);
+  /// Drops the text. Views into it become invalid.
+  void clear();
+
+  bool isParsed() const;
+  /// The root value, or a null view if nothing is parsed.
+  LazyValue root() const;
+
+private:
+  friend class LazyValue;
+  struct Text;
+
+  std::unique_ptr<Text> text_;
+};
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(pop)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#endif // JSON_LAZY_H_INCLUDED
@@ -0,0 +1,70 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_PATCH_H_INCLUDED
+#define JSON_PATCH_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+/* JSON Patch (RFC 6902), to send what changed in a tree instead of all of it.
+ *
+ * A patch is an array of operations, each an object such as
+ *   {"op": "replace", "path": "/options/plot", "value": true}
+ * where path is a JSON Pointer (RFC 6901): the member names and array
+ * indices leading to a value, each after a '/', with '~' written as "~0"
+ * and '/' as "~1". The empty path is the whole document.
+ *
+ *   \code
+ *   Json::Value delta = Json::createPatch(lastSent, options);
+ *   send(delta);
+ *   lastSent = options; // a copy shares the contents, see Value
+ *   ...
+ *   Json::String errs;
+ *   if (!Json::applyPatch(&received, delta, &errs))
+ *     handleError(errs);
+ *   \endcode
+ */
+
+/** \brief The operations that turn from into to.
+ *
+ * Objects are compared member by member and arrays element by element,
+ * after skipping the elements that are equal at their start and at their
+ * end, so inserting or removing a row gives one operation. Values that
+ * differ otherwise, or in type, are replaced as a whole. Only "add",
+ * "remove" and "replace" are written. Equal subtrees are skipped with
+ * operator==, which does not look into contents shared with a copy or
+ * with different cached hashes, so diffing against a modified copy of from
+ * costs about the size of the change.
+ */
+Value JSON_API createPatch(Value const& from, Value const& to);
+
+/** \brief Applies the operations of patch to root, in order.
+ *
+ * All six operations of RFC 6902 are understood; "test" compares numbers by
+ * value, so 1 matches 1.0. Members of an operation other than those it
+ * needs are ignored.
+ *
+ * The operations are applied to a copy of root, which shares whatever they
+ * do not modify, and root takes its place once all succeeded. (For a value
+ * in an Arena, apply within an ArenaScope for that arena, or the copy is a
+ * full one.)
+ * \return false, with the failing operation in errs if it is not null, when
+ *         patch is not an array of operations or one of them fails. root is
+ *         then left as it was.
+ */
+bool JSON_API applyPatch(Value* root, Value const& patch, String* errs);
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#endif // JSON_PATCH_H_INCLUDED
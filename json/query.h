@@ -0,0 +1,106 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_QUERY_H_INCLUDED
+#define JSON_QUERY_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <vector>
+
+// Disable warning C4251: <data member>: <type> needs to have dll-interface to
+// be used by...
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+/** \brief A path to the values in a tree, compiled once and used many times.
+ *
+ * Unlike Path, a query can match more than one value: a step can take every
+ * member or element, or the elements that are objects with a given member
+ * value. Resolving walks the tree once, looking members up by name without
+ * building any strings. The text form extends that of Path:
+ * - "." or "" => root node
+ * - ".name" => member 'name' (up to the next '.' or '[')
+ * - ".\"any name\"" or "[\"any name\"]" => member with any name, written
+ *   as a JSON string; so ".\".meta\"" is the member .meta, where ".meta"
+ *   would be meta
+ * - "[n]" => element at index 'n'
+ * - ".*" or "[*]" => every member or element
+ * - "[?name==literal]" => every member or element that is an object whose
+ *   member 'name' equals the JSON literal (numbers compare by value); name
+ *   may be written as a JSON string as well
+ *
+ *   \code
+ *   static const Json::Query plotted("[*].options.plots[?name==\"density\"]");
+ *   for (Json::Value const* plot : plotted.findAll(analyses))
+ *     draw(*plot);
+ *
+ *   Json::Query title = Json::Query().key(version).any().key("title");
+ *   \endcode
+ *
+ * Steps that do not apply, such as a member of an array or an index past
+ * the end, match nothing. A query holds no reference to a tree, so one
+ * object can be shared by threads.
+ */
+class JSON_API Query {
+public:
+  /// Matches the root.
+  Query();
+  /// \throw LogicError if path is not in the syntax above.
+  explicit Query(const String& path);
+
+  /// Appends a step to a member.
+  Query& key(String name);
+  /// Appends a step to an element.
+  Query& index(ArrayIndex index);
+  /// Appends a step to every member or element.
+  Query& any();
+  /// Appends a step to every member or element that is an object whose
+  /// member name equals value.
+  Query& where(String name, Value value);
+
+  /// The first value matched in document order, or nullptr.
+  Value const* find(const Value& root) const;
+  /// The first value matched, or the null value.
+  const Value& resolve(const Value& root) const;
+  /// Every value matched, in document order.
+  std::vector<Value const*> findAll(const Value& root) const;
+  /// Every value matched, to be modified. The containers on the way to a
+  /// match are no longer shared with copies of root afterwards, see Value.
+  std::vector<Value*> findAll(Value& root) const;
+
+private:
+  struct Step {
+    enum Kind { kindKey, kindIndex, kindAny, kindWhere };
+    Kind kind_;
+    String name_;
+    ArrayIndex index_;
+    Value value_;
+  };
+
+  template <typename Node, typename Visitor>
+  static bool walk(Node& node, Step const* step, Step const* end,
+                   Visitor& visit);
+
+  std::vector<Step> steps_;
+};
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(pop)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#endif // JSON_QUERY_H_INCLUDED
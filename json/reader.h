@@ -13,6 +13,7 @@
 #include <deque>
 #include <iosfwd>
 #include <istream>
+#include <memory>
 #include <stack>
 #include <string>
 
@@ -240,6 +241,35 @@ private:
   bool collectComments_{};
 }; // Reader
 
+/** \brief Receives a JSON document as a sequence of events.
+ *
+ * CharReader::parseEvents() calls these in document order instead of building
+ * a Value, so a document can be filtered, searched or transformed in memory
+ * bounded by its nesting depth and its longest string. Every event gets the
+ * offset of its token from the start of the document. Keys and strings are
+ * passed decoded and are only valid during the call.
+ *
+ * All events accept by default. Returning false from one stops the parse.
+ */
+class JSON_API SaxHandler {
+public:
+  virtual ~SaxHandler();
+
+  virtual bool null(ptrdiff_t offset);
+  virtual bool boolean(bool value, ptrdiff_t offset);
+  virtual bool integer(LargestInt value, ptrdiff_t offset);
+  virtual bool unsignedInteger(LargestUInt value, ptrdiff_t offset);
+  virtual bool real(double value, ptrdiff_t offset);
+  virtual bool string(char const* begin, char const* end, ptrdiff_t offset);
+
+  virtual bool startObject(ptrdiff_t offset);
+  /// Precedes the value of every member.
+  virtual bool key(char const* begin, char const* end, ptrdiff_t offset);
+  virtual bool endObject(ptrdiff_t offset);
+  virtual bool startArray(ptrdiff_t offset);
+  virtual bool endArray(ptrdiff_t offset);
+};
+
 /** Interface for reading JSON from a char array.
  */
 class JSON_API CharReader {
@@ -264,6 +294,20 @@ public:
   virtual bool parse(char const* beginDoc, char const* endDoc, Value* root,
                      String* errs) = 0;
 
+  /** \brief Read a JSON document as events for \p handler instead of into a
+   * Value.
+   *
+   * The same settings apply as for parse(), except that comments are skipped
+   * and reading stops at the first error. Readers from CharReaderBuilder
+   * stream the document; the default implementation parses it into a Value
+   * and replays that, with the offsets of the values (also for their keys).
+   *
+   * \return \c false on an error, described in \p errs, or when an event
+   * returned \c false.
+   */
+  virtual bool parseEvents(char const* beginDoc, char const* endDoc,
+                           SaxHandler& handler, String* errs);
+
   class JSON_API Factory {
   public:
     virtual ~Factory() = default;
@@ -327,6 +371,15 @@ public:
    * - `"skipBom": false or true`
    *   - If true, if the input starts with the Unicode byte order mark (BOM),
    *     it is skipped.
+   * - `"structuralIndex": false or true`
+   *   - If true, documents are first indexed with SIMD and then built from
+   *     that index, which is faster for big ones. Only plain JSON is read
+   *     that way; anything else, errors included, is read as usual, so the
+   *     result (offsets too) is the same as without this setting.
+   * - `"parseThreads": integer`
+   *   - With structuralIndex, the elements of a big top-level array are read
+   *     by up to this many threads, though not while an ArenaScope is
+   *     active, as in Document::parse().
    *
    * You can examine 'settings_` yourself to see the defaults. You can also
    * write and read them just like any JSON Value.
@@ -362,6 +415,107 @@ public:
   static void strictMode(Json::Value* settings);
 };
 
+/** \brief A tree of Values that lives in an Arena of its own.
+ *
+ * Parsing into a document, and building in it, takes memory from its arena a
+ * bump of a pointer at a time, and destroying or clear()ing it releases the
+ * whole tree at once without visiting its values. This is meant for the big
+ * documents that are loaded, read and thrown away again.
+ *
+ * Whatever is added to root() is copied into the arena. Values built within
+ * an ArenaScope for arena() live there already, which saves that copy; the
+ * legacy Reader parses into the document that way:
+ *   \code
+ *   Json::Document doc;
+ *   Json::ArenaScope scope(&doc.arena());
+ *   Json::Reader().parse(text, doc.root());
+ *   \endcode
+ * Copying a value out of the document gives an ordinary heap value. As with
+ * any Arena, references into the tree and values created in a scope for it
+ * must not be used after the document is gone, and comments are not kept.
+ */
+class JSON_API Document {
+public:
+  explicit Document(size_t blockSize = 64 * 1024);
+  Document(Document const&) = delete;
+  Document& operator=(Document const&) = delete;
+
+  Value& root() { return root_; }
+  Value const& root() const { return root_; }
+  Arena& arena() { return arena_; }
+
+  /// Replaces the tree by the one parsed with the CharReaderBuilder defaults.
+  bool parse(char const* beginDoc, char const* endDoc, String* errs = nullptr);
+  /// Replaces the tree by the one parsed by a CharReader from factory.
+  bool parse(CharReader::Factory const& factory, char const* beginDoc,
+             char const* endDoc, String* errs);
+  /// Drops the tree and releases the memory of the arena.
+  void clear();
+
+private:
+  Arena arena_;
+  Value root_;
+};
+
+/** \brief Splits a stream of JSON messages arriving in chunks and parses each
+ * message as soon as it is complete.
+ *
+ * feed() takes bytes as they come from a pipe or socket, in chunks of any
+ * size. It keeps the unfinished message and the position of its scan in
+ * between, so every byte is scanned once. Every completed top-level message
+ * is queued until next() parses it into a Value or nextEvents() hands it to
+ * a SaxHandler, with the settings of the factory given at construction.
+ *
+ *   \code
+ *   Json::PushReader messages;
+ *   while (size_t got = receive(buffer, sizeof(buffer))) {
+ *     messages.feed(buffer, buffer + got);
+ *     Json::Value message;
+ *     while (messages.available())
+ *       if (messages.next(&message, nullptr))
+ *         handle(message);
+ *   }
+ *   \endcode
+ *
+ * Messages must be objects or arrays, separated by nothing but whitespace,
+ * and without comments. Anything else between messages makes feed() fail
+ * until reset(). A message that does not parse only fails its own next().
+ */
+class JSON_API PushReader {
+public:
+  PushReader();
+  explicit PushReader(CharReader::Factory const& factory);
+  ~PushReader();
+  PushReader(PushReader const&) = delete;
+  PushReader& operator=(PushReader const&) = delete;
+
+  /// Appends a chunk, returns false if the stream is no longer valid.
+  bool feed(char const* begin, char const* end);
+  /// Number of complete messages that were not taken yet.
+  size_t available() const { return messages_.size(); }
+  /// Parses the oldest complete message into \p root.
+  bool next(Value* root, String* errs);
+  /// Reads the oldest complete message as events for \p handler.
+  bool nextEvents(SaxHandler& handler, String* errs);
+  /// Drops all buffered input and clears a failed state.
+  void reset();
+
+private:
+  void scan();
+  bool take(char const*& begin, char const*& end, String* errs);
+
+  std::unique_ptr<CharReader> reader_;
+  String buffer_;
+  std::deque<std::pair<size_t, size_t>> messages_;
+  size_t consumed_{};
+  size_t scanned_{};
+  size_t messageStart_{};
+  size_t depth_{};
+  bool inString_{};
+  bool escaped_{};
+  bool failed_{};
+};
+
 /** Consume entire stream and use its begin/end.
  * Someday we might have a real StreamReader, but for now this
  * is convenient.
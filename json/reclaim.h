@@ -0,0 +1,96 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSON_RECLAIM_H_INCLUDED
+#define JSON_RECLAIM_H_INCLUDED
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include "value.h"
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <cstdint>
+#include <memory>
+
+// Disable warning C4251: <data member>: <type> needs to have dll-interface to
+// be used by...
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(push)
+#pragma warning(disable : 4251)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#pragma pack(push)
+#pragma pack()
+
+namespace Json {
+
+/** \brief Destroys large trees on a thread of its own.
+ *
+ * Freeing a tree takes about as long as building it, which for millions of
+ * values is long enough to stall a user interface. reclaim() takes the tree
+ * out of a value instead and leaves its destruction to a background thread,
+ * started on first use:
+ *   \code
+ *   Json::Reclaimer::instance().reclaim(std::move(results));
+ *   results = newResults;
+ *   \endcode
+ * Only trees of at least nodeThreshold values (counted up to that number, so
+ * sizing a tree costs little next to freeing it) are handed over, and at most
+ * queueLimit of them wait at a time. Smaller trees, trees living in an Arena
+ * (which are freed with the arena, not value by value) and trees that find
+ * the queue full are destroyed by the caller as before. Parts that the tree
+ * shares with copies elsewhere (see Value) stay alive with those copies.
+ *
+ * stats() tells how much destruction time was moved off the callers.
+ */
+class JSON_API Reclaimer {
+public:
+  struct Stats {
+    /// Trees destroyed by the thread, and the time that took.
+    uint64_t reclaimed{0};
+    uint64_t reclaimNanoseconds{0};
+    /// Time callers spent handing those trees over, sizing included.
+    uint64_t handOffNanoseconds{0};
+    /// Trees reclaim() destroyed right away, and the time that took.
+    uint64_t destroyedInline{0};
+    uint64_t inlineNanoseconds{0};
+    /// Large trees among those, destroyed right away as the queue was full.
+    uint64_t overflowed{0};
+    /// Trees handed over but not destroyed yet.
+    uint64_t pending{0};
+  };
+
+  explicit Reclaimer(size_t nodeThreshold = 10000, size_t queueLimit = 64);
+  Reclaimer(Reclaimer const&) = delete;
+  Reclaimer& operator=(Reclaimer const&) = delete;
+  /// Waits for the trees handed over to be destroyed.
+  ~Reclaimer();
+
+  /// The reclaimer shared by the process. It is never destroyed, so it can
+  /// be used from destructors of static objects too.
+  static Reclaimer& instance();
+
+  /// Destroys the tree in value, here or on the thread; value is null then.
+  void reclaim(Value&& value);
+  /// Waits until every tree handed over so far is destroyed.
+  void flush();
+
+  void setNodeThreshold(size_t nodeThreshold);
+  void setQueueLimit(size_t queueLimit);
+  Stats stats() const;
+
+private:
+  struct State;
+
+  std::unique_ptr<State> state_;
+};
+
+} // namespace Json
+
+#pragma pack(pop)
+
+#if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+#pragma warning(pop)
+#endif // if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
+
+#endif // JSON_RECLAIM_H_INCLUDED
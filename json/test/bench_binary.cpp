@@ -0,0 +1,46 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// The binary encoding next to JSON text: size, writing with toBinary()
+// against FastWriter, and reading with parseBinary() against CharReader, on
+// a results table of as many rows as the first argument says.
+
+#include "jsontest.h"
+#include <memory>
+
+int main(int argc, char** argv) {
+  const unsigned rows = JsonTest::countArgument(argc, argv, 100000);
+  const Json::Value table = JsonTest::resultsTable(rows);
+
+  Json::String text;
+  Json::String bytes;
+  const double writeText = JsonTest::milliseconds(
+      5, [&] { text = Json::FastWriter().write(table); });
+  const double writeBinary =
+      JsonTest::milliseconds(5, [&] { bytes = Json::toBinary(table); });
+
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value fromText;
+  Json::Value fromBinary;
+  const double readText = JsonTest::milliseconds(5, [&] {
+    reader->parse(text.data(), text.data() + text.size(), &fromText, nullptr);
+  });
+  const double readBinary = JsonTest::milliseconds(5, [&] {
+    Json::parseBinary(bytes.data(), bytes.data() + bytes.size(), &fromBinary,
+                      nullptr);
+  });
+  if (!(fromText == fromBinary)) {
+    fprintf(stderr, "the binary and text forms read back differently\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("results table of %u rows      JSON text     binary\n", rows);
+  printf("size (MB)                  %12.2f %10.2f\n", text.size() / 1e6,
+         bytes.size() / 1e6);
+  printf("write (ms)                 %12.1f %10.1f\n", writeText, writeBinary);
+  printf("read (ms)                  %12.1f %10.1f\n", readText, readBinary);
+  return EXIT_SUCCESS;
+}
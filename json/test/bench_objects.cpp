@@ -0,0 +1,79 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Object storage on two corpora: options of {value, types} members, as many
+// as the first argument says, and a results table with 2.5 times as many
+// rows. Times parsing, looking every member up, and serialising.
+
+#include "jsontest.h"
+#include <memory>
+
+namespace {
+
+Json::Value optionsCorpus(unsigned count) {
+  Json::Value options(Json::objectValue);
+  std::mt19937_64 random(28);
+  for (unsigned index = 0; index < count; ++index) {
+    Json::Value& option = options["option" + std::to_string(index)];
+    for (unsigned variable = unsigned(random() % 4); variable > 0; --variable) {
+      option["value"].append("variable" + std::to_string(random() % 500));
+      option["types"].append(random() % 2 == 0 ? "scale" : "nominal");
+    }
+    option["optionKey"] = "variable";
+    option["hasTypes"] = true;
+  }
+  return options;
+}
+
+// Looks every member of every object up by name, the way analyses read
+// their options and cells.
+size_t lookUpAll(Json::Value const& value) {
+  size_t found = 0;
+  if (value.isObject()) {
+    for (Json::String const& name : value.getMemberNames()) {
+      Json::Value const& member = value[name];
+      found += 1 + lookUpAll(member);
+    }
+  } else if (value.isArray()) {
+    for (Json::Value const& element : value)
+      found += lookUpAll(element);
+  }
+  return found;
+}
+
+void measure(char const* corpus, Json::Value const& value) {
+  const Json::String text = Json::FastWriter().write(value);
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+
+  Json::Value parsed;
+  const double parse = JsonTest::milliseconds(5, [&] {
+    reader->parse(text.data(), text.data() + text.size(), &parsed, nullptr);
+  });
+  size_t found = 0;
+  const double lookUp =
+      JsonTest::milliseconds(5, [&] { found = lookUpAll(parsed); });
+  Json::String written;
+  const double serialise = JsonTest::milliseconds(
+      5, [&] { written = Json::FastWriter().write(parsed); });
+  const double styled =
+      JsonTest::milliseconds(5, [&] { written = parsed.toStyledString(); });
+
+  printf("%-24s %9.2f %9.1f %9.1f %9.1f %9.1f\n", corpus, text.size() / 1e6,
+         parse, lookUp, serialise, styled);
+  if (found == 0)
+    printf("  (nothing was looked up)\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const unsigned options = JsonTest::countArgument(argc, argv, 20000);
+  printf("%-24s %9s %9s %9s %9s %9s\n", "milliseconds", "MB", "parse",
+         "look up", "write", "styled");
+  measure("options", optionsCorpus(options));
+  measure("results table", JsonTest::resultsTable(options * 5 / 2));
+  return EXIT_SUCCESS;
+}
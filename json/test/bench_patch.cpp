@@ -0,0 +1,93 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// JSON Patch against sending whole trees: options with one checkbox
+// changed, a results table with one cell changed and with a row inserted.
+// The table has as many rows as the first argument says. Times diffing a
+// modified copy, diffing separately parsed trees, applying the patch, and
+// writing the whole tree, and compares the sizes of patch and tree.
+
+#include "jsontest.h"
+#include <memory>
+
+namespace {
+
+Json::Value optionsCorpus(unsigned count) {
+  Json::Value options(Json::objectValue);
+  std::mt19937_64 random(43);
+  for (unsigned index = 0; index < count; ++index) {
+    Json::Value& option = options["option" + std::to_string(index)];
+    if (random() % 2 == 0) {
+      option = random() % 2 == 0;
+      continue;
+    }
+    option["value"].append("variable" + std::to_string(random() % 500));
+    option["types"].append(random() % 2 == 0 ? "scale" : "nominal");
+  }
+  return options;
+}
+
+Json::Value reparse(Json::Value const& value) {
+  const Json::String text = Json::FastWriter().write(value);
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value parsed;
+  reader->parse(text.data(), text.data() + text.size(), &parsed, nullptr);
+  return parsed;
+}
+
+void measure(char const* change, Json::Value const& from,
+             Json::Value const& to) {
+  Json::Value patch;
+  const double diffCopy = JsonTest::milliseconds(
+      5, [&] { patch = Json::createPatch(from, to); });
+  const Json::Value parsedFrom = reparse(from);
+  const Json::Value parsedTo = reparse(to);
+  const double diffParsed = JsonTest::milliseconds(
+      5, [&] { patch = Json::createPatch(parsedFrom, parsedTo); });
+  bool applied = true;
+  const double apply = JsonTest::milliseconds(5, [&] {
+    Json::Value root = from;
+    applied = Json::applyPatch(&root, patch, nullptr) && applied;
+  });
+  Json::String whole;
+  const double write =
+      JsonTest::milliseconds(5, [&] { whole = Json::FastWriter().write(to); });
+
+  printf("%-20s %10zu %10zu %9.3f %9.3f %9.3f %9.3f\n", change,
+         Json::FastWriter().write(patch).size(), whole.size(), diffCopy,
+         diffParsed, apply, write);
+  if (!applied)
+    printf("  (the patch did not apply)\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const unsigned rows = JsonTest::countArgument(argc, argv, 20000);
+  printf("%-20s %10s %10s %9s %9s %9s %9s\n", "milliseconds", "patch B",
+         "whole B", "diff copy", "diff", "apply", "write");
+
+  const Json::Value options = optionsCorpus(200);
+  Json::Value checked = options;
+  for (auto const& option : options.members())
+    if (option.value.isBool()) {
+      checked[Json::String(option.name)] = !option.value.asBool();
+      break;
+    }
+  measure("options checkbox", options, checked);
+
+  const Json::Value results = JsonTest::resultsTable(rows);
+  Json::Value cell = results;
+  cell["data"][rows / 2]["mean"] = 0.5;
+  measure("results cell", results, cell);
+
+  Json::Value inserted = results;
+  Json::Value row = results["data"][0];
+  row["n"] = -1;
+  inserted["data"].insert(rows / 3, row);
+  measure("results row", results, inserted);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// The styled writers on a wide results table and on deeply nested numeric
+// tables, which mix short arrays that fit on one line with ones that do not.
+// The first argument sets the number of rows in the table.
+
+#include "jsontest.h"
+#include <sstream>
+
+namespace {
+
+// Groups within groups, depth levels deep, with rows of numbers at the
+// bottom, as in nested descriptives or posterior summaries.
+Json::Value nestedTable(unsigned depth, unsigned width,
+                        std::mt19937_64& random) {
+  Json::Value table(Json::objectValue);
+  if (depth == 0) {
+    Json::Value& rows = table["rows"];
+    for (unsigned row = 0; row < width * 2; ++row) {
+      Json::Value& cells = rows.append(Json::Value(Json::arrayValue));
+      for (unsigned cell = unsigned(random() % 12); cell > 0; --cell)
+        cells.append(double(random() % 100000) / 64);
+    }
+    table["level"] = "leaf";
+    return table;
+  }
+  table["level"] = int(depth);
+  for (unsigned group = 0; group < width; ++group)
+    table["groups"].append(nestedTable(depth - 1, width, random));
+  table["totals"].append(double(random() % 1000) / 8);
+  table["totals"].append(double(random() % 1000) / 8);
+  return table;
+}
+
+void measure(char const* corpus, Json::Value const& value) {
+  Json::String text;
+  const double styledString =
+      JsonTest::milliseconds(5, [&] { text = value.toStyledString(); });
+  const double styledWriter = JsonTest::milliseconds(
+      5, [&] { text = Json::StyledWriter().write(value); });
+  const double streamWriter = JsonTest::milliseconds(5, [&] {
+    std::ostringstream out;
+    Json::StyledStreamWriter().write(out, value);
+    text = out.str();
+  });
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = " ";
+  const double built = JsonTest::milliseconds(
+      5, [&] { text = Json::writeString(builder, value); });
+
+  printf("%-22s %9.2f %14.1f %13.1f %13.1f %9.1f\n", corpus, text.size() / 1e6,
+         styledString, styledWriter, streamWriter, built);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const unsigned scale = JsonTest::countArgument(argc, argv, 100000);
+  printf("%-22s %9s %14s %13s %13s %9s\n", "milliseconds", "MB",
+         "toStyledString", "StyledWriter", "StyledStream", "builder");
+  measure("results table", JsonTest::resultsTable(scale));
+  std::mt19937_64 random(37);
+  measure("nested numeric table", nestedTable(6, 5, random));
+  measure("deeper numeric table", nestedTable(12, 2, random));
+  return EXIT_SUCCESS;
+}
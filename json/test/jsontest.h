@@ -0,0 +1,150 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#ifndef JSONTEST_H_INCLUDED
+#define JSONTEST_H_INCLUDED
+
+#include <json/json.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+// What the tests and benchmarks in this directory share: checks that count
+// their failures, a clock, and random trees.
+
+namespace JsonTest {
+
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+/// Reports a failed check; only the first 20 are printed.
+inline bool check(bool ok, char const* expression, char const* file,
+                  int line) {
+  if (!ok && ++failures() <= 20)
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+  return ok;
+}
+
+/// What main() returns: 0 if every check passed.
+inline int result(char const* test) {
+  if (failures() != 0) {
+    fprintf(stderr, "%s: %d checks failed\n", test, failures());
+    return EXIT_FAILURE;
+  }
+  printf("%s: all checks passed\n", test);
+  return EXIT_SUCCESS;
+}
+
+/// The count given as the first argument, or fallback.
+inline unsigned countArgument(int argc, char** argv, unsigned fallback) {
+  return argc > 1 ? unsigned(strtoul(argv[1], nullptr, 10)) : fallback;
+}
+
+/// Milliseconds that run() takes, the best of repeats runs.
+template <typename Run> double milliseconds(unsigned repeats, Run&& run) {
+  double best = 0;
+  for (unsigned repeat = 0; repeat < repeats; ++repeat) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const std::chrono::duration<double, std::milli> took =
+        std::chrono::steady_clock::now() - start;
+    if (repeat == 0 || took.count() < best)
+      best = took.count();
+  }
+  return best;
+}
+
+/// A random tree of at most depth levels, with every kind of scalar,
+/// embedded nulls in strings and names, and doubles of all magnitudes.
+inline Json::Value randomTree(std::mt19937_64& random, unsigned depth) {
+  const unsigned kind = unsigned(random() % (depth == 0 ? 6 : 8));
+  switch (kind) {
+  case 0:
+    return Json::Value();
+  case 1:
+    return Json::Value(random() % 2 == 0);
+  case 2:
+    return Json::Value(Json::LargestInt(random()) >> (random() % 64));
+  case 3:
+    return Json::Value(Json::LargestUInt(random()) >> (random() % 64));
+  case 4: {
+    // Finite doubles from any bit pattern, and some short decimals.
+    if (random() % 2 == 0)
+      return Json::Value(double(int64_t(random() % 2000000) - 1000000) / 64);
+    uint64_t bits = random();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return Json::Value(std::isfinite(value) ? value : 0.5);
+  }
+  case 5: {
+    // Valid UTF-8, which the text writers keep as it is.
+    static char const* const pieces[] = {" ",  "a",        "z",
+                                         "\"", "\\",       "\n",
+                                         "\x7f", "\xc3\xa9", "\xe2\x82\xac",
+                                         "\xf0\x9f\x98\x80"};
+    Json::String text;
+    for (unsigned piece = unsigned(random() % 40); piece > 0; --piece) {
+      const size_t index = size_t(random() % 11);
+      text += index == 10 ? Json::String(1, '\0') : Json::String(pieces[index]);
+    }
+    return Json::Value(text);
+  }
+  case 6: {
+    Json::Value array(Json::arrayValue);
+    for (unsigned index = unsigned(random() % 6); index > 0; --index)
+      array.append(randomTree(random, depth - 1));
+    return array;
+  }
+  default: {
+    Json::Value object(Json::objectValue);
+    for (unsigned index = unsigned(random() % 6); index > 0; --index) {
+      Json::String name = "member" + std::to_string(random() % 20);
+      if (random() % 8 == 0)
+        name += Json::String(1, '\0') + "tail";
+      object[name] = randomTree(random, depth - 1);
+    }
+    return object;
+  }
+  }
+}
+
+/// A results table like the ones analyses send, with rows of mixed cells.
+inline Json::Value resultsTable(unsigned rows) {
+  Json::Value table(Json::objectValue);
+  table["title"] = "Descriptive Statistics";
+  table["status"] = "complete";
+  Json::Value& fields = table["schema"]["fields"];
+  for (char const* name : {"variable", "n", "mean", "sd", "min", "max"}) {
+    Json::Value& field = fields.append(Json::Value(Json::objectValue));
+    field["name"] = name;
+    field["type"] = name[0] == 'v' ? "string" : "number";
+    field["format"] = "sf:4;dp:3";
+  }
+  Json::Value& data = table["data"];
+  std::mt19937_64 random(rows);
+  for (unsigned row = 0; row < rows; ++row) {
+    Json::Value& cells = data.append(Json::Value(Json::objectValue));
+    cells["variable"] = "contNormal" + std::to_string(row % 97);
+    cells["n"] = int(random() % 1000);
+    cells["mean"] = double(random() % 1000000) / 997;
+    cells["sd"] = double(random() % 1000000) / 1009;
+    cells["min"] = -double(random() % 100000) / 7;
+    cells["max"] = double(random() % 100000) / 3;
+  }
+  return table;
+}
+
+} // namespace JsonTest
+
+#define JSONTEST_CHECK(expression)                                            \
+  JsonTest::check(bool(expression), #expression, __FILE__, __LINE__)
+
+#endif // JSONTEST_H_INCLUDED
@@ -0,0 +1,285 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// The CBOR encoding of binary.h: the examples of RFC 8949 Appendix A, typed
+// arrays, malformed input, and random trees, as many as the first argument
+// says, which must read back as they do through FastWriter and CharReader.
+
+#include "jsontest.h"
+#include <cfloat>
+#include <limits>
+#include <memory>
+
+namespace {
+
+Json::String fromHex(char const* hex) {
+  Json::String bytes;
+  for (; hex[0] && hex[1]; hex += 2)
+    bytes += char(strtoul(std::string(hex, 2).c_str(), nullptr, 16));
+  return bytes;
+}
+
+Json::String toHex(Json::String const& bytes) {
+  Json::String hex;
+  char digits[3];
+  for (char byte : bytes) {
+    snprintf(digits, sizeof(digits), "%02x", unsigned(byte) & 0xFF);
+    hex += digits;
+  }
+  return hex;
+}
+
+bool parse(Json::String const& bytes, Json::Value& value,
+           Json::String* errs = nullptr) {
+  return Json::parseBinary(bytes.data(), bytes.data() + bytes.size(), &value,
+                           errs);
+}
+
+Json::Value throughText(Json::Value const& value) {
+  const Json::String text = Json::FastWriter().write(value);
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value back;
+  Json::String errs;
+  if (!reader->parse(text.data(), text.data() + text.size(), &back, &errs))
+    fprintf(stderr, "cannot read back %s: %s", text.c_str(), errs.c_str());
+  return back;
+}
+
+bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+// value is written as hex, which reads back as value.
+void checkEncoding(Json::Value const& value, char const* hex) {
+  const Json::String bytes = Json::toBinary(value);
+  Json::Value back;
+  if (!JSONTEST_CHECK(toHex(bytes) == hex) ||
+      !JSONTEST_CHECK(Json::binarySize(value) == bytes.size()) ||
+      !JSONTEST_CHECK(parse(bytes, back) && back == value &&
+                      back.type() == value.type()))
+    fprintf(stderr, "  %s was written as %s instead of %s\n",
+            Json::FastWriter().write(value).c_str(), toHex(bytes).c_str(),
+            hex);
+}
+
+// hex reads as the value that the JSON text reads as.
+void checkDecoding(char const* hex, char const* text) {
+  Json::Value value;
+  Json::Value expected;
+  Json::Reader().parse(text, expected);
+  if (!JSONTEST_CHECK(parse(fromHex(hex), value) && value == expected &&
+                      value.type() == expected.type()))
+    fprintf(stderr, "  %s was read as %s", hex,
+            Json::FastWriter().write(value).c_str());
+}
+
+void checkAppendixA() {
+  checkEncoding(0, "00");
+  checkEncoding(1, "01");
+  checkEncoding(10, "0a");
+  checkEncoding(23, "17");
+  checkEncoding(24, "1818");
+  checkEncoding(25, "1819");
+  checkEncoding(100, "1864");
+  checkEncoding(1000, "1903e8");
+  checkEncoding(1000000, "1a000f4240");
+  checkEncoding(Json::Int64(1000000000000), "1b000000e8d4a51000");
+  checkEncoding(Json::UInt64(18446744073709551615u), "1bffffffffffffffff");
+  checkEncoding(Json::Int64(std::numeric_limits<Json::Int64>::min()),
+                "3b7fffffffffffffff");
+  checkEncoding(-1, "20");
+  checkEncoding(-10, "29");
+  checkEncoding(-100, "3863");
+  checkEncoding(-1000, "3903e7");
+
+  // Reals are never written as half floats, but single ones when exact.
+  checkEncoding(0.0, "fa00000000");
+  checkEncoding(-0.0, "fa80000000");
+  checkEncoding(1.0, "fa3f800000");
+  checkEncoding(1.1, "fb3ff199999999999a");
+  checkEncoding(1.5, "fa3fc00000");
+  checkEncoding(65504.0, "fa477fe000");
+  checkEncoding(100000.0, "fa47c35000");
+  checkEncoding(3.4028234663852886e+38, "fa7f7fffff");
+  checkEncoding(1.0e+300, "fb7e37e43c8800759c");
+  checkEncoding(5.960464477539063e-8, "fa33800000");
+  checkEncoding(0.00006103515625, "fa38800000");
+  checkEncoding(-4.0, "fac0800000");
+  checkEncoding(-4.1, "fbc010666666666666");
+  checkEncoding(std::numeric_limits<double>::infinity(),
+                "fb7ff0000000000000");
+  checkEncoding(-std::numeric_limits<double>::infinity(),
+                "fbfff0000000000000");
+
+  checkEncoding(false, "f4");
+  checkEncoding(true, "f5");
+  checkEncoding(Json::Value(), "f6");
+
+  checkEncoding("", "60");
+  checkEncoding("a", "6161");
+  checkEncoding("IETF", "6449455446");
+  checkEncoding("\"\\", "62225c");
+  checkEncoding("\xc3\xbc", "62c3bc");
+  checkEncoding("\xe6\xb0\xb4", "63e6b0b4");
+  checkEncoding("\xf0\x90\x85\x91", "64f0908591");
+
+  checkEncoding(Json::Value(Json::arrayValue), "80");
+  Json::Value array(Json::arrayValue);
+  for (int element = 1; element <= 25; ++element)
+    array.append(element);
+  checkEncoding(array, "98190102030405060708090a0b0c0d0e0f101112131415161718"
+                       "181819");
+  checkEncoding(Json::Value(Json::objectValue), "a0");
+
+  checkDecoding("83010203", "[1, 2, 3]");
+  checkDecoding("8301820203820405", "[1, [2, 3], [4, 5]]");
+  checkDecoding("a26161016162820203", R"({"a": 1, "b": [2, 3]})");
+  checkDecoding("826161a161626163", R"(["a", {"b": "c"}])");
+  checkDecoding("a56161614161626142616361436164614461656145",
+                R"({"a": "A", "b": "B", "c": "C", "d": "D", "e": "E"})");
+  // Half floats, undefined, byte strings and tags.
+  checkDecoding("f90000", "0.0");
+  checkDecoding("f93c00", "1.0");
+  checkDecoding("f93e00", "1.5");
+  checkDecoding("f97bff", "65504.0");
+  checkDecoding("f90001", "5.960464477539063e-8");
+  checkDecoding("f9c400", "-4.0");
+  checkDecoding("f7", "null");
+  checkDecoding("4401020304", "\"\\u0001\\u0002\\u0003\\u0004\"");
+  checkDecoding("c074323031332d30332d32315432303a30343a30305a",
+                "\"2013-03-21T20:04:00Z\"");
+  checkDecoding("c11a514b67b0", "1363896240");
+  checkDecoding("d74401020304", "\"\\u0001\\u0002\\u0003\\u0004\"");
+
+  Json::Value special;
+  JSONTEST_CHECK(parse(fromHex("f97c00"), special) &&
+                 special.asDouble() == std::numeric_limits<double>::infinity());
+  JSONTEST_CHECK(parse(fromHex("f97e00"), special) &&
+                 std::isnan(special.asDouble()));
+  JSONTEST_CHECK(parse(fromHex("fb7ff8000000000000"), special) &&
+                 std::isnan(special.asDouble()));
+}
+
+void checkTypedArrays() {
+  const double doubles[] = {0.0, -0.0, 1.5, 0.1, DBL_MAX, DBL_TRUE_MIN,
+                            std::numeric_limits<double>::infinity()};
+  const Json::Value doubleArray(std::begin(doubles), std::end(doubles));
+  const Json::String doubleBytes = Json::toBinary(doubleArray);
+  // Tag 86 on a byte string of 7 elements.
+  JSONTEST_CHECK(toHex(doubleBytes.substr(0, 4)) == "d8565838");
+  Json::Value back;
+  double const* begin = nullptr;
+  double const* end = nullptr;
+  if (JSONTEST_CHECK(parse(doubleBytes, back)) &&
+      JSONTEST_CHECK(back.getDoubles(&begin, &end))) {
+    JSONTEST_CHECK(end - begin == 7);
+    for (size_t index = 0; index < 7 && begin + index < end; ++index)
+      JSONTEST_CHECK(sameBits(begin[index], doubles[index]));
+  }
+  JSONTEST_CHECK(back == doubleArray);
+  // The same document as an ordinary array.
+  JSONTEST_CHECK(back == throughText(doubleArray));
+
+  // Big endian, tag 82.
+  JSONTEST_CHECK(parse(fromHex("d852503ff80000000000004000000000000000"),
+                       back) &&
+                 back.getDoubles(&begin, &end) && end - begin == 2 &&
+                 begin[0] == 1.5 && begin[1] == 2.0);
+
+#if defined(JSON_HAS_INT64)
+  const Json::Int64 ints[] = {0, -1, 1, std::numeric_limits<Json::Int64>::min(),
+                              std::numeric_limits<Json::Int64>::max()};
+  const Json::Value intArray(std::begin(ints), std::end(ints));
+  const Json::String intBytes = Json::toBinary(intArray);
+  // Tag 79 on a byte string of 5 elements.
+  JSONTEST_CHECK(toHex(intBytes.substr(0, 4)) == "d84f5828");
+  Json::Int64 const* intBegin = nullptr;
+  Json::Int64 const* intEnd = nullptr;
+  if (JSONTEST_CHECK(parse(intBytes, back)) &&
+      JSONTEST_CHECK(back.getInt64s(&intBegin, &intEnd)))
+    JSONTEST_CHECK(std::equal(intBegin, intEnd, std::begin(ints),
+                              std::end(ints)));
+  JSONTEST_CHECK(back == throughText(intArray));
+  // Big endian, tag 75.
+  JSONTEST_CHECK(parse(fromHex("d84b4800000000000000ff"), back) &&
+                 back.getInt64s(&intBegin, &intEnd) &&
+                 intEnd - intBegin == 1 && intBegin[0] == 255);
+#endif // if defined(JSON_HAS_INT64)
+
+  // Bools are an ordinary array.
+  const bool bools[] = {true, false, true};
+  checkEncoding(Json::Value(std::begin(bools), std::end(bools)), "83f5f4f5");
+
+  const double none[1] = {0.0};
+  const Json::Value empty(none, none);
+  JSONTEST_CHECK(toHex(Json::toBinary(empty)) == "d85640");
+  JSONTEST_CHECK(parse(Json::toBinary(empty), back) && back.isArray() &&
+                 back.empty());
+
+  // Byte strings of whole elements only.
+  JSONTEST_CHECK(!parse(fromHex("d856433ff800"), back));
+  JSONTEST_CHECK(!parse(fromHex("d8566161"), back));
+}
+
+void checkMalformed() {
+  Json::Value value;
+  Json::String errs;
+  // Truncated items, at every length.
+  Json::Value sample;
+  sample["name"] = "a longer string value";
+  sample["numbers"].append(1000000);
+  sample["numbers"].append(1.1);
+  sample["numbers"].append(-100);
+  const Json::String bytes = Json::toBinary(sample);
+  for (size_t length = 0; length < bytes.size(); ++length)
+    JSONTEST_CHECK(!parse(bytes.substr(0, length), value));
+  JSONTEST_CHECK(!parse(bytes + '\0', value, &errs) && !errs.empty());
+  // Indefinite lengths, reserved information, non-string keys.
+  for (char const* hex :
+       {"5f42010243030405ff", "9fff", "bf6161f5ff", "1c", "a10102", "ff"})
+    JSONTEST_CHECK(!parse(fromHex(hex), value));
+  // Lengths beyond the input.
+  for (char const* hex : {"9bffffffffffffffff", "bbffffffffffffffff",
+                          "7bffffffffffffffff", "5a00010000"})
+    JSONTEST_CHECK(!parse(fromHex(hex), value));
+  // Nesting at the limit and past it.
+  JSONTEST_CHECK(parse(Json::String(1000, '\x81') + '\x01', value));
+  JSONTEST_CHECK(!parse(Json::String(1001, '\x81') + '\x01', value, &errs));
+
+  // Flipped bits fail or read something, without reading out of bounds.
+  std::mt19937_64 random(39);
+  for (unsigned index = 0; index < 20000; ++index) {
+    Json::String flipped = bytes;
+    flipped[random() % flipped.size()] ^= char(1 << (random() % 8));
+    parse(flipped, value);
+  }
+}
+
+// A random tree reads back from its encoding as it does from its JSON text,
+// and is written the same way again.
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(20261018);
+  for (unsigned index = 0; index < count; ++index) {
+    const Json::Value tree = JsonTest::randomTree(random, 6);
+    const Json::String bytes = Json::toBinary(tree);
+    Json::Value back;
+    Json::String errs;
+    if (!JSONTEST_CHECK(Json::binarySize(tree) == bytes.size()) ||
+        !JSONTEST_CHECK(parse(bytes, back, &errs)) ||
+        !JSONTEST_CHECK(back == throughText(tree)) ||
+        !JSONTEST_CHECK(Json::toBinary(back) == bytes))
+      fprintf(stderr, "  for %s%s", Json::FastWriter().write(tree).c_str(),
+              errs.c_str());
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkAppendixA();
+  checkTypedArrays();
+  checkMalformed();
+  checkRandom(JsonTest::countArgument(argc, argv, 20000));
+  return JsonTest::result("CBOR");
+}
@@ -0,0 +1,242 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Round trips of the double conversions in json_double.cpp: the boundary
+// values, whole families of doubles, and a random sample of bit patterns and
+// digit strings whose size is the first argument.
+//
+// writeShortestDouble() is checked against the correctly rounded "%.*e" of
+// the C library: never longer than the shortest one that reads back, and
+// with the same digits when as long. parseDouble() is checked against
+// strtod(), bit for bit.
+
+#include "jsontest.h"
+#include <json/json_tool.h>
+#include <cfloat>
+#include <limits>
+#include <memory>
+
+namespace {
+
+bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+double fromBits(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// The significant digits of a decimal text, without leading and trailing
+// zeros, and the decimal exponent of the first one.
+struct Decimal {
+  std::string digits;
+  int exponent;
+};
+
+Decimal decompose(char const* text) {
+  Decimal decimal{std::string(), 0};
+  int point = -1;
+  for (; *text && *text != 'e'; ++text) {
+    if (*text == '.')
+      point = int(decimal.digits.size());
+    else if (*text >= '0' && *text <= '9')
+      decimal.digits += *text;
+  }
+  if (point < 0)
+    point = int(decimal.digits.size());
+  if (*text == 'e')
+    point += atoi(text + 1);
+  const size_t first = decimal.digits.find_first_not_of('0');
+  if (first == std::string::npos)
+    return Decimal{std::string(), 0};
+  decimal.digits.erase(0, first);
+  decimal.exponent = point - int(first) - 1;
+  decimal.digits.erase(decimal.digits.find_last_not_of('0') + 1);
+  return decimal;
+}
+
+void checkShortest(double value) {
+  char text[32];
+  char* end = Json::writeShortestDouble(value, text);
+  *end = 0;
+
+  double back = 0;
+  if (!JSONTEST_CHECK(Json::parseDouble(text, end, back) &&
+                      sameBits(back, value)) ||
+      !JSONTEST_CHECK(sameBits(strtod(text, nullptr), value))) {
+    fprintf(stderr, "  %a was written as %s\n", value, text);
+    return;
+  }
+  if (value == 0) {
+    JSONTEST_CHECK(strcmp(text, std::signbit(value) ? "-0" : "0") == 0);
+    return;
+  }
+
+  // The shortest correctly rounded decimal that reads back.
+  char printed[40];
+  int precision = 1;
+  for (; precision < 17; ++precision) {
+    snprintf(printed, sizeof(printed), "%.*e", precision - 1, value);
+    if (sameBits(strtod(printed, nullptr), value))
+      break;
+  }
+  if (precision == 17)
+    snprintf(printed, sizeof(printed), "%.16e", value);
+
+  const Decimal ours = decompose(text);
+  const Decimal theirs = decompose(printed);
+  // Next to a power of two the interval that reads back is lopsided, and a
+  // decimal that is not the nearest one may be shorter.
+  const bool sameLength = ours.digits.size() == size_t(precision);
+  if (!JSONTEST_CHECK(ours.digits.size() <= size_t(precision)) ||
+      !JSONTEST_CHECK(!sameLength || (ours.digits == theirs.digits &&
+                                      ours.exponent == theirs.exponent)))
+    fprintf(stderr, "  %a was written as %s, printf gives %s\n", value, text,
+            printed);
+
+  // The layout of "%.17g".
+  const bool scientific = ours.exponent < -4 || ours.exponent >= 17;
+  if (!JSONTEST_CHECK((strchr(text, 'e') != nullptr) == scientific))
+    fprintf(stderr, "  %a was written as %s\n", value, text);
+}
+
+void checkParse(std::string const& text) {
+  double value = 0;
+  // Ambiguous texts are left to the reader's stream.
+  if (!Json::parseDouble(text.data(), text.data() + text.size(), value))
+    return;
+  const double expected = strtod(text.c_str(), nullptr);
+  if (!JSONTEST_CHECK(sameBits(value, expected)))
+    fprintf(stderr, "  %s was parsed as %a instead of %a\n", text.c_str(),
+            value, expected);
+}
+
+// The public path: a Value written by FastWriter and read by CharReader.
+void checkValueRoundTrip(double value) {
+  const Json::String text = Json::FastWriter().write(Json::Value(value));
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value back;
+  Json::String errs;
+  if (!JSONTEST_CHECK(reader->parse(text.data(), text.data() + text.size(),
+                                    &back, &errs)) ||
+      !JSONTEST_CHECK(sameBits(back.asDouble(), value)))
+    fprintf(stderr, "  %a was written as %s", value, text.c_str());
+}
+
+void checkBoundaries() {
+  const double limits[] = {0.0,
+                           1.0,
+                           0.1,
+                           0.3,
+                           1.0 / 3,
+                           2.0 / 3,
+                           1e23,
+                           8.41e21,
+                           5e-324,
+                           9007199254740991.0,
+                           9007199254740992.0,
+                           9007199254740994.0,
+                           123456789012345678.0,
+                           1e15,
+                           1e16,
+                           1e17,
+                           1e-4,
+                           1e-5,
+                           DBL_MIN,
+                           DBL_MAX,
+                           DBL_EPSILON,
+                           DBL_TRUE_MIN,
+                           std::nextafter(DBL_MIN, 0.0),
+                           std::nextafter(DBL_MIN, 1.0),
+                           std::nextafter(DBL_MAX, 0.0),
+                           std::nextafter(1.0, 0.0),
+                           std::nextafter(1.0, 2.0),
+                           fromBits(0x000FFFFFFFFFFFFF),
+                           fromBits(0x0010000000000001),
+                           fromBits(0x7FEFFFFFFFFFFFFE),
+                           fromBits(0x4340000000000000),
+                           fromBits(0x44B52D02C7E14AF6),
+                           2.2250738585072011e-308,
+                           2.2250738585072012e-308,
+                           1.7976931348623157e308,
+                           4.9406564584124654e-324};
+  for (double value : limits)
+    for (double signedValue : {value, -value}) {
+      checkShortest(signedValue);
+      checkValueRoundTrip(signedValue);
+    }
+
+  const char* texts[] = {"0", "-0", "0.0", "1e0", "1E+2", "1.5e-3",
+                         // Clinger's fast path and just past it.
+                         "9007199254740992e22", "9007199254740993e22",
+                         "9007199254740993", "1e22", "1e23", "1e-22",
+                         // Halfway cases.
+                         "9007199254740993.0", "2.2250738585072011e-308",
+                         "2.4703282292062327e-324", "2.4703282292062328e-324",
+                         // Underflow and overflow.
+                         "1e-400", "4e-324", "2e-324", "1.8e308", "1e309",
+                         // 19 significant digits, the most parsed directly.
+                         "1234567890123456789", "0.1234567890123456789e-300",
+                         "-9999999999999999999e290"};
+  for (char const* text : texts)
+    checkParse(text);
+}
+
+// Every power of two, the extreme mantissas of every exponent, small
+// integers, and three-decimal fractions.
+void checkFamilies() {
+  for (uint64_t exponent = 0; exponent < 0x7FF; ++exponent)
+    for (uint64_t mantissa : {uint64_t(0), uint64_t(1), uint64_t(2),
+                              (uint64_t(1) << 52) - 1, (uint64_t(1) << 52) - 2,
+                              uint64_t(1) << 51})
+      checkShortest(fromBits(exponent << 52 | mantissa));
+
+  for (int integer = 0; integer <= 100000; ++integer)
+    checkShortest(double(integer));
+  for (int thousandths = 0; thousandths <= 100000; ++thousandths)
+    checkShortest(thousandths / 1000.0);
+
+  for (int exponent = -345; exponent <= 310; ++exponent)
+    for (char const* digits : {"1", "5", "9", "25", "4503599627370497"})
+      checkParse(std::string(digits) + "e" + std::to_string(exponent));
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(20261018);
+  for (unsigned index = 0; index < count; ++index) {
+    const double value = fromBits(random());
+    if (std::isfinite(value))
+      checkShortest(value);
+    if (index % 16 == 0 && std::isfinite(value))
+      checkValueRoundTrip(value);
+  }
+
+  for (unsigned index = 0; index < count; ++index) {
+    std::string text = random() % 4 == 0 ? "-" : "";
+    const unsigned integerDigits = unsigned(random() % 20) + 1;
+    for (unsigned digit = 0; digit < integerDigits; ++digit)
+      text += char('0' + random() % 10);
+    if (text.size() > 1 + (text[0] == '-') && text[text[0] == '-'] == '0')
+      text.erase(text[0] == '-', 1);
+    if (random() % 2 == 0) {
+      text += '.';
+      for (unsigned digit = unsigned(random() % 20) + 1; digit > 0; --digit)
+        text += char('0' + random() % 10);
+    }
+    if (random() % 2 == 0)
+      text += "e" + std::to_string(int(random() % 660) - 340);
+    checkParse(text);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkBoundaries();
+  checkFamilies();
+  checkRandom(JsonTest::countArgument(argc, argv, 200000));
+  return JsonTest::result("double round trips");
+}
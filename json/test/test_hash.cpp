@@ -0,0 +1,149 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Value::hash() and the shortcuts that operator==() takes with it: equal
+// values hash alike whatever the order of their members, the hash cached in
+// shared contents is forgotten when they are modified, and NaN is unequal
+// to itself even inside contents shared with a copy. The first argument is
+// the number of random trees.
+
+#include "jsontest.h"
+#include <limits>
+#include <unordered_set>
+
+namespace {
+
+const double nan = std::numeric_limits<double>::quiet_NaN();
+
+// The same tree with the members of every object in reverse order.
+Json::Value reversed(Json::Value const& value) {
+  if (value.isArray()) {
+    Json::Value result(Json::arrayValue);
+    for (Json::Value const& element : value)
+      result.append(reversed(element));
+    return result;
+  }
+  if (!value.isObject())
+    return value;
+  Json::Value result(Json::objectValue);
+  const Json::Value::Members names = value.getMemberNames();
+  for (auto name = names.rbegin(); name != names.rend(); ++name)
+    result[*name] = reversed(value[*name]);
+  return result;
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(42);
+  std::mt19937_64 again(42);
+  for (unsigned index = 0; index < count; ++index) {
+    // Built twice, so nothing is shared.
+    const Json::Value tree = JsonTest::randomTree(random, 5);
+    const Json::Value twin = JsonTest::randomTree(again, 5);
+    const Json::Value other = reversed(tree);
+    JSONTEST_CHECK(tree == twin && tree.hash() == twin.hash());
+    JSONTEST_CHECK(tree == other && tree.hash() == other.hash());
+    // And again with the hashes cached in shared contents.
+    const Json::Value copy = tree;
+    JSONTEST_CHECK(copy.hash() == other.hash() && copy == other);
+  }
+}
+
+void checkScalars() {
+  const Json::Value one(1);
+  const Json::Value unsignedOne(1u);
+  const Json::Value realOne(1.0);
+  JSONTEST_CHECK(one != unsignedOne && one != realOne &&
+                 unsignedOne != realOne);
+  JSONTEST_CHECK(one.hash() != unsignedOne.hash() &&
+                 one.hash() != realOne.hash() &&
+                 unsignedOne.hash() != realOne.hash());
+  JSONTEST_CHECK(Json::Value(-0.0) == Json::Value(0.0) &&
+                 Json::Value(-0.0).hash() == Json::Value(0.0).hash());
+  JSONTEST_CHECK(Json::Value("a\0b", "a\0b" + 3).hash() !=
+                 Json::Value("a\0c", "a\0c" + 3).hash());
+  JSONTEST_CHECK(Json::Value().hash() == Json::Value(Json::nullValue).hash());
+}
+
+// A typed array hashes as the same array made of Values.
+void checkTyped() {
+  const double doubles[] = {0.5, -0.0, 3};
+  const Json::Value typed(std::begin(doubles), std::end(doubles));
+  Json::Value generic(Json::arrayValue);
+  for (double real : doubles)
+    generic.append(real);
+  JSONTEST_CHECK(typed == generic && typed.hash() == generic.hash());
+  const bool bools[] = {true, false};
+  Json::Value boolArray(Json::arrayValue);
+  boolArray.append(true);
+  boolArray.append(false);
+  JSONTEST_CHECK(Json::Value(std::begin(bools), std::end(bools)).hash() ==
+                 boolArray.hash());
+}
+
+// The hash cached in shared contents goes when a copy is modified.
+void checkModified() {
+  Json::Value tree = JsonTest::resultsTable(50);
+  const Json::Value copy = tree;
+  const std::uint64_t before = copy.hash();
+  tree["data"][10]["mean"] = 0.25;
+  JSONTEST_CHECK(copy.hash() == before && tree.hash() != before &&
+                 tree != copy);
+  tree["data"][10]["mean"] = copy["data"][10]["mean"];
+  JSONTEST_CHECK(tree.hash() == before && tree == copy);
+
+  // Values that hash apart are unequal without a look inside.
+  Json::Value changed = copy;
+  changed["title"] = "other";
+  const Json::Value changedCopy = changed;
+  JSONTEST_CHECK(changedCopy.hash() != copy.hash() && changedCopy != copy);
+
+  std::unordered_set<Json::Value> keys{copy, changed, tree};
+  JSONTEST_CHECK(keys.size() == 2 && keys.count(changedCopy) == 1);
+}
+
+// NaN is unequal to itself, so is anything holding one, even a copy that
+// shares its contents.
+void checkNaN() {
+  Json::Value array(Json::arrayValue);
+  array.append(1);
+  array.append(nan);
+  const Json::Value arrayCopy = array;
+  JSONTEST_CHECK(array != arrayCopy && arrayCopy != arrayCopy &&
+                 array.hash() == arrayCopy.hash());
+
+  Json::Value object;
+  object["a"]["b"][2] = nan;
+  object["c"] = 1;
+  Json::Value objectCopy = object;
+  JSONTEST_CHECK(object != objectCopy && !(objectCopy == objectCopy));
+  // Known in the shared contents now, and forgotten when they change.
+  JSONTEST_CHECK(object != objectCopy);
+  objectCopy["a"]["b"][2] = 0.5;
+  const Json::Value second = objectCopy;
+  JSONTEST_CHECK(objectCopy == second && second == objectCopy &&
+                 object != objectCopy);
+
+  const double doubles[] = {0.5, nan};
+  const Json::Value typed(std::begin(doubles), std::end(doubles));
+  const Json::Value typedCopy = typed;
+  JSONTEST_CHECK(typed != typedCopy && typedCopy != typed);
+
+  // Without NaN the shared contents are equal as they are.
+  const double finite[] = {0.5, 1.5};
+  const Json::Value finiteArray(std::begin(finite), std::end(finite));
+  const Json::Value finiteCopy = finiteArray;
+  JSONTEST_CHECK(finiteArray == finiteCopy && finiteCopy == finiteCopy);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkRandom(JsonTest::countArgument(argc, argv, 5000));
+  checkScalars();
+  checkTyped();
+  checkModified();
+  checkNaN();
+  return JsonTest::result("hashes");
+}
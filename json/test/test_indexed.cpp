@@ -0,0 +1,242 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// The indexed form (see indexed.h): random trees, as many as the first
+// argument says, are converted and read back, every accessor of every view
+// must give what the same accessor of the Value gives, and a file must read
+// as the bytes do. Damaged documents must be refused on opening or fail
+// like a type error, but never read out of bounds; run under ASan too.
+
+#include "jsontest.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+// Equal down to the types and the bits of doubles.
+bool sameTree(Json::Value const& a, Json::Value const& b) {
+  if (a.type() != b.type())
+    return false;
+  if (a.isDouble())
+    return sameBits(a.asDouble(), b.asDouble());
+  if (a.isArray()) {
+    if (a.size() != b.size())
+      return false;
+    for (Json::ArrayIndex index = 0; index < a.size(); ++index)
+      if (!sameTree(a[index], b[index]))
+        return false;
+    return true;
+  }
+  if (a.isObject()) {
+    if (a.getMemberNames() != b.getMemberNames())
+      return false;
+    for (auto const& member : a.members())
+      if (!sameTree(member.value,
+                    *b.find(member.name.data(),
+                            member.name.data() + member.name.size())))
+        return false;
+    return true;
+  }
+  return a == b;
+}
+
+// What an accessor gives, or that it threw.
+template <typename Access> Json::String outcome(Access&& access) {
+  try {
+    return "= " + access();
+  } catch (Json::LogicError const&) {
+    return "threw";
+  }
+}
+
+template <typename T> Json::String show(T value) {
+  return std::to_string(value);
+}
+Json::String show(double value) {
+  char text[40];
+  snprintf(text, sizeof(text), "%a", value);
+  return text;
+}
+Json::String show(Json::String const& value) { return value; }
+Json::String show(bool value) { return value ? "true" : "false"; }
+
+#define CHECK_SAME_ACCESS(expression)                                        \
+  JSONTEST_CHECK(outcome([&] { return show(indexed.expression); }) ==        \
+                 outcome([&] { return show(value.expression); }))
+
+// Every accessor of indexed against value, and so on down the tree.
+void checkView(Json::IndexedValue const& indexed, Json::Value const& value) {
+  if (!JSONTEST_CHECK(indexed.type() == value.type()))
+    return;
+  JSONTEST_CHECK(indexed.isNull() == value.isNull() &&
+                 indexed.isBool() == value.isBool() &&
+                 indexed.isString() == value.isString() &&
+                 indexed.isArray() == value.isArray() &&
+                 indexed.isObject() == value.isObject());
+  JSONTEST_CHECK(indexed.size() == value.size() &&
+                 indexed.empty() == value.empty());
+
+  CHECK_SAME_ACCESS(asBool());
+  CHECK_SAME_ACCESS(asInt());
+  CHECK_SAME_ACCESS(asUInt());
+  CHECK_SAME_ACCESS(asInt64());
+  CHECK_SAME_ACCESS(asUInt64());
+  CHECK_SAME_ACCESS(asLargestInt());
+  CHECK_SAME_ACCESS(asLargestUInt());
+  CHECK_SAME_ACCESS(asDouble());
+  CHECK_SAME_ACCESS(asString());
+
+  char const* begin = nullptr;
+  char const* end = nullptr;
+  JSONTEST_CHECK(indexed.getString(&begin, &end) == value.isString());
+  if (value.isString())
+    JSONTEST_CHECK(Json::String(begin, end) == value.asString());
+  JSONTEST_CHECK(sameTree(indexed.toValue(), value));
+
+  if (value.isArray()) {
+    for (Json::ArrayIndex index = 0; index < value.size(); ++index)
+      checkView(indexed[index], value[index]);
+    // Past the end.
+    JSONTEST_CHECK(indexed[value.size()].isNull());
+  } else if (value.isObject()) {
+    JSONTEST_CHECK(indexed.getMemberNames() == value.getMemberNames());
+    Json::ArrayIndex position = 0;
+    for (auto const& member : value.members()) {
+      const Json::String name(member.name);
+      char const* nameEnd;
+      char const* nameBegin = indexed.memberName(position, &nameEnd);
+      JSONTEST_CHECK(Json::String(nameBegin, nameEnd) == name);
+      Json::IndexedValue found;
+      JSONTEST_CHECK(indexed.find(name.data(), name.data() + name.size(),
+                                  &found) &&
+                     indexed.isMember(name));
+      JSONTEST_CHECK(found.type() == member.value.type() &&
+                     indexed[name].type() == member.value.type());
+      checkView(indexed.member(position), member.value);
+      ++position;
+    }
+    // Missing members, one of them a prefix of the others.
+    for (char const* missing : {"member", "absent", ""}) {
+      Json::IndexedValue found;
+      JSONTEST_CHECK(indexed.find(missing, missing + strlen(missing),
+                                  &found) == value.isMember(missing) &&
+                     indexed.isMember(missing) == value.isMember(missing) &&
+                     indexed[missing].type() == value[missing].type());
+    }
+  } else {
+    // Lookups in scalars fail alike.
+    CHECK_SAME_ACCESS(operator[](Json::ArrayIndex(0)).isNull());
+    CHECK_SAME_ACCESS(operator[]("member1").isNull());
+  }
+}
+
+// Reads every part of a view, as a damaged document must allow.
+void readAll(Json::IndexedValue const& view) {
+  char const* begin;
+  char const* end;
+  view.getString(&begin, &end);
+  const Json::ArrayIndex count = view.size();
+  for (Json::ArrayIndex index = 0; index < count && index < 64; ++index) {
+    if (view.isArray()) {
+      readAll(view[index]);
+    } else {
+      view.memberName(index, &end);
+      readAll(view.member(index));
+    }
+  }
+  view.toValue();
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(40);
+  for (unsigned index = 0; index < count; ++index) {
+    const Json::Value tree = JsonTest::randomTree(random, 5);
+    Json::String bytes = Json::toIndexed(tree);
+    {
+      const Json::IndexedDocument document(bytes);
+      if (!JSONTEST_CHECK(document.isOpen()))
+        continue;
+      checkView(document.root(), tree);
+    }
+
+    // A few bytes changed, after the header that open checks.
+    if (bytes.size() <= 24)
+      continue;
+    for (unsigned change = 1 + unsigned(random() % 3); change > 0; --change)
+      bytes[24 + size_t(random() % (bytes.size() - 24))] = char(random());
+    const Json::IndexedDocument damaged(bytes);
+    try {
+      readAll(damaged.root());
+    } catch (Json::LogicError const&) {
+    }
+  }
+}
+
+// Documents that are refused on opening.
+void checkRefused() {
+  const Json::String bytes = Json::toIndexed(JsonTest::resultsTable(10));
+  for (Json::String const& bad :
+       {Json::String(), Json::String("[1, 2]"), bytes.substr(0, 20),
+        bytes.substr(0, bytes.size() - 8), bytes + Json::String(8, '\0')}) {
+    const Json::IndexedDocument document(bad);
+    JSONTEST_CHECK(!document.isOpen() && document.root().isNull());
+  }
+}
+
+// A file reads as the bytes it holds, until it is closed.
+void checkFile() {
+  const Json::Value table = JsonTest::resultsTable(200);
+  char const* const path = "test_indexed.jsonidx";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << Json::toIndexed(table);
+  }
+  Json::IndexedDocument document;
+  Json::String errs;
+  if (JSONTEST_CHECK(document.open(path, &errs))) {
+    checkView(document.root(), table);
+    JSONTEST_CHECK(document.root()["data"][150]["variable"].asString() ==
+                   table["data"][150]["variable"].asString());
+  }
+  document.close();
+  JSONTEST_CHECK(!document.isOpen() && document.root().isNull() &&
+                 document.root()["data"].isNull());
+  std::remove(path);
+
+  JSONTEST_CHECK(!document.open("test_indexed.missing", &errs) &&
+                 !errs.empty() && !document.isOpen());
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "{\"not\": \"indexed\"}";
+  }
+  errs.clear();
+  JSONTEST_CHECK(!document.open(path, &errs) && !errs.empty());
+  std::remove(path);
+}
+
+// Empty containers and scalars, which empty() tells apart.
+void checkEmpty() {
+  for (Json::Value const& value :
+       {Json::Value(), Json::Value(Json::arrayValue),
+        Json::Value(Json::objectValue), Json::Value(""), Json::Value(0),
+        Json::Value(false)}) {
+    const Json::IndexedDocument document(Json::toIndexed(value));
+    JSONTEST_CHECK(document.root().empty() == value.empty() &&
+                   document.root().type() == value.type());
+  }
+  JSONTEST_CHECK(Json::IndexedValue().empty());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkRandom(JsonTest::countArgument(argc, argv, 5000));
+  checkRefused();
+  checkFile();
+  checkEmpty();
+  return JsonTest::result("indexed documents");
+}
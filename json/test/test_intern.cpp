@@ -0,0 +1,152 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Interned member names (see Value): names of 8 to 32 bytes are shared by
+// every object, shorter and longer ones are not, and either way names with
+// embedded nulls keep their length through every accessor. Objects built
+// with interned, static and copied names are equal and find each other's
+// members. Threads, as many as the first argument says, build objects with
+// the same names at once; meant to be run under TSan as well.
+
+#include "jsontest.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+Json::Value parse(Json::String const& text) {
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value root;
+  JSONTEST_CHECK(
+      reader->parse(text.data(), text.data() + text.size(), &root, nullptr));
+  return root;
+}
+
+// The name of the first member of object, which points into it.
+std::string_view firstName(Json::Value const& object) {
+  return (*object.members().begin()).name;
+}
+
+// Only names of 8 to 32 bytes are shared between objects.
+void checkShared() {
+  for (unsigned length : {1U, 7U, 8U, 20U, 32U, 33U, 100U}) {
+    const Json::String name(length, 'n');
+    const Json::Value parsed = parse("{\"" + name + "\": 1}");
+    Json::Value built;
+    built[name] = 2;
+    const bool shared = firstName(parsed).data() == firstName(built).data();
+    JSONTEST_CHECK(shared == (length >= 8 && length <= 32));
+    JSONTEST_CHECK(parsed.isMember(name) && built.isMember(name) &&
+                   firstName(parsed) == name);
+  }
+}
+
+// Every accessor of a name gives all of its bytes.
+void checkEmbeddedNull() {
+  for (Json::String name :
+       {Json::String("abc\0defghij", 11), Json::String("\0\0\0\0\0\0\0\0", 8),
+        Json::String("a\0b", 3), Json::String(40, '\0')}) {
+    Json::Value object;
+    object[name] = 1;
+    const Json::Value copy = object;
+    Json::Value::const_iterator it = copy.begin();
+    JSONTEST_CHECK(it.key().asString() == name && it.name() == name);
+    char const* end;
+    char const* begin = it.memberName(&end);
+    JSONTEST_CHECK(Json::String(begin, end) == name);
+    JSONTEST_CHECK(firstName(copy) == name &&
+                   copy.getMemberNames() == Json::Value::Members{name});
+    JSONTEST_CHECK(copy.find(name.data(), name.data() + name.size()) &&
+                   copy[name] == 1);
+    // The name cut at its first null is another member.
+    JSONTEST_CHECK(!copy.isMember(name.c_str()) ||
+                   strlen(name.c_str()) == name.size());
+  }
+}
+
+// Objects whose names were interned, static or copied are all alike.
+void checkLookups() {
+  static char const staticName[] = "staticMemberName";
+  const Json::String longName(50, 'L');
+  Json::Value withStatic;
+  withStatic[Json::StaticString(staticName)] = 1;
+  withStatic[longName] = 2;
+  const Json::Value parsed =
+      parse("{\"staticMemberName\": 1, \"" + longName + "\": 2}");
+  Json::Value built;
+  built[Json::String(staticName)] = 1;
+  built[longName] = 2;
+  Json::Value const* const objects[] = {&withStatic, &parsed, &built};
+  for (Json::Value const* object : objects) {
+    JSONTEST_CHECK(*object == withStatic && object->hash() == parsed.hash());
+    // Looked up with a name in another buffer.
+    const Json::String name(staticName);
+    JSONTEST_CHECK(object->isMember(name) && (*object)[name] == 1 &&
+                   object->find(name.data(), name.data() + name.size()));
+  }
+  Json::Value removed = parsed;
+  Json::Value member;
+  JSONTEST_CHECK(removed.removeMember(Json::String(staticName), &member) &&
+                 member == 1 && !removed.isMember(staticName) &&
+                 parsed.isMember(staticName));
+  // Sorted as the bytes are, wherever they are kept.
+  JSONTEST_CHECK(built.getMemberNames() == parsed.getMemberNames() &&
+                 withStatic.getMemberNames() == parsed.getMemberNames());
+}
+
+// More names than the table holds: the later ones are copied, and all
+// are found.
+void checkMany() {
+  Json::Value object(Json::objectValue);
+  const unsigned count = 70000;
+  for (unsigned index = 0; index < count; ++index)
+    object["distinctName" + std::to_string(index)] = index;
+  JSONTEST_CHECK(object.size() == count);
+  for (unsigned index = 0; index < count; index += 7)
+    JSONTEST_CHECK(object["distinctName" + std::to_string(index)] == index);
+  const Json::Value copy = object;
+  Json::Value rebuilt(Json::objectValue);
+  for (auto const& member : copy.members())
+    rebuilt[Json::String(member.name)] = member.value;
+  JSONTEST_CHECK(rebuilt == object);
+}
+
+// Threads building objects with the same names at once get the same
+// shared names.
+void checkThreads(unsigned threadCount) {
+  const unsigned names = 2000;
+  std::vector<Json::Value> objects(threadCount);
+  std::vector<std::thread> threads;
+  for (unsigned thread = 0; thread < threadCount; ++thread)
+    threads.emplace_back([&objects, thread] {
+      Json::Value& object = objects[thread];
+      for (unsigned index = 0; index < names; ++index) {
+        const unsigned name = (index * 7 + thread * 13) % names;
+        object["threadMember" + std::to_string(name)] = name;
+      }
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+  for (unsigned thread = 1; thread < threadCount; ++thread) {
+    JSONTEST_CHECK(objects[thread] == objects[0]);
+    JSONTEST_CHECK(firstName(objects[thread]).data() ==
+                   firstName(objects[0]).data());
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkShared();
+  checkEmbeddedNull();
+  checkLookups();
+  checkThreads(JsonTest::countArgument(argc, argv, 8));
+  // Last, as it fills the table.
+  checkMany();
+  return JsonTest::result("interned names");
+}
@@ -0,0 +1,223 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// LazyDocument against the Value that CharReaderBuilder reads with its
+// defaults: random trees, as many as the first argument says, written as
+// text and some of them spoilt, are read both ways. Every document read
+// lazily must be read eagerly too, and every accessor of every view must
+// give what the same accessor of the Value gives, errors included.
+
+#include "jsontest.h"
+#include <memory>
+
+namespace {
+
+bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+// Equal down to the types, the bits of doubles and the offsets.
+bool sameTree(Json::Value const& a, Json::Value const& b) {
+  if (a.type() != b.type() || a.getOffsetStart() != b.getOffsetStart() ||
+      a.getOffsetLimit() != b.getOffsetLimit())
+    return false;
+  if (a.isDouble())
+    return sameBits(a.asDouble(), b.asDouble());
+  if (a.isArray()) {
+    if (a.size() != b.size())
+      return false;
+    for (Json::ArrayIndex index = 0; index < a.size(); ++index)
+      if (!sameTree(a[index], b[index]))
+        return false;
+    return true;
+  }
+  if (a.isObject()) {
+    if (a.getMemberNames() != b.getMemberNames())
+      return false;
+    for (auto const& member : a.members())
+      if (!sameTree(member.value,
+                    *b.find(member.name.data(),
+                            member.name.data() + member.name.size())))
+        return false;
+    return true;
+  }
+  return a == b;
+}
+
+// What an accessor gives, or that it threw.
+template <typename Access> Json::String outcome(Access&& access) {
+  try {
+    return "= " + access();
+  } catch (Json::LogicError const&) {
+    return "threw";
+  }
+}
+
+template <typename T> Json::String show(T value) {
+  return std::to_string(value);
+}
+Json::String show(double value) {
+  char text[40];
+  snprintf(text, sizeof(text), "%a", value);
+  return text;
+}
+Json::String show(Json::String const& value) { return value; }
+Json::String show(bool value) { return value ? "true" : "false"; }
+
+#define CHECK_SAME_ACCESS(expression)                                        \
+  JSONTEST_CHECK(outcome([&] { return show(lazy.expression); }) ==           \
+                 outcome([&] { return show(eager.expression); }))
+
+// Every accessor of lazy against eager, and so on down the tree.
+void checkView(Json::LazyValue const& lazy, Json::Value const& eager,
+               Json::String const& text) {
+  if (!JSONTEST_CHECK(lazy.type() == eager.type()))
+    return;
+  JSONTEST_CHECK(lazy.isNull() == eager.isNull() &&
+                 lazy.isBool() == eager.isBool() &&
+                 lazy.isString() == eager.isString() &&
+                 lazy.isArray() == eager.isArray() &&
+                 lazy.isObject() == eager.isObject());
+  JSONTEST_CHECK(lazy.size() == eager.size() &&
+                 lazy.empty() == eager.empty());
+
+  CHECK_SAME_ACCESS(asBool());
+  CHECK_SAME_ACCESS(asInt());
+  CHECK_SAME_ACCESS(asUInt());
+  CHECK_SAME_ACCESS(asInt64());
+  CHECK_SAME_ACCESS(asUInt64());
+  CHECK_SAME_ACCESS(asLargestInt());
+  CHECK_SAME_ACCESS(asLargestUInt());
+  CHECK_SAME_ACCESS(asDouble());
+  CHECK_SAME_ACCESS(asString());
+
+#if !JSON_USE_LEAN_VALUE
+  // The text of the value is what the offsets of the Value span.
+  char const* begin;
+  char const* end;
+  lazy.getText(&begin, &end);
+  JSONTEST_CHECK(Json::String(begin, end) ==
+                 text.substr(size_t(eager.getOffsetStart()),
+                             size_t(eager.getOffsetLimit() -
+                                    eager.getOffsetStart())));
+#else
+  (void)text;
+#endif
+  JSONTEST_CHECK(sameTree(lazy.toValue(), eager));
+
+  if (eager.isArray()) {
+    for (Json::ArrayIndex index = 0; index < eager.size(); ++index)
+      checkView(lazy[index], eager[index], text);
+    // Past the end.
+    JSONTEST_CHECK(lazy[eager.size()].isNull() && eager[eager.size()].isNull());
+  } else if (eager.isObject()) {
+    JSONTEST_CHECK(lazy.getMemberNames() == eager.getMemberNames());
+    Json::ArrayIndex position = 0;
+    for (auto const& member : eager.members()) {
+      const Json::String name(member.name);
+      char const* nameEnd;
+      char const* nameBegin = lazy.memberName(position, &nameEnd);
+      JSONTEST_CHECK(Json::String(nameBegin, nameEnd) == name);
+      Json::LazyValue found;
+      JSONTEST_CHECK(lazy.find(name.data(), name.data() + name.size(),
+                               &found) &&
+                     lazy.isMember(name) && eager.isMember(name));
+      JSONTEST_CHECK(found.type() == member.value.type() &&
+                     lazy[name].type() == eager[name].type());
+      checkView(lazy.member(position), member.value, text);
+      ++position;
+    }
+    // Missing members, one of them a prefix of the others.
+    for (char const* missing : {"member", "absent", ""}) {
+      Json::LazyValue found;
+      JSONTEST_CHECK(lazy.find(missing, missing + strlen(missing), &found) ==
+                         eager.isMember(missing) &&
+                     lazy.isMember(missing) == eager.isMember(missing) &&
+                     lazy[missing].type() == eager[missing].type());
+    }
+  } else {
+    // Lookups in scalars fail alike.
+    CHECK_SAME_ACCESS(operator[](Json::ArrayIndex(0)).isNull());
+    CHECK_SAME_ACCESS(operator[]("member1").isNull());
+  }
+}
+
+// One of the writers' layouts of a random tree, at times spoilt.
+Json::String randomText(std::mt19937_64& random) {
+  const Json::Value tree = JsonTest::randomTree(random, 5);
+  Json::String text = random() % 2 == 0 ? Json::FastWriter().write(tree)
+                                        : tree.toStyledString();
+  static char const* const insertions[] = {
+      "// comment\n", "/* c */", ",", "]", "}", "\"", "01", "1.", "-", "x",
+      "\xEF\xBB\xBF", "\t", "\"\\u00e9\"", "1e400", "null", "{\"a\":1}"};
+  if (random() % 3 == 0) {
+    const size_t at = size_t(random() % text.size());
+    switch (random() % 3) {
+    case 0:
+      text.insert(at, insertions[random() % (sizeof(insertions) /
+                                             sizeof(insertions[0]))]);
+      break;
+    case 1:
+      text.erase(at, 1);
+      break;
+    default:
+      text.resize(at);
+    }
+  }
+  if (random() % 8 == 0)
+    text = "\xEF\xBB\xBF" + text;
+  return text;
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(47);
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  unsigned lazilyRead = 0;
+  for (unsigned index = 0; index < count; ++index) {
+    const Json::String text = randomText(random);
+    Json::LazyDocument document;
+    Json::String lazyErrs;
+    if (!document.parse(text.data(), text.data() + text.size(), &lazyErrs)) {
+      JSONTEST_CHECK(!document.isParsed() && document.root().isNull() &&
+                     !lazyErrs.empty());
+      continue;
+    }
+    ++lazilyRead;
+    Json::Value eager;
+    Json::String errs;
+    if (!JSONTEST_CHECK(reader->parse(text.data(), text.data() + text.size(),
+                                      &eager, &errs))) {
+      fprintf(stderr, "  only read lazily: %s\n", text.c_str());
+      continue;
+    }
+    // Offsets count from after a byte order mark.
+    checkView(document.root(), eager,
+              text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? text.substr(3)
+                                                        : text);
+  }
+  // Most documents are not spoilt.
+  JSONTEST_CHECK(lazilyRead > count / 2);
+}
+
+// The document keeps its own copy of the text, or takes the string.
+void checkOwnership() {
+  Json::String text = R"({"b": [1, 2.5, "three"], "a": {"x": null}})";
+  Json::LazyDocument copied;
+  JSONTEST_CHECK(copied.parse(text.data(), text.data() + text.size(), nullptr));
+  Json::LazyDocument taken;
+  JSONTEST_CHECK(taken.parse(text, nullptr));
+  text.assign(text.size(), ' ');
+  JSONTEST_CHECK(copied.root()["b"][2].asString() == "three" &&
+                 taken.root()["a"].getMemberNames().size() == 1);
+  taken.clear();
+  JSONTEST_CHECK(!taken.isParsed() && taken.root().isNull());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkRandom(JsonTest::countArgument(argc, argv, 5000));
+  checkOwnership();
+  return JsonTest::result("lazy documents");
+}
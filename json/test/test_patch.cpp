@@ -0,0 +1,252 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// JSON Patch: the examples of RFC 6902 Appendix A, a few errors, and
+// createPatch() followed by applyPatch() on option and result pairs and on
+// random trees, as many as the first argument says.
+
+#include "jsontest.h"
+#include <memory>
+
+namespace {
+
+Json::Value parse(char const* text) {
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value value;
+  Json::String errs;
+  if (!reader->parse(text, text + strlen(text), &value, &errs))
+    fprintf(stderr, "cannot parse test input %s: %s", text, errs.c_str());
+  return value;
+}
+
+// Applies patch to document and compares with expected, or expects an error
+// if expected is null.
+void checkExample(char const* section, char const* document,
+                  char const* patch, char const* expected) {
+  const Json::Value original = parse(document);
+  Json::Value root = original;
+  Json::String errs;
+  const bool applied = Json::applyPatch(&root, parse(patch), &errs);
+  if (expected) {
+    if (!JSONTEST_CHECK(applied) || !JSONTEST_CHECK(root == parse(expected)))
+      fprintf(stderr, "  in %s: %s", section, errs.c_str());
+  } else {
+    // The document stays as it was.
+    if (!JSONTEST_CHECK(!applied) || !JSONTEST_CHECK(root == original) ||
+        !JSONTEST_CHECK(errs.compare(0, 2, "* ") == 0))
+      fprintf(stderr, "  in %s\n", section);
+  }
+}
+
+void checkAppendixA() {
+  checkExample("A.1", R"({"foo": "bar"})",
+               R"([{"op": "add", "path": "/baz", "value": "qux"}])",
+               R"({"baz": "qux", "foo": "bar"})");
+  checkExample("A.2", R"({"foo": ["bar", "baz"]})",
+               R"([{"op": "add", "path": "/foo/1", "value": "qux"}])",
+               R"({"foo": ["bar", "qux", "baz"]})");
+  checkExample("A.3", R"({"baz": "qux", "foo": "bar"})",
+               R"([{"op": "remove", "path": "/baz"}])", R"({"foo": "bar"})");
+  checkExample("A.4", R"({"foo": ["bar", "qux", "baz"]})",
+               R"([{"op": "remove", "path": "/foo/1"}])",
+               R"({"foo": ["bar", "baz"]})");
+  checkExample("A.5", R"({"baz": "qux", "foo": "bar"})",
+               R"([{"op": "replace", "path": "/baz", "value": "boo"}])",
+               R"({"baz": "boo", "foo": "bar"})");
+  checkExample(
+      "A.6",
+      R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {"corge": "grault"}})",
+      R"([{"op": "move", "from": "/foo/waldo", "path": "/qux/thud"}])",
+      R"({"foo": {"bar": "baz"}, "qux": {"corge": "grault", "thud": "fred"}})");
+  checkExample("A.7", R"({"foo": ["all", "grass", "cows", "eat"]})",
+               R"([{"op": "move", "from": "/foo/1", "path": "/foo/3"}])",
+               R"({"foo": ["all", "cows", "eat", "grass"]})");
+  checkExample("A.8", R"({"baz": "qux", "foo": ["a", 2, "c"]})",
+               R"([{"op": "test", "path": "/baz", "value": "qux"},
+                   {"op": "test", "path": "/foo/1", "value": 2}])",
+               R"({"baz": "qux", "foo": ["a", 2, "c"]})");
+  checkExample("A.9", R"({"baz": "qux"})",
+               R"([{"op": "test", "path": "/baz", "value": "bar"}])",
+               nullptr);
+  checkExample(
+      "A.10", R"({"foo": "bar"})",
+      R"([{"op": "add", "path": "/child", "value": {"grandchild": {}}}])",
+      R"({"foo": "bar", "child": {"grandchild": {}}})");
+  checkExample(
+      "A.11", R"({"foo": "bar"})",
+      R"([{"op": "add", "path": "/baz", "value": "qux", "xyz": 123}])",
+      R"({"foo": "bar", "baz": "qux"})");
+  checkExample("A.12", R"({"foo": "bar"})",
+               R"([{"op": "add", "path": "/baz/bat", "value": "qux"}])",
+               nullptr);
+  // A.13, an operation with two "op" members, cannot be told apart once
+  // parsed into a Value, which keeps the last one.
+  checkExample("A.14", R"({"/": 9, "~1": 10})",
+               R"([{"op": "test", "path": "/~01", "value": 10}])",
+               R"({"/": 9, "~1": 10})");
+  checkExample("A.15", R"({"/": 9, "~1": 10})",
+               R"([{"op": "test", "path": "/~01", "value": "10"}])",
+               nullptr);
+  checkExample("A.16", R"({"foo": ["bar"]})",
+               R"([{"op": "add", "path": "/foo/-", "value": ["abc", "def"]}])",
+               R"({"foo": ["bar", ["abc", "def"]]})");
+}
+
+void checkErrors() {
+  // Later operations see the earlier ones, and one failure undoes them all.
+  checkExample("rollback", R"({"a": 1})",
+               R"([{"op": "add", "path": "/b", "value": 2},
+                   {"op": "remove", "path": "/c"}])",
+               nullptr);
+  checkExample("not an array", R"({"a": 1})",
+               R"({"op": "remove", "path": "/a"})", nullptr);
+  checkExample("unknown op", R"({"a": 1})",
+               R"([{"op": "frobnicate", "path": "/a"}])", nullptr);
+  checkExample("index past the end", R"({"a": [1, 2]})",
+               R"([{"op": "add", "path": "/a/3", "value": 0}])", nullptr);
+  checkExample("leading zero", R"({"a": [1, 2]})",
+               R"([{"op": "replace", "path": "/a/01", "value": 0}])", nullptr);
+  checkExample("bad escape", R"({"a": 1})",
+               R"([{"op": "remove", "path": "/~2"}])", nullptr);
+  checkExample("move into itself", R"({"a": {"b": 1}})",
+               R"([{"op": "move", "from": "/a", "path": "/a/b/c"}])", nullptr);
+  checkExample("numbers by value", R"({"a": 1})",
+               R"([{"op": "test", "path": "/a", "value": 1.0},
+                   {"op": "copy", "from": "/a", "path": "/b"}])",
+               R"({"a": 1, "b": 1})");
+  checkExample("whole document", R"({"a": 1})",
+               R"([{"op": "replace", "path": "", "value": [1]}])", "[1]");
+}
+
+// createPatch(from, to) applied to from gives to.
+void checkRoundTrip(Json::Value const& from, Json::Value const& to,
+                    char const* what) {
+  const Json::Value patch = Json::createPatch(from, to);
+  Json::Value root = from;
+  Json::String errs;
+  if (!JSONTEST_CHECK(Json::applyPatch(&root, patch, &errs)) ||
+      !JSONTEST_CHECK(root == to))
+    fprintf(stderr, "  for %s with patch %s%s", what,
+            patch.toStyledString().c_str(), errs.c_str());
+  if (from == to)
+    JSONTEST_CHECK(patch.isArray() && patch.empty());
+}
+
+void checkOptionsAndResults() {
+  Json::Value options = parse(R"({
+    "dependent": {"value": "contcor1", "types": ["scale"]},
+    "variables": {"value": ["A", "B", "c d"], "types": ["scale", "nominal", "ordinal"]},
+    "plotDescriptives": false, "ciLevel": 0.95, "modelTerms": [{"components": ["A"]}],
+    ".meta": {"dependent": {"shouldEncode": true}, "variables": {"shouldEncode": true}}})");
+
+  Json::Value checked = options;
+  checked["plotDescriptives"] = true;
+  checkRoundTrip(options, checked, "a checkbox");
+  JSONTEST_CHECK(Json::createPatch(options, checked).size() == 1);
+
+  Json::Value added = options;
+  added["variables"]["value"].append("E");
+  added["variables"]["types"].append("scale");
+  added["modelTerms"][1]["components"].append("E");
+  checkRoundTrip(options, added, "an added variable");
+  checkRoundTrip(added, options, "a removed variable");
+
+  Json::Value results(Json::objectValue);
+  Json::Value& rows = results["table"]["data"];
+  for (int row = 0; row < 200; ++row) {
+    Json::Value& cells = rows.append(Json::Value(Json::objectValue));
+    cells["case"] = row;
+    cells["mean"] = row / 7.0;
+    cells["label"] = "row " + std::to_string(row);
+  }
+  results["table"]["title"] = "Descriptives";
+
+  Json::Value changed = results;
+  changed["table"]["data"][117]["mean"] = 0.5;
+  checkRoundTrip(results, changed, "a changed cell");
+  JSONTEST_CHECK(Json::createPatch(results, changed).size() == 1);
+
+  Json::Value inserted = results;
+  Json::Value& insertedRows = inserted["table"]["data"];
+  Json::Value newRow = insertedRows[0];
+  newRow["case"] = -1;
+  insertedRows.insert(50, newRow);
+  checkRoundTrip(results, inserted, "an inserted row");
+  JSONTEST_CHECK(Json::createPatch(results, inserted).size() == 1);
+  checkRoundTrip(inserted, results, "a removed row");
+
+  checkRoundTrip(results, options, "different documents");
+  checkRoundTrip(Json::Value(), results, "a null document");
+}
+
+// Changes a few places in a copy of value.
+Json::Value mutate(std::mt19937_64& random, Json::Value value,
+                   unsigned depth) {
+  if (random() % 6 == 0 || depth == 0)
+    return JsonTest::randomTree(random, 3);
+  if (value.isArray() && !value.empty()) {
+    const Json::ArrayIndex index = Json::ArrayIndex(random() % value.size());
+    switch (random() % 3) {
+    case 0:
+      value.insert(index, JsonTest::randomTree(random, 2));
+      break;
+    case 1: {
+      Json::Value removed;
+      value.removeIndex(index, &removed);
+      break;
+    }
+    default:
+      value[index] = mutate(random, value[index], depth - 1);
+    }
+  } else if (value.isObject() && !value.empty()) {
+    const Json::Value::Members names = value.getMemberNames();
+    const Json::String& name = names[random() % names.size()];
+    switch (random() % 3) {
+    case 0:
+      value[name + "~/"] = JsonTest::randomTree(random, 2);
+      break;
+    case 1:
+      value.removeMember(name);
+      break;
+    default:
+      value[name] = mutate(random, value[name], depth - 1);
+    }
+  }
+  return value;
+}
+
+// The tree as it reads back from text, where small unsigned integers become
+// signed ones.
+Json::Value throughText(Json::Value const& value) {
+  return parse(Json::FastWriter().write(value).c_str());
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(43);
+  for (unsigned index = 0; index < count; ++index) {
+    const Json::Value from = JsonTest::randomTree(random, 5);
+    const Json::Value to = mutate(random, from, 4);
+    checkRoundTrip(from, to, "a random tree");
+    // And through text, as a patch is sent.
+    const Json::Value fromText = throughText(from);
+    const Json::Value toText = throughText(to);
+    Json::Value root = fromText;
+    JSONTEST_CHECK(Json::applyPatch(
+                       &root, throughText(Json::createPatch(fromText, toText)),
+                       nullptr) &&
+                   root == toText);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkAppendixA();
+  checkErrors();
+  checkOptionsAndResults();
+  checkRandom(JsonTest::countArgument(argc, argv, 5000));
+  return JsonTest::result("JSON Patch");
+}
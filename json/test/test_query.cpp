@@ -0,0 +1,211 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Json::Query: the text form against the builder calls, examples of every
+// step and of every parse error, and random queries on random trees, as
+// many as the first argument says, against a plain walk with the accessors
+// of Value. Modifying the matches must leave copies of the tree as they
+// were.
+
+#include "jsontest.h"
+#include <memory>
+#include <vector>
+
+namespace {
+
+Json::Value parse(Json::String const& text) {
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value root;
+  JSONTEST_CHECK(
+      reader->parse(text.data(), text.data() + text.size(), &root, nullptr));
+  return root;
+}
+
+// The matches of path in root, as one array.
+Json::Value matches(Json::String const& path, Json::Value const& root) {
+  Json::Value result(Json::arrayValue);
+  for (Json::Value const* match : Json::Query(path).findAll(root))
+    result.append(*match);
+  return result;
+}
+
+const char* const analyses = R"([
+  {"name": "Descriptives", "options": {
+    ".meta": {"variables": {"shouldEncode": true}},
+    "variables": ["a", "b"],
+    "plots": [{"name": "density", "id": 1}, {"name": "qq", "id": 2},
+              {"name": "density", "id": 3.0}],
+    "a.b": 5}},
+  {"name": "TTest", "options": {"plots": [{"name": "density", "id": 4}],
+                               "alpha": 0.05}},
+  3, "text", null])";
+
+void checkExamples() {
+  const Json::Value root = parse(analyses);
+  Json::Value whole(Json::arrayValue);
+  whole.append(root);
+  JSONTEST_CHECK(matches(".", root) == whole);
+  JSONTEST_CHECK(matches("", root) == matches(".", root));
+  JSONTEST_CHECK(matches("[1].name", root) == parse(R"(["TTest"])"));
+  JSONTEST_CHECK(matches("[*].name", root) ==
+                 parse(R"(["Descriptives", "TTest"])"));
+  JSONTEST_CHECK(matches(".*.name", root) == matches("[*].name", root));
+  JSONTEST_CHECK(matches("[*].options.plots[?name==\"density\"].id", root) ==
+                 parse("[1, 3.0, 4]"));
+  // Numbers compare by value, names may be quoted.
+  JSONTEST_CHECK(matches("[0].options.plots[?id==3].name", root) ==
+                 parse(R"(["density"])"));
+  JSONTEST_CHECK(matches("[0].options.plots[?\"id\"==2.0].name", root) ==
+                 parse(R"(["qq"])"));
+  JSONTEST_CHECK(matches("[*][?shouldEncode==true]", root).size() == 0);
+  JSONTEST_CHECK(matches("[*].options.*[?shouldEncode==true]", root) ==
+                 parse(R"([{"shouldEncode": true}])"));
+
+  // Quoted names, after '.' as well as in brackets.
+  const Json::Value meta = parse(R"([{"variables": {"shouldEncode": true}}])");
+  JSONTEST_CHECK(matches("[0].options[\".meta\"]", root) == meta);
+  JSONTEST_CHECK(matches("[0].options.\".meta\"", root) == meta);
+  JSONTEST_CHECK(matches("[0].options.\".meta\".variables", root) ==
+                 parse(R"([{"shouldEncode": true}])"));
+  JSONTEST_CHECK(matches("[0].options.\"a.b\"", root) == parse("[5]"));
+  JSONTEST_CHECK(matches("[0].\"options\"[\"a.b\"]", root) == parse("[5]"));
+  JSONTEST_CHECK(matches("[0].options.\"\\u0061.b\"", root) == parse("[5]"));
+  JSONTEST_CHECK(matches("[0].options.a.b", root).size() == 0);
+
+  // Steps that do not apply match nothing.
+  for (char const* path :
+       {"[9]", ".name", "[2].x", "[2][0]", "[3][*]", "[0].name[0]",
+        "[0].options.missing", "[0].options.plots[?missing==1]",
+        "[0].options.plots[?name==1]", "[4].*"})
+    JSONTEST_CHECK(matches(path, root).size() == 0);
+
+  const Json::Query first("[*].options.plots[*].id");
+  JSONTEST_CHECK(first.find(root) && *first.find(root) == 1 &&
+                 first.resolve(root) == 1);
+  const Json::Query none("[0].options.none");
+  JSONTEST_CHECK(!none.find(root) && none.resolve(root).isNull());
+}
+
+// The builder calls give the same query as the text.
+void checkBuilder() {
+  const Json::Value root = parse(analyses);
+  const Json::Query built = Json::Query()
+                                .any()
+                                .key("options")
+                                .key("plots")
+                                .where("name", "density")
+                                .key("id");
+  const Json::Query text("[*].options.plots[?name==\"density\"].id");
+  JSONTEST_CHECK(built.findAll(root) == text.findAll(root));
+  const Json::Query meta = Json::Query().index(0).key("options").key(".meta");
+  JSONTEST_CHECK(meta.find(root) ==
+                 Json::Query("[0].options.\".meta\"").find(root));
+  JSONTEST_CHECK(Json::Query().find(root) == &root);
+}
+
+void checkErrors() {
+  for (char const* path :
+       {"..", ".a.", "[", "[]", "[1", "[x]", "[-1]", "[99999999999]",
+        "[\"a]", "[\"a\"", "[?]", "[?a]", "[?a=1]", "[?a==]", "[?a==[1]]",
+        "[?a=={}]", "[?a==x]", ".\"a", ".\"a\"b", ".\"a\"\"b\"",
+        ".\"a\"*"}) {
+    bool threw = false;
+    try {
+      Json::Query query(path);
+    } catch (Json::LogicError const& error) {
+      threw = strstr(error.what(), "invalid path") != nullptr;
+    }
+    if (!JSONTEST_CHECK(threw))
+      fprintf(stderr, "  accepted %s\n", path);
+  }
+}
+
+// What a query of key, index and any steps matches, found with the
+// accessors of Value.
+void reference(Json::Value const& node,
+               std::vector<Json::Value> const& steps, size_t step,
+               std::vector<Json::Value const*>* found) {
+  if (step == steps.size()) {
+    found->push_back(&node);
+    return;
+  }
+  Json::Value const& current = steps[step];
+  if (current.isString()) {
+    if (node.isObject() && node.isMember(current.asString()))
+      reference(node[current.asString()], steps, step + 1, found);
+  } else if (current.isUInt()) {
+    if (node.isArray() && current.asUInt() < node.size())
+      reference(node[current.asUInt()], steps, step + 1, found);
+  } else if (node.isArray() || node.isObject()) {
+    for (Json::Value const& child : node)
+      reference(child, steps, step + 1, found);
+  }
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(46);
+  for (unsigned index = 0; index < count; ++index) {
+    const Json::Value tree = JsonTest::randomTree(random, 5);
+    // Steps: a name (string), an index (uint) or any (null).
+    std::vector<Json::Value> steps;
+    Json::Query query;
+    Json::String text;
+    for (unsigned step = unsigned(random() % 5); step > 0; --step) {
+      switch (random() % 3) {
+      case 0: {
+        Json::String name = "member" + std::to_string(random() % 20);
+        if (random() % 8 == 0)
+          name += Json::String(1, '\0') + "tail";
+        steps.emplace_back(name);
+        query.key(name);
+        text += "[" + Json::writeString(Json::StreamWriterBuilder(),
+                                        Json::Value(name)) +
+                "]";
+        break;
+      }
+      case 1: {
+        const unsigned position = unsigned(random() % 6);
+        steps.emplace_back(position);
+        query.index(position);
+        text += "[" + std::to_string(position) + "]";
+        break;
+      }
+      default:
+        steps.emplace_back();
+        query.any();
+        text += ".*";
+      }
+    }
+    std::vector<Json::Value const*> expected;
+    reference(tree, steps, 0, &expected);
+    JSONTEST_CHECK(query.findAll(tree) == expected &&
+                   Json::Query(text).findAll(tree) == expected);
+    JSONTEST_CHECK(query.find(tree) ==
+                   (expected.empty() ? nullptr : expected.front()));
+
+    // The matches of a copy, modified, leave the tree as it was.
+    const Json::String before = Json::FastWriter().write(tree);
+    Json::Value copy = tree;
+    const std::vector<Json::Value*> writable = query.findAll(copy);
+    JSONTEST_CHECK(writable.size() == expected.size());
+    for (Json::Value* match : writable)
+      *match = "changed";
+    JSONTEST_CHECK(Json::FastWriter().write(tree) == before);
+    for (Json::Value const* match :
+         query.findAll(static_cast<Json::Value const&>(copy)))
+      JSONTEST_CHECK(*match == "changed");
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkExamples();
+  checkBuilder();
+  checkErrors();
+  checkRandom(JsonTest::countArgument(argc, argv, 5000));
+  return JsonTest::result("queries");
+}
@@ -0,0 +1,159 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// Copies that share their contents (see Value): copying, hashing, comparing
+// and modifying copies of one tree from several threads at once, for as many
+// rounds as the first argument says, and values assigned into themselves.
+// Meant to be run under TSan and ASan as well.
+
+#include "jsontest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const unsigned threadCount = 8;
+const unsigned rows = 300;
+
+// A tree with every kind of value, built the same way every time.
+Json::Value makeTree() {
+  Json::Value tree(Json::objectValue);
+  tree["table"] = JsonTest::resultsTable(rows);
+  std::mt19937_64 random(41);
+  for (unsigned index = 0; index < 20; ++index)
+    tree["random"].append(JsonTest::randomTree(random, 5));
+  const double doubles[] = {0.5, 1.5, 2.5};
+  tree["typed"] = Json::Value(std::begin(doubles), std::end(doubles));
+  return tree;
+}
+
+// What one thread does with its copy of shared in one round.
+void useCopy(Json::Value const& shared, Json::Value const& reference,
+             unsigned thread, unsigned round, std::atomic<int>& failures) {
+  Json::Value copy = shared;
+  // The hash is cached in the shared contents on first use, by whichever
+  // thread gets there first.
+  if (copy.hash() != reference.hash() || !(copy == reference))
+    ++failures;
+
+  const Json::ArrayIndex row = (thread * 37 + round) % rows;
+  copy["table"]["data"][row]["n"] = int(thread);
+  copy["table"]["title"] = "thread " + std::to_string(thread);
+  copy["random"].append(Json::Value(round));
+  copy.removeMember("typed");
+  Json::Value nested = copy;
+  nested["table"]["data"][row]["mean"] = -1.0;
+
+  // The changes stay in the copies that made them.
+  if (copy["table"]["data"][row]["n"] != int(thread) ||
+      nested["table"]["data"][row]["n"] != int(thread) ||
+      copy["table"]["data"][row]["mean"] == -1.0 || copy == shared ||
+      copy.hash() == reference.hash() || copy.isMember("typed"))
+    ++failures;
+  // What they did not change is still shared and equal.
+  const Json::Value& other = copy["table"]["data"][(row + 1) % rows];
+  if (other != reference["table"]["data"][(row + 1) % rows] ||
+      copy["table"]["schema"] != shared["table"]["schema"])
+    ++failures;
+}
+
+void checkThreads(unsigned rounds) {
+  for (unsigned round = 0; round < rounds; ++round) {
+    const Json::Value reference = makeTree();
+    // Shared by every thread, and hashed for the first time by them.
+    const Json::Value shared = makeTree();
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (unsigned thread = 0; thread < threadCount; ++thread)
+      threads.emplace_back([&, thread] {
+        useCopy(shared, reference, thread, round, failures);
+      });
+    for (std::thread& thread : threads)
+      thread.join();
+    JSONTEST_CHECK(failures == 0);
+    JSONTEST_CHECK(shared == reference && shared.hash() == reference.hash());
+  }
+}
+
+// Copies handed from thread to thread, each changing and passing on its
+// own copy while the previous owner keeps reading.
+void checkHandOver(unsigned rounds) {
+  const Json::Value reference = makeTree();
+  Json::Value current = reference;
+  for (unsigned round = 0; round < rounds; ++round) {
+    Json::Value next = current;
+    const Json::Value& previous = current;
+    bool readBack = false;
+    std::thread reader([&previous, &reference, &readBack, round] {
+      readBack = previous["table"]["data"].size() == rows &&
+                 (round != 0 || previous == reference);
+    });
+    std::thread writer([&next, round] {
+      next["table"]["data"][round % rows]["variable"] = "changed";
+      next["random"][0] = Json::Value(round);
+    });
+    reader.join();
+    writer.join();
+    JSONTEST_CHECK(readBack);
+    current = next;
+  }
+  JSONTEST_CHECK(current["table"]["data"][0]["variable"] == "changed" ||
+                 rounds == 0);
+  JSONTEST_CHECK(reference == makeTree());
+}
+
+Json::Value parse(char const* text) {
+  Json::Value value;
+  Json::Reader().parse(text, value);
+  return value;
+}
+
+// A value assigned to one of its own members, or to a member of a member,
+// is stored as it was before, and the tree does not contain itself.
+void checkAssignToMember() {
+  Json::Value value = parse(R"({"a": 1})");
+  value["self"] = value;
+  JSONTEST_CHECK(value == parse(R"({"a": 1, "self": {"a": 1, "self": null}})"));
+  JSONTEST_CHECK(Json::FastWriter().write(value) ==
+                 "{\"a\":1,\"self\":{\"a\":1,\"self\":null}}\n");
+
+  Json::Value deep = parse(R"({"a": {"b": [1, {"c": 2}]}, "d": [3]})");
+  const Json::Value before = deep;
+  deep["a"]["b"][1]["c"] = deep;
+  Json::Value expected = before;
+  expected["a"]["b"][1]["c"] = parse(
+      R"({"a": {"b": [1, {"c": 2}]}, "d": [3]})");
+  JSONTEST_CHECK(deep == expected && before["a"]["b"][1]["c"] == 2);
+  JSONTEST_CHECK(!deep.toStyledString().empty());
+
+  // The new element is made before the copy, as with a deep copy.
+  Json::Value array = parse("[1, [2]]");
+  array[1][1] = array;
+  const Json::Value once = parse("[1, [2, [1, [2, null]]]]");
+  JSONTEST_CHECK(array == once);
+  array.append(array);
+  JSONTEST_CHECK(array == parse("[1, [2, [1, [2, null]]], [1, [2, [1, [2, "
+                                "null]]]]]"));
+  const Json::Value twice = array;
+  array[0].copy(array);
+  JSONTEST_CHECK(array[0] == twice && array[1] == once[1] &&
+                 array[2] == once && array.size() == 3);
+
+  // A descendant assigned to its ancestor.
+  Json::Value up = parse(R"({"a": {"b": {"c": 1}}})");
+  up["a"] = up["a"]["b"];
+  JSONTEST_CHECK(up == parse(R"({"a": {"c": 1}})"));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const unsigned rounds = JsonTest::countArgument(argc, argv, 50);
+  checkThreads(rounds);
+  checkHandOver(rounds);
+  checkAssignToMember();
+  return JsonTest::result("shared copies");
+}
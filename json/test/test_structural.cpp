@@ -0,0 +1,229 @@
+// Copyright 2007-2010 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+// The "structuralIndex" setting of CharReaderBuilder against the reader
+// without it: random documents, most of them spoilt in some way, read with
+// random settings must give the same result, the same tree with the same
+// types, comments and offsets, and the same errors. The first argument is
+// the number of documents.
+
+#include "jsontest.h"
+#include <memory>
+
+namespace {
+
+bool sameBits(double a, double b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+// Equal down to the types, the bits of doubles, comments and offsets.
+bool sameTree(Json::Value const& a, Json::Value const& b) {
+  if (a.type() != b.type() || a.getOffsetStart() != b.getOffsetStart() ||
+      a.getOffsetLimit() != b.getOffsetLimit())
+    return false;
+  for (Json::CommentPlacement placement :
+       {Json::commentBefore, Json::commentAfterOnSameLine,
+        Json::commentAfter})
+    if (a.getComment(placement) != b.getComment(placement))
+      return false;
+  switch (a.type()) {
+  case Json::realValue:
+    return sameBits(a.asDouble(), b.asDouble());
+  case Json::arrayValue:
+    if (a.size() != b.size())
+      return false;
+    for (Json::ArrayIndex index = 0; index < a.size(); ++index)
+      if (!sameTree(a[index], b[index]))
+        return false;
+    return true;
+  case Json::objectValue: {
+    if (a.getMemberNames() != b.getMemberNames())
+      return false;
+    for (auto const& member : a.members())
+      if (!sameTree(member.value,
+                    *b.find(member.name.data(),
+                            member.name.data() + member.name.size())))
+        return false;
+    return true;
+  }
+  default:
+    return a == b;
+  }
+}
+
+// The text of a random tree, in one of the writers' layouts.
+Json::String writeTree(std::mt19937_64& random) {
+  const Json::Value tree = JsonTest::randomTree(random, 4);
+  switch (random() % 3) {
+  case 0:
+    return Json::FastWriter().write(tree);
+  case 1:
+    return tree.toStyledString();
+  default: {
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, tree);
+  }
+  }
+}
+
+// A few changes to text, each of which some setting accepts or rejects.
+Json::String spoil(std::mt19937_64& random, Json::String text) {
+  static char const* const insertions[] = {
+      "// comment\n", "/* comment */", "/**/", ",",     "]",       "}",
+      "\"",           "'a'",           "NaN",  "-Infinity", "1",   ":",
+      "\\",           "\xEF\xBB\xBF",  " ",    "\n",    "nul",     "01",
+      "1.",           "-",             "\t",   "\"\\u00e9\"", "1e400", "x"};
+  for (unsigned change = unsigned(random() % 3); change > 0; --change) {
+    const size_t at = text.empty() ? 0 : size_t(random() % text.size());
+    switch (random() % 6) {
+    case 0:
+    case 1:
+      text.insert(at, insertions[random() % (sizeof(insertions) /
+                                             sizeof(insertions[0]))]);
+      break;
+    case 2:
+      if (!text.empty())
+        text.erase(at, 1);
+      break;
+    case 3:
+      text.resize(at);
+      break;
+    case 4:
+      // The same member twice.
+      if (text[0] == '{' && text.size() > 2)
+        text.insert(1, "\"member1\":null,");
+      break;
+    default:
+      // Trailing commas and dropped null placeholders.
+      for (size_t found = text.find_first_of("]}", at);
+           found != Json::String::npos && found < text.size();
+           found = text.find_first_of("]}", found + 3))
+        text.insert(found, random() % 2 ? "," : ",,");
+    }
+  }
+  return text;
+}
+
+// What follows the root: nothing, whitespace, comments or anything else.
+Json::String tail(std::mt19937_64& random) {
+  static char const* const tails[] = {
+      "",       "",        "\n",     "  \n\t", " // after\n", "/* after */",
+      " // a",  "\n/* b */ // c\n", " x", " [1]", ",", "/* open"};
+  return tails[random() % (sizeof(tails) / sizeof(tails[0]))];
+}
+
+Json::Value randomSettings(std::mt19937_64& random) {
+  Json::Value settings;
+  if (random() % 4 == 0)
+    Json::CharReaderBuilder::strictMode(&settings);
+  else
+    Json::CharReaderBuilder::setDefaults(&settings);
+  for (char const* flag :
+       {"collectComments", "allowComments", "allowTrailingCommas",
+        "strictRoot", "allowDroppedNullPlaceholders", "allowNumericKeys",
+        "allowSingleQuotes", "failIfExtra", "rejectDupKeys",
+        "allowSpecialFloats", "skipBom"})
+    if (random() % 3 == 0)
+      settings[flag] = !settings[flag].asBool();
+  if (random() % 8 == 0)
+    settings["stackLimit"] = unsigned(random() % 6) + 1;
+  return settings;
+}
+
+struct Outcome {
+  bool ok;
+  bool threw;
+  Json::Value root;
+  Json::String errs;
+};
+
+Outcome read(Json::Value const& settings, Json::String const& text) {
+  Json::CharReaderBuilder builder;
+  builder.settings_ = settings;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Outcome outcome{false, false, Json::Value(), Json::String()};
+  try {
+    outcome.ok = reader->parse(text.data(), text.data() + text.size(),
+                               &outcome.root, &outcome.errs);
+  } catch (std::exception const& error) {
+    outcome.threw = true;
+    outcome.errs = error.what();
+  }
+  return outcome;
+}
+
+void checkSame(Json::Value settings, Json::String const& text) {
+  settings["structuralIndex"] = false;
+  const Outcome plain = read(settings, text);
+  settings["structuralIndex"] = true;
+  for (unsigned threads : {1U, 4U}) {
+    settings["parseThreads"] = threads;
+    const Outcome indexed = read(settings, text);
+    if (!JSONTEST_CHECK(indexed.ok == plain.ok &&
+                        indexed.threw == plain.threw &&
+                        indexed.errs == plain.errs) ||
+        !JSONTEST_CHECK(sameTree(indexed.root, plain.root)))
+      fprintf(stderr, "  reading %s\n  with %s", text.c_str(),
+              Json::FastWriter().write(settings).c_str());
+  }
+}
+
+void checkExamples() {
+  Json::Value defaults;
+  Json::CharReaderBuilder::setDefaults(&defaults);
+  Json::Value strict;
+  Json::CharReaderBuilder::strictMode(&strict);
+  for (char const* text :
+       {"[1] // c", "{\"a\":1} /* c */", "[1]\n// c\n", "[1] /* a */ // b",
+        "[1] x", "[1] x // c", "[1]   ", "[1] /* open", "// before\n[1]",
+        "\xEF\xBB\xBF[1]", "{\"a\":1,\"a\":2}", "[1,]", "[,1]", "'a'",
+        "[NaN]", "1", "\"a\" // c"}) {
+    checkSame(defaults, text);
+    checkSame(strict, text);
+  }
+
+#if !JSON_USE_LEAN_VALUE
+  // Trailing comments of the root are kept, with either setting.
+  defaults["structuralIndex"] = true;
+  for (char const* text : {"[1] // c", "{\"a\":1} /* c */"}) {
+    const Outcome indexed = read(defaults, text);
+    JSONTEST_CHECK(indexed.ok && indexed.root.hasComment(
+                                     Json::commentAfterOnSameLine));
+  }
+#endif
+}
+
+void checkRandom(unsigned count) {
+  std::mt19937_64 random(44);
+  for (unsigned index = 0; index < count; ++index) {
+    Json::String text = writeTree(random);
+    if (random() % 2 == 0)
+      text = spoil(random, text);
+    text += tail(random);
+    checkSame(randomSettings(random), text);
+  }
+}
+
+// A top-level array big enough to be spread over threads.
+void checkBigArray() {
+  std::mt19937_64 random(45);
+  Json::Value array(Json::arrayValue);
+  for (unsigned index = 0; index < 20000; ++index)
+    array.append(JsonTest::randomTree(random, 2));
+  const Json::String text = Json::FastWriter().write(array);
+  Json::Value defaults;
+  Json::CharReaderBuilder::setDefaults(&defaults);
+  checkSame(defaults, text);
+  checkSame(defaults, text + " // after");
+  checkSame(defaults, text.substr(0, text.size() / 2));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  checkExamples();
+  checkRandom(JsonTest::countArgument(argc, argv, 20000));
+  checkBigArray();
+  return JsonTest::result("structural index");
+}
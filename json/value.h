@@ -40,10 +40,13 @@
 #endif
 
 #include <array>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Disable warning C4251: <data member>: <type> needs to have dll-interface to
@@ -185,19 +188,61 @@ private:
  * It is possible to iterate over the list of member keys of an object using
  * the getMemberNames() method.
  *
+ * \note The elements of an #arrayValue are stored contiguously, so like with
+ * a std::vector references and pointers to them are invalidated when the
+ * array grows (append(), insert(), resize() or operator[] past the end).
+ * References to the members of an #objectValue stay valid until that member
+ * is removed, but adding or removing members invalidates the iterators of
+ * the object.
+ *
+ * Arrays and objects are implicitly shared, like the Qt containers: copying
+ * one only counts a reference, and the first non-const access to a copy
+ * (operator[], append(), begin(), ...) copies the level it modifies, whose
+ * members stay shared in turn. So a copy costs as much as the path that is
+ * changed afterwards. As with Qt, a reference or non-const iterator taken
+ * before the value (or a value containing it) is copied must not be used to
+ * modify it after that; it would modify the copy as well. Take it again.
+ * Likewise a const reference taken while the value was shared keeps
+ * referring to the unmodified contents, which the copy still holds.
+ * Assigning a value to one of its own members (v["self"] = v) stores it as
+ * it was before the assignment, as a deep copy did.
+ *
+ * Thread safety is that of the standard containers: different Value objects
+ * can be used from different threads at the same time, even if they are
+ * copies of each other, while one Value object that is being modified must
+ * not be accessed by any other thread.
+ *
+ * Values can live in an Arena instead of on the heap, see Arena and Document.
+ *
+ * Member names of up to 32 bytes are interned: every object in the process
+ * that has a member of that name refers to one shared copy, so keys that
+ * repeat in many objects take no memory of their own, as if they were a
+ * StaticString. (Names shorter than 8 bytes are kept in the member itself.)
+ * The first 64K distinct names are interned, and stay until the process
+ * ends; longer or later ones are copied for every member as before.
+ *
+ * When built with JSON_USE_LEAN_VALUE, values keep no comments and no source
+ * offsets: setComment() and setOffsetStart()/setOffsetLimit() do nothing.
+ *
  * \note #Value string-length fit in size_t, but keys must be < 2^30.
  * (The reason is an implementation detail.) A #CharReader will raise an
  * exception if a bound is exceeded to avoid security holes in your app,
  * but the Value API does *not* check bounds. That is the responsibility
  * of the caller.
  */
+template <typename Iterator, typename Reference> class ValueMemberRange;
+
 class JSON_API Value {
   friend class ValueIteratorBase;
+  friend class Document;
+  friend class Reclaimer;
 
 public:
   using Members = std::vector<String>;
   using iterator = ValueIterator;
   using const_iterator = ValueConstIterator;
+  using MemberRange = ValueMemberRange<ValueIterator, Value&>;
+  using ConstMemberRange = ValueMemberRange<ValueConstIterator, const Value&>;
   using UInt = Json::UInt;
   using Int = Json::Int;
 #if defined(JSON_HAS_INT64)
@@ -260,8 +305,12 @@ private:
 #ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
   class CZString {
   public:
-    enum DuplicationPolicy { noDuplication = 0, duplicate, duplicateOnCopy };
-    CZString(ArrayIndex index);
+    enum DuplicationPolicy {
+      noDuplication = 0,
+      duplicate,
+      duplicateOnCopy,
+      arenaOwned // duplicated into an Arena, released with it
+    };
     CZString(char const* str, unsigned length, DuplicationPolicy allocate);
     CZString(CZString const& other);
     CZString(CZString&& other) noexcept;
@@ -271,7 +320,6 @@ private:
 
     bool operator<(CZString const& other) const;
     bool operator==(CZString const& other) const;
-    ArrayIndex index() const;
     // const char* c_str() const; ///< \deprecated
     char const* data() const;
     unsigned length() const;
@@ -279,21 +327,27 @@ private:
 
   private:
     void swap(CZString& other);
+    // Duplicated keys shorter than chars_ are kept in there, zero-terminated.
+    bool isInline() const;
 
     struct StringStorage {
       unsigned policy_ : 2;
       unsigned length_ : 30; // 1GB max
+      // Interned keys are noDuplication too, but not a caller's StaticString.
+      // On 64-bit targets it takes up the padding after cstr_.
+      unsigned interned_ : 1;
     };
 
-    char const* cstr_; // actually, a prefixed string, unless policy is noDup
     union {
-      ArrayIndex index_;
-      StringStorage storage_;
+      char const* cstr_;
+      char chars_[sizeof(char const*)];
     };
+    StringStorage storage_;
   };
 
 public:
-  typedef std::map<CZString, Value> ObjectValues;
+  class ObjectValues; // defined in json_value.cpp
+  class ArrayValues;  // defined in json_value.cpp
 #endif // ifndef JSONCPP_DOC_EXCLUDE_IMPLEMENTATION
 
 public:
@@ -323,6 +377,28 @@ public:
   Value(double value);
   Value(const char* value); ///< Copy til first 0. (NULL causes to seg-fault.)
   Value(const char* begin, const char* end); ///< Copy all, incl zeroes.
+  /**
+   * \brief Constructs an #arrayValue of the doubles, integers or bools in
+   * [begin, end).
+   *
+   * They are kept together as one block of their type rather than as a Value
+   * each, and the writers and toBinary() write them from there. Looking at
+   * the elements works as with any array, but the first such access (const
+   * operator[], begin(), ...) has to make the Values after all, and a
+   * non-const access turns the array into an ordinary one. getDoubles(),
+   * getInt64s() and getBools() give the block itself.
+   *
+   * Example of usage:
+   *   \code
+   *   std::vector<double> column = ...;
+   *   Json::Value values(column.data(), column.data() + column.size());
+   *   \endcode
+   */
+  Value(const double* begin, const double* end);
+#if defined(JSON_HAS_INT64)
+  Value(const Int64* begin, const Int64* end);
+#endif // if defined(JSON_HAS_INT64)
+  Value(const bool* begin, const bool* end);
   /**
    * \brief Constructs a value from a static string.
    *
@@ -370,10 +446,29 @@ public:
   bool operator<=(const Value& other) const;
   bool operator>=(const Value& other) const;
   bool operator>(const Value& other) const;
+  /** Deep comparison, which like the ordering tells types apart (1 != 1u).
+   * Arrays and objects that share their contents (see the class notes) are
+   * equal without looking into them, unless a NaN real is in them: NaN is
+   * unequal to itself, so is anything holding one, even a copy. Ones whose
+   * cached hashes differ (see hash()) are unequal.
+   */
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const;
   int compare(const Value& other) const;
 
+  /** \brief A 64 bit hash of the contents, the same for values that compare
+   * equal.
+   *
+   * Like operator==() it tells types apart and ignores comments and offsets;
+   * it does not depend on the order in which object members were added. The
+   * hash of an array or object is kept with its contents while they are
+   * shared with a copy, as nothing can modify them then. So to use a large
+   * tree as a cache key, keep a copy of it: hashing the tree again after a
+   * change costs only the path that changed. std::hash is specialised with
+   * this, so a Value can be the key of an unordered container.
+   */
+  std::uint64_t hash() const;
+
   const char* asCString() const; ///< Embedded zeroes could cause you trouble!
 #if JSONCPP_USING_SECURE_MEMORY
   unsigned getCStringLength() const; // Allows you to understand the length of
@@ -382,8 +477,23 @@ public:
   String asString() const; ///< Embedded zeroes are possible.
   /** Get raw char* of string-value.
    *  \return false if !string. (Seg-fault if str or end are NULL.)
+   *  \note Short strings are stored inside the Value, so like the result of
+   *  asCString() the pointers are only valid while the Value is not moved
+   *  or modified.
    */
   bool getString(char const** begin, char const** end) const;
+  /** Get the elements of an array made from doubles, see
+   *  Value(const double*, const double*).
+   *  \return false if this is not such an array, or no longer is one because
+   *  it was modified. The pointers are valid while the Value is not modified.
+   */
+  bool getDoubles(double const** begin, double const** end) const;
+#if defined(JSON_HAS_INT64)
+  /// Same as getDoubles(), for an array made from Int64s.
+  bool getInt64s(Int64 const** begin, Int64 const** end) const;
+#endif // if defined(JSON_HAS_INT64)
+  /// Same as getDoubles(), for an array made from bools.
+  bool getBools(bool const** begin, bool const** end) const;
   Int asInt() const;
   UInt asUInt() const;
 #if defined(JSON_HAS_INT64)
@@ -437,6 +547,12 @@ public:
   /// \post type() is arrayValue
   void resize(ArrayIndex newSize);
 
+  /// Reserve room for at least newCapacity elements, so that appending up to
+  /// that many does not reallocate.
+  /// \pre type() is arrayValue or nullValue
+  /// \post type() is arrayValue
+  void reserve(ArrayIndex newCapacity);
+
   ///@{
   /// Access an array element (zero based index). If the array contains less
   /// than index element, then null value are inserted in the array so that
@@ -562,6 +678,22 @@ public:
   /// \post if type() was nullValue, it remains nullValue
   Members getMemberNames() const;
 
+  /// \brief The members as name and value pairs, in getMemberNames() order.
+  ///
+  /// Unlike getMemberNames() and operator[], this copies no names and looks
+  /// nothing up:
+  ///   \code
+  ///   for (auto [name, option] : options.members())
+  ///     if (name != ".meta")
+  ///       encode(option);
+  ///   \endcode
+  /// The names point into the object. Changing member values is fine, but
+  /// adding or removing members invalidates the range and its iterators, as
+  /// documented for the object's iterators.
+  /// \pre type() is objectValue or nullValue
+  MemberRange members();
+  ConstMemberRange members() const;
+
   /// \deprecated Always pass len.
   JSONCPP_DEPRECATED("Use setComment(String const&) instead.")
   void setComment(const char* comment, CommentPlacement placement) {
@@ -600,7 +732,20 @@ private:
   void setIsAllocated(bool v) { bits_.allocated_ = v; }
 
   void initBasic(ValueType type, bool allocated = false);
+  void initString(char const* str, unsigned length);
+  bool decodeString(unsigned* length, char const** str) const;
   void dupPayload(const Value& other);
+  // Gives this value its own copy of a shared array or object payload, and
+  // forgets its cached hash, before the payload is modified.
+  void detach();
+  // Finds target among the values inside this one, giving the positions
+  // that lead to it from the innermost level outwards. See operator=().
+  bool findPath(Value const* target, std::vector<ArrayIndex>* path) const;
+  // Detaches the levels along a path found by findPath().
+  void detachPath(std::vector<ArrayIndex> const& path);
+  std::uint64_t structuralHash(bool frozen) const;
+  // Whether a NaN real is anywhere in this value, see operator==().
+  bool holdsNaN(bool frozen) const;
   void releasePayload();
   void dupMeta(const Value& other);
 
@@ -622,7 +767,9 @@ private:
     double real_;
     bool bool_;
     char* string_; // if allocated_, ptr to { unsigned, char[] }.
+    char chars_[sizeof(double)]; // if inline_, the string, zero-terminated.
     ObjectValues* map_;
+    ArrayValues* array_;
   } value_;
 
   struct {
@@ -630,8 +777,15 @@ private:
     unsigned int value_type_ : 8;
     // Unless allocated_, string_ must be null-terminated.
     unsigned int allocated_ : 1;
+    // Short strings are kept in chars_ rather than string_.
+    unsigned int inline_ : 1;
+    unsigned int inlineLength_ : 3;
+    // Id of the Arena this value lives in, 0 for the heap. Not swapped with
+    // the payload, see swapPayload().
+    unsigned int arena_ : 12;
   } bits_;
 
+#if !JSON_USE_LEAN_VALUE
   class Comments {
   public:
     Comments() = default;
@@ -653,6 +807,7 @@ private:
   // was extracted.
   ptrdiff_t start_;
   ptrdiff_t limit_;
+#endif // if !JSON_USE_LEAN_VALUE
 };
 
 template <> inline bool Value::as<bool>() const { return asBool(); }
@@ -804,7 +959,10 @@ protected:
   void copy(const SelfType& other);
 
 private:
-  Value::ObjectValues::iterator current_;
+  // The array or object iterated over, index_ is the position in it.
+  Value::ArrayValues* array_{nullptr};
+  Value::ObjectValues* object_{nullptr};
+  ArrayIndex index_{0};
   // Indicates that iterator is for a null value.
   bool isNull_{true};
 
@@ -812,7 +970,8 @@ public:
   // For some reason, BORLAND needs these at the end, rather
   // than earlier. No idea why.
   ValueIteratorBase();
-  explicit ValueIteratorBase(const Value::ObjectValues::iterator& current);
+  ValueIteratorBase(Value::ArrayValues* array, ArrayIndex index);
+  ValueIteratorBase(Value::ObjectValues* object, ArrayIndex index);
 };
 
 /** \brief const iterator for object and array value.
@@ -835,7 +994,8 @@ public:
 private:
   /*! \internal Use by Value to create an iterator.
    */
-  explicit ValueConstIterator(const Value::ObjectValues::iterator& current);
+  ValueConstIterator(Value::ArrayValues* array, ArrayIndex index);
+  ValueConstIterator(Value::ObjectValues* object, ArrayIndex index);
 
 public:
   SelfType& operator=(const ValueIteratorBase& other);
@@ -887,7 +1047,8 @@ public:
 private:
   /*! \internal Use by Value to create an iterator.
    */
-  explicit ValueIterator(const Value::ObjectValues::iterator& current);
+  ValueIterator(Value::ArrayValues* array, ArrayIndex index);
+  ValueIterator(Value::ObjectValues* object, ArrayIndex index);
 
 public:
   SelfType& operator=(const SelfType& other);
@@ -923,10 +1084,74 @@ public:
   pointer operator->() const { return const_cast<pointer>(&deref()); }
 };
 
+/** \brief The members of an object, see Value::members().
+ */
+template <typename Iterator, typename Reference> class ValueMemberRange {
+public:
+  struct Member {
+    /// May contain embedded nulls.
+    std::string_view name;
+    Reference value;
+  };
+
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Member;
+    using difference_type = typename Iterator::difference_type;
+    using pointer = void;
+    using reference = Member;
+
+    explicit iterator(Iterator current) : current_(current) {}
+
+    Member operator*() const {
+      char const* end;
+      char const* name = current_.memberName(&end);
+      return {std::string_view(name, size_t(end - name)), *current_};
+    }
+    iterator& operator++() {
+      ++current_;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator previous(*this);
+      ++current_;
+      return previous;
+    }
+    bool operator==(const iterator& other) const {
+      return current_ == other.current_;
+    }
+    bool operator!=(const iterator& other) const {
+      return current_ != other.current_;
+    }
+
+  private:
+    Iterator current_;
+  };
+
+  ValueMemberRange(Iterator begin, Iterator end) : begin_(begin), end_(end) {}
+
+  iterator begin() const { return iterator(begin_); }
+  iterator end() const { return iterator(end_); }
+
+private:
+  Iterator begin_;
+  Iterator end_;
+};
+
 inline void swap(Value& a, Value& b) { a.swap(b); }
 
 } // namespace Json
 
+namespace std {
+/// Hashes a Json::Value with Value::hash().
+template <> struct hash<Json::Value> {
+  size_t operator()(Json::Value const& value) const {
+    return static_cast<size_t>(value.hash());
+  }
+};
+} // namespace std
+
 #pragma pack(pop)
 
 #if defined(JSONCPP_DISABLE_DLL_INTERFACE_WARNING)
@@ -108,7 +108,9 @@ public:
    *    NaN values as "NaN", positive infinity as "Infinity", and negative
    *  infinity as "-Infinity".
    *  - "precision": int
-   *  - Number of precision digits for formatting of real values.
+   *  - Number of precision digits for formatting of real values. With
+   *    "significant" digits, 17 (the default) or more writes the shortest
+   *    text that reads back as the same double.
    *  - "precisionType": "significant"(default) or "decimal"
    *  - Type of precision for formatting of real values.
    *  - "emitUTF8": false or true
@@ -185,13 +187,24 @@ public:
 
   void omitEndingLineFeed();
 
+  /** \brief Number of chars write(root, buffer) needs for root.
+   * Exact, except that each real counts as the longest double text.
+   */
+  size_t sizeBound(const Value& root) const;
+
+  /** \brief Writes root to buffer, which must have room for sizeBound(root)
+   * chars, and returns the end of the output. Nothing is null-terminated.
+   */
+  char* write(const Value& root, char* buffer) const;
+
 public: // overridden from Writer
+  /// Sizes the document with sizeBound() and writes it in place.
   String write(const Value& root) override;
 
 private:
-  void writeValue(const Value& value);
+  size_t valueSize(const Value& value) const;
+  char* writeValue(const Value& value, char* out) const;
 
-  String document_;
   bool yamlCompatibilityEnabled_{false};
   bool dropNullPlaceholders_{false};
   bool omitEndingLineFeed_{false};
@@ -245,7 +258,7 @@ private:
   void writeValue(const Value& value);
   void writeArrayValue(const Value& value);
   bool isMultilineArray(const Value& value);
-  void pushValue(const String& value);
+  void pushValue(const Value& value);
   void writeIndent();
   void writeWithIndent(const String& value);
   void indent();
@@ -255,9 +268,8 @@ private:
   static bool hasCommentForValue(const Value& value);
   static String normalizeEOL(const String& text);
 
-  using ChildValues = std::vector<String>;
-
-  ChildValues childValues_;
+  String childText_;
+  std::vector<size_t> childEnds_;
   String document_;
   String indentString_;
   unsigned int rightMargin_{74};
@@ -319,9 +331,10 @@ private:
   void writeValue(const Value& value);
   void writeArrayValue(const Value& value);
   bool isMultilineArray(const Value& value);
-  void pushValue(const String& value);
+  void pushValue(const Value& value);
   void writeIndent();
   void writeWithIndent(const String& value);
+  void flush();
   void indent();
   void unindent();
   void writeCommentBeforeValue(const Value& root);
@@ -329,10 +342,10 @@ private:
   static bool hasCommentForValue(const Value& value);
   static String normalizeEOL(const String& text);
 
-  using ChildValues = std::vector<String>;
-
-  ChildValues childValues_;
+  String childText_;
+  std::vector<size_t> childEnds_;
   OStream* document_;
+  String buffer_;
   String indentString_;
   unsigned int rightMargin_{74};
   String indentation_;
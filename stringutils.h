@@ -10,6 +10,7 @@
 #include <cctype>
 #include <iostream>
 #include "utils.h"
+#include "utf8kernels.h"
 
 /// This class groups a variety of string related utility functions for use throughout JASP
 /// All functions are inline and here to avoid problems through the mixing of MSVC and GCC on Windows. 
@@ -233,10 +234,7 @@ public:
 	// Counts "first bytes" and thus hopefully code points, adapted from https://stackoverflow.com/a/4063229
 	static inline uint64_t approximateVisualLength(const std::string & in)
 	{
-		uint64_t len = 0;
-		for(const char kar : in)
-			len += (kar & 0xc0) != 0x80;
-		return len;
+		return utf8Kernels::codePointCount(in.data(), in.size());
 	}
 
 private:
@@ -0,0 +1,438 @@
+#ifndef UTF8KERNELS_H
+#define UTF8KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF8KERNELS_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+
+//MinGW does not keep the stack 32-byte aligned for spilled AVX registers, so there we stick to SSE2
+#if !defined(__MINGW32__) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#define UTF8KERNELS_AVX2
+#endif
+#endif
+
+#if defined(UTF8KERNELS_AVX2) && !defined(_MSC_VER)
+#define UTF8KERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UTF8KERNELS_TARGET_AVX2
+#endif
+
+/// Kernels for counting code points, validating UTF-8 and detecting pure ASCII in byte strings.
+/// Each kernel has a scalar (word-at-a-time), an SSE2 and an AVX2 version, the best one the cpu supports is picked once at runtime.
+/// Everything is inline for the same reason as stringUtils: this gets compiled by MSVC as well as RTools.
+class utf8Kernels
+{
+public:
+	enum class simdLevel { scalar, sse2, avx2 };
+
+	static inline simdLevel level()
+	{
+		static const simdLevel detected = detectLevel();
+		return detected;
+	}
+
+	/// Number of bytes that are not UTF-8 continuation bytes, which for valid UTF-8 is the number of code points
+	static inline size_t codePointCount(const char * data, size_t len)
+	{
+		switch(level())
+		{
+#ifdef UTF8KERNELS_AVX2
+		case simdLevel::avx2:	return codePointCountAVX2(data, len);
+#endif
+#ifdef UTF8KERNELS_SSE2
+		case simdLevel::sse2:	return codePointCountSSE2(data, len);
+#endif
+		default:				return codePointCountScalar(data, len);
+		}
+	}
+
+	static inline bool isAscii(const char * data, size_t len)
+	{
+		switch(level())
+		{
+#ifdef UTF8KERNELS_AVX2
+		case simdLevel::avx2:	return firstNonAsciiAVX2(data, len) == len;
+#endif
+#ifdef UTF8KERNELS_SSE2
+		case simdLevel::sse2:	return firstNonAsciiSSE2(data, len) == len;
+#endif
+		default:				return firstNonAsciiScalar(data, len) == len;
+		}
+	}
+
+	/// Checks for well-formed UTF-8 as per RFC 3629: no overlong encodings, no surrogates and nothing above U+10FFFF
+	static inline bool isValid(const char * data, size_t len)
+	{
+		switch(level())
+		{
+#ifdef UTF8KERNELS_AVX2
+		case simdLevel::avx2:	return isValidAVX2(data, len);
+#endif
+#ifdef UTF8KERNELS_SSE2
+		case simdLevel::sse2:	return isValidSSE2(data, len);
+#endif
+		default:				return isValidScalar(data, len);
+		}
+	}
+
+	static inline size_t codePointCountScalar(const char * data, size_t len)
+	{
+		const size_t	words	= len / 8;
+		size_t			conts	= 0;
+
+		for(size_t w=0; w<words; w++)
+		{
+			uint64_t word;
+			memcpy(&word, data + w * 8, 8);
+			//A continuation byte is 10xxxxxx, shifting left by one brings bit 6 under bit 7 of the same byte
+			const uint64_t cont = (word & ~(word << 1)) & 0x8080808080808080ull;
+			conts += ((cont >> 7) * 0x0101010101010101ull) >> 56;
+		}
+
+		for(size_t i=words * 8; i<len; i++)
+			conts += (data[i] & 0xc0) == 0x80;
+
+		return len - conts;
+	}
+
+	static inline size_t firstNonAsciiScalar(const char * data, size_t len)
+	{
+		size_t i = 0;
+
+		for(; i + 8 <= len; i += 8)
+		{
+			uint64_t word;
+			memcpy(&word, data + i, 8);
+			if(word & 0x8080808080808080ull)
+				break;
+		}
+
+		for(; i < len; i++)
+			if(data[i] & 0x80)
+				return i;
+
+		return len;
+	}
+
+	static inline bool isValidScalar(const char * data, size_t len)
+	{
+		size_t i = 0;
+		while(i < len)
+		{
+			i += firstNonAsciiScalar(data + i, len - i);
+			if(i == len)
+				return true;
+			if(!validateNonAsciiRun(data, len, i))
+				return false;
+		}
+		return true;
+	}
+
+#ifdef UTF8KERNELS_SSE2
+	static inline size_t codePointCountSSE2(const char * data, size_t len)
+	{
+		const __m128i	contMax	= _mm_set1_epi8(-65); //0xBF, anything signed above it is ASCII or a lead byte
+		size_t			count	= 0,
+						i		= 0;
+
+		while(i + 16 <= len)
+		{
+			//Byte lanes count up to 255 before they need to be summed
+			__m128i	acc		= _mm_setzero_si128();
+			size_t	blocks	= 0;
+
+			for(; i + 16 <= len && blocks < 255; i += 16, blocks++)
+				acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), contMax));
+
+			const __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+			count += size_t(_mm_cvtsi128_si32(sums)) + size_t(_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums)));
+		}
+
+		return count + codePointCountScalar(data + i, len - i);
+	}
+
+	static inline size_t firstNonAsciiSSE2(const char * data, size_t len)
+	{
+		size_t i = 0;
+
+		for(; i + 16 <= len; i += 16)
+		{
+			const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+			if(mask)
+				return i + lowestBit(uint32_t(mask));
+		}
+
+		return i + firstNonAsciiScalar(data + i, len - i);
+	}
+
+	static inline bool isValidSSE2(const char * data, size_t len)
+	{
+		//Without pshufb there is no cheap way to classify multibyte sequences in parallel, so the vector part skips ASCII runs
+		size_t i = 0;
+		while(i < len)
+		{
+			i += firstNonAsciiSSE2(data + i, len - i);
+			if(i == len)
+				return true;
+			if(!validateNonAsciiRun(data, len, i))
+				return false;
+		}
+		return true;
+	}
+#endif
+
+#ifdef UTF8KERNELS_AVX2
+	UTF8KERNELS_TARGET_AVX2 static inline size_t codePointCountAVX2(const char * data, size_t len)
+	{
+		const __m256i	contMax	= _mm256_set1_epi8(-65);
+		size_t			count	= 0,
+						i		= 0;
+
+		while(i + 32 <= len)
+		{
+			__m256i	acc		= _mm256_setzero_si256();
+			size_t	blocks	= 0;
+
+			for(; i + 32 <= len && blocks < 255; i += 32, blocks++)
+				acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), contMax));
+
+			const __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+			count +=	size_t(_mm256_extract_epi64(sums, 0)) + size_t(_mm256_extract_epi64(sums, 1))
+					+	size_t(_mm256_extract_epi64(sums, 2)) + size_t(_mm256_extract_epi64(sums, 3));
+		}
+
+		return count + codePointCountScalar(data + i, len - i);
+	}
+
+	UTF8KERNELS_TARGET_AVX2 static inline size_t firstNonAsciiAVX2(const char * data, size_t len)
+	{
+		size_t i = 0;
+
+		for(; i + 32 <= len; i += 32)
+		{
+			const uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))));
+			if(mask)
+				return i + lowestBit(mask);
+		}
+
+		return i + firstNonAsciiScalar(data + i, len - i);
+	}
+
+	/// The lookup algorithm by Keiser & Lemire ("Validating UTF-8 in less than one instruction per byte", 2021):
+	/// every byte pair is classified through three nibble lookups and the lengths of 3 and 4 byte sequences are checked separately.
+	UTF8KERNELS_TARGET_AVX2 static inline bool isValidAVX2(const char * data, size_t len)
+	{
+		__m256i	error		= _mm256_setzero_si256(),
+				prevInput	= _mm256_setzero_si256(),
+				prevIncompl	= _mm256_setzero_si256();
+		size_t	i			= 0;
+
+		for(; i + 32 <= len; i += 32)
+			checkBlockAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), prevInput, prevIncompl, error);
+
+		if(i < len)
+		{
+			//Zero padding is ASCII, so it ends any sequence that was cut short
+			alignas(32) char tail[32] = {0};
+			memcpy(tail, data + i, len - i);
+			checkBlockAVX2(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)), prevInput, prevIncompl, error);
+		}
+
+		error = _mm256_or_si256(error, prevIncompl);
+
+		return _mm256_testz_si256(error, error);
+	}
+#endif
+
+private:
+	utf8Kernels();
+
+	static inline unsigned lowestBit(uint32_t mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return unsigned(index);
+#else
+		return unsigned(__builtin_ctz(mask));
+#endif
+	}
+
+	static inline simdLevel detectLevel()
+	{
+#if defined(UTF8KERNELS_AVX2) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] >= 7)
+		{
+			__cpuid(info, 1);
+			const bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+
+			__cpuid(info, 7);
+			if(osSavesYmm && (info[1] & (1 << 5)))
+				return simdLevel::avx2;
+		}
+#elif defined(UTF8KERNELS_AVX2)
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2"))
+			return simdLevel::avx2;
+#endif
+#ifdef UTF8KERNELS_SSE2
+		return simdLevel::sse2;
+#else
+		return simdLevel::scalar;
+#endif
+	}
+
+	/// Validates the multibyte sequences starting at pos (which points at a non-ASCII byte) up to the next ASCII byte.
+	/// On success pos is moved past them.
+	static inline bool validateNonAsciiRun(const char * data, size_t len, size_t & pos)
+	{
+		const unsigned char *	bytes	= reinterpret_cast<const unsigned char*>(data);
+		size_t					i		= pos;
+
+		while(i < len && bytes[i] >= 0x80)
+		{
+			const unsigned char lead = bytes[i];
+			unsigned char		lo	 = 0x80,
+								hi	 = 0xBF;
+			size_t				conts;
+
+			if		(lead >= 0xC2 && lead <= 0xDF)	conts = 1;
+			else if	(lead >= 0xE0 && lead <= 0xEF)	conts = 2;
+			else if	(lead >= 0xF0 && lead <= 0xF4)	conts = 3;
+			else									return false;
+
+			switch(lead)
+			{
+			case 0xE0:	lo = 0xA0;	break; //overlong
+			case 0xED:	hi = 0x9F;	break; //surrogates
+			case 0xF0:	lo = 0x90;	break; //overlong
+			case 0xF4:	hi = 0x8F;	break; //above U+10FFFF
+			}
+
+			if(len - i <= conts || bytes[i + 1] < lo || bytes[i + 1] > hi)
+				return false;
+
+			for(size_t c=2; c<=conts; c++)
+				if((bytes[i + c] & 0xc0) != 0x80)
+					return false;
+
+			i += conts + 1;
+		}
+
+		pos = i;
+		return true;
+	}
+
+#ifdef UTF8KERNELS_AVX2
+	UTF8KERNELS_TARGET_AVX2 static inline __m256i prevBytesAVX2(__m256i input, __m256i prevInput, int n)
+	{
+		//alignr works per 128-bit lane, so first build the vector that holds the lane right before each lane of input
+		const __m256i shifted = _mm256_permute2x128_si256(prevInput, input, 0x21);
+		switch(n)
+		{
+		case 1:		return _mm256_alignr_epi8(input, shifted, 15);
+		case 2:		return _mm256_alignr_epi8(input, shifted, 14);
+		default:	return _mm256_alignr_epi8(input, shifted, 13);
+		}
+	}
+
+	UTF8KERNELS_TARGET_AVX2 static inline __m256i highNibblesAVX2(__m256i input)
+	{
+		return _mm256_and_si256(_mm256_srli_epi16(input, 4), _mm256_set1_epi8(0x0F));
+	}
+
+	UTF8KERNELS_TARGET_AVX2 static inline void checkBlockAVX2(__m256i input, __m256i & prevInput, __m256i & prevIncomplete, __m256i & error)
+	{
+		if(_mm256_testz_si256(input, _mm256_set1_epi8(char(0x80))))
+		{
+			//Pure ASCII, only a sequence left open by the previous block can be wrong
+			error		= _mm256_or_si256(error, prevIncomplete);
+			prevInput	= input;
+			prevIncomplete = _mm256_setzero_si256();
+			return;
+		}
+
+		const char	tooShort		= 1 << 0,	// 11______ 0_______ or 11______ 11______
+					tooLong			= 1 << 1,	// 0_______ 10______
+					overlong3		= 1 << 2,	// 11100000 100_____
+					tooLarge		= 1 << 3,	// 11110100 1001____ or 11110100 101_____ or 11110101+ 10______
+					surrogate		= 1 << 4,	// 11101101 101_____
+					overlong2		= 1 << 5,	// 1100000_ 10______
+					tooLarge1000	= 1 << 6,	// 11110101+ 1000____
+					overlong4		= 1 << 6,	// 11110000 1000____
+					twoConts		= char(1 << 7),	// 10______ 10______
+					carry			= tooShort | tooLong | twoConts;
+
+		const __m256i byte1HighTable = _mm256_setr_epi8(
+			tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+			twoConts, twoConts, twoConts, twoConts,
+			tooShort | overlong2, tooShort, tooShort | overlong3 | surrogate, tooShort | tooLarge | tooLarge1000 | overlong4,
+			tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+			twoConts, twoConts, twoConts, twoConts,
+			tooShort | overlong2, tooShort, tooShort | overlong3 | surrogate, tooShort | tooLarge | tooLarge1000 | overlong4);
+
+		const __m256i byte1LowTable = _mm256_setr_epi8(
+			carry | overlong3 | overlong2 | overlong4, carry | overlong2, carry, carry,
+			carry | tooLarge, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000,
+			carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000,
+			carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000 | surrogate, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000,
+			carry | overlong3 | overlong2 | overlong4, carry | overlong2, carry, carry,
+			carry | tooLarge, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000,
+			carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000,
+			carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000 | surrogate, carry | tooLarge | tooLarge1000, carry | tooLarge | tooLarge1000);
+
+		const __m256i byte2HighTable = _mm256_setr_epi8(
+			tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+			tooLong | overlong2 | twoConts | overlong3 | tooLarge1000 | overlong4,
+			tooLong | overlong2 | twoConts | overlong3 | tooLarge,
+			tooLong | overlong2 | twoConts | surrogate | tooLarge,
+			tooLong | overlong2 | twoConts | surrogate | tooLarge,
+			tooShort, tooShort, tooShort, tooShort,
+			tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+			tooLong | overlong2 | twoConts | overlong3 | tooLarge1000 | overlong4,
+			tooLong | overlong2 | twoConts | overlong3 | tooLarge,
+			tooLong | overlong2 | twoConts | surrogate | tooLarge,
+			tooLong | overlong2 | twoConts | surrogate | tooLarge,
+			tooShort, tooShort, tooShort, tooShort);
+
+		const __m256i prev1			= prevBytesAVX2(input, prevInput, 1),
+					  special		= _mm256_and_si256(
+											_mm256_and_si256(
+												_mm256_shuffle_epi8(byte1HighTable,	highNibblesAVX2(prev1)),
+												_mm256_shuffle_epi8(byte1LowTable,	_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+											_mm256_shuffle_epi8(byte2HighTable, highNibblesAVX2(input)));
+
+		//The second byte after an 1110____ lead and the third after an 11110___ lead must be continuations too
+		const __m256i prev2			= prevBytesAVX2(input, prevInput, 2),
+					  prev3			= prevBytesAVX2(input, prevInput, 3),
+					  mustBeCont	= _mm256_and_si256(
+											_mm256_or_si256(
+												_mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80))),
+												_mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)))),
+											_mm256_set1_epi8(char(0x80)));
+
+		error = _mm256_or_si256(error, _mm256_xor_si256(mustBeCont, special));
+
+		//A lead byte in the last three positions that still needs more bytes than fit in this block
+		const __m256i maxValue = _mm256_setr_epi8(
+			char(255), char(255), char(255), char(255), char(255), char(255), char(255), char(255),
+			char(255), char(255), char(255), char(255), char(255), char(255), char(255), char(255),
+			char(255), char(255), char(255), char(255), char(255), char(255), char(255), char(255),
+			char(255), char(255), char(255), char(255), char(255), char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+
+		prevIncomplete	= _mm256_subs_epu8(input, maxValue);
+		prevInput		= input;
+	}
+#endif
+};
+
+#endif // UTF8KERNELS_H